@@ -0,0 +1,781 @@
+/*
+  ==============================================================================
+
+     Multi-Device Player - A simple cross-platform aggregate device player
+     Copyright (C) 2022  Anthony Alfimov
+
+     This program is free software: you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published by
+     the Free Software Foundation, either version 3 of the License, or
+     (at your option) any later version.
+
+     This program is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+     GNU General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/MultiDevicePlayer.h"
+#include "../../Source/SimulatedAudioDevice.h"
+#include "../../Source/CallbackTrace.h"
+#include "../../Source/LatencyCalibrator.h"
+#include "../../Source/TelemetryRecorder.h"
+
+//==============================================================================
+/*
+    MDP Simulator drives the full MultiDevicePlayer push/pop pipeline with
+    simulated audio devices, optionally faster than realtime, and reports
+    shared buffer statistics for every device.
+*/
+namespace
+{
+    const char* const helpText =
+R"(Usage: MDP Simulator [options]
+
+Simulation:
+  --duration=<s>            simulated time to run for (default 60)
+  --speed=<x>               simulated time per wall clock time (default 10)
+  --report-interval=<s>     simulated time between reports (default 10)
+  --seed=<n>                random seed for the callback jitter (default 1)
+  --no-drift-correction     use fixed resampling ratios
+  --quality=<tier>          resampler quality: fast, balanced or mastering
+                            (default balanced)
+  --render-ahead=<ms>       render the source on a producer thread this far
+                            ahead of the Main device (default 0). The producer
+                            polls in wall clock time, so use --speed=1
+  --crossover=<Hz>          split the signal between the Main and the Linked
+                            devices with a crossover at this frequency
+  --adaptive-buffer[=<n>]   size the shared buffer from the measured callback
+                            jitter, allowing n underruns per minute (default 1).
+                            The jitter is measured in wall clock time, so use
+                            --speed=1
+  --record=<file>           save the callback trace of the run to a file
+  --telemetry=<file>        log the telemetry of the run to a CSV file
+  --timing=<file>           save the stage timing percentiles to a CSV file
+  --replay=<file>           replay the callback schedule of a trace file
+                            on a single thread instead of simulating devices
+  --calibrate               measure the latencies through a simulated
+                            loopback input, apply them and measure again
+
+Main device:
+  --main-rate=<Hz>          nominal sample rate (default 48000)
+  --main-block=<n>          buffer size (default 512)
+  --main-drift=<ppm>        clock deviation from the nominal rate (default 0)
+  --main-jitter=<ms>        largest callback timing deviation (default 0)
+  --main-pattern=<n:n:...>  block sizes the callbacks cycle through
+  --main-latency=<ms>       output latency on top of the buffer (default 0)
+
+Linked devices:
+  --linked-devices=<n>      number of Linked devices (default 1)
+  --linked-rate=<Hz,...>    nominal sample rate (default 44100)
+  --linked-block=<n,...>    buffer size (default 512)
+  --linked-drift=<ppm,...>  clock deviation from the nominal rate (default 0)
+  --linked-jitter=<ms,...>  largest callback timing deviation (default 0)
+  --linked-pattern=<n:n:...>
+                            block sizes the callbacks cycle through
+  --linked-latency=<ms,...> output latency on top of the buffer (default 0)
+
+Linked device options take a comma-separated value per device.
+The last value is used for the remaining devices.
+)";
+
+    //==========================================================================
+    double getValue (const ArgumentList& args, StringRef option, double defaultValue)
+    {
+        if (! args.containsOption (option))
+            return defaultValue;
+
+        return args.getValueForOption (option).getDoubleValue();
+    }
+
+    /** Returns the value of a comma-separated option for a given device. */
+    double getValue (const ArgumentList& args, StringRef option, int deviceIndex,
+                     double defaultValue)
+    {
+        auto values = StringArray::fromTokens (args.getValueForOption (option), ",", "");
+        values.removeEmptyStrings();
+
+        if (values.isEmpty())
+            return defaultValue;
+
+        return values[jmin (deviceIndex, values.size() - 1)].getDoubleValue();
+    }
+
+    PolyphaseResamplingAudioSource::Quality getQuality (const ArgumentList& args)
+    {
+        using Quality = PolyphaseResamplingAudioSource::Quality;
+
+        const auto name = args.getValueForOption ("--quality");
+
+        if (name == "fast")         return Quality::fast;
+        if (name == "mastering")    return Quality::mastering;
+
+        return Quality::balanced;
+    }
+
+    Array<int> getBlockPattern (const ArgumentList& args, StringRef option)
+    {
+        Array<int> pattern;
+
+        for (const auto& token : StringArray::fromTokens (args.getValueForOption (option),
+                                                          ":", ""))
+        {
+            if (token.getIntValue() > 0)
+                pattern.add (token.getIntValue());
+        }
+
+        return pattern;
+    }
+
+    SimulatedAudioIODevice::Settings getDeviceSettings (const ArgumentList& args,
+                                                        const String& prefix,
+                                                        int deviceIndex,
+                                                        double defaultSampleRate)
+    {
+        SimulatedAudioIODevice::Settings settings;
+
+        settings.sampleRate = getValue (args, prefix + "-rate", deviceIndex, defaultSampleRate);
+        settings.bufferSize = roundToInt (getValue (args, prefix + "-block", deviceIndex, 512.0));
+        settings.driftInPpm = getValue (args, prefix + "-drift", deviceIndex, 0.0);
+        settings.jitterInMs = getValue (args, prefix + "-jitter", deviceIndex, 0.0);
+        settings.blockPattern = getBlockPattern (args, prefix + "-pattern");
+        settings.outputLatencyInMs = getValue (args, prefix + "-latency", deviceIndex, 0.0);
+
+        return settings;
+    }
+
+    //==========================================================================
+    String describeDevice (const SimulatedAudioIODevice::Settings& settings)
+    {
+        String description;
+
+        description << settings.name << ": "
+                    << settings.sampleRate << " Hz, "
+                    << settings.bufferSize << " samples, "
+                    << settings.driftInPpm << " ppm drift, "
+                    << settings.jitterInMs << " ms jitter";
+
+        if (! settings.blockPattern.isEmpty())
+        {
+            StringArray blockSizes;
+
+            for (auto blockSize : settings.blockPattern)
+                blockSizes.add (String (blockSize));
+
+            description << ", blocks " << blockSizes.joinIntoString (":");
+        }
+
+        return description;
+    }
+
+    String describeStatistics (const MultiDevicePlayer::Statistics& statistics)
+    {
+        String description;
+
+        description << "transfers " << statistics.numTransfers
+                    << ", overflows " << statistics.numOverflows
+                    << ", underruns " << statistics.numUnderruns
+                    << ", fade-ins " << statistics.numFadeIns
+                    << ", fade-outs " << statistics.numFadeOuts
+                    << ", waits " << statistics.numWaits
+                    << ", occupancy min/mean/max "
+                    << statistics.minOccupancy << "/"
+                    << String (statistics.meanOccupancy, 1) << "/"
+                    << statistics.maxOccupancy;
+
+        return description;
+    }
+
+    int getXRunCount (AudioDeviceManager& manager)
+    {
+        if (auto* device = manager.getCurrentAudioDevice())
+            return device->getXRunCount();
+
+        return 0;
+    }
+
+    /** Sleeps for a wall clock time. The simulator doesn't run the message
+        loop, so the device resets and the adaptive buffer sizing of the
+        player are serviced from here instead.
+    */
+    void waitAndServicePlayer (MultiDevicePlayer& player, double timeInMs)
+    {
+        const auto startTime = Time::getMillisecondCounterHiRes();
+        const auto endTime = startTime + timeInMs;
+        auto nextSizingTime = startTime + MultiDevicePlayer::bufferSizingIntervalInMs;
+
+        for (;;)
+        {
+            const auto remainingTime = endTime - Time::getMillisecondCounterHiRes();
+
+            if (remainingTime <= 0.0)
+                break;
+
+            Thread::sleep (jmin (MultiDevicePlayer::deviceServiceIntervalInMs,
+                                 jmax (1, roundToInt (remainingTime))));
+
+            player.serviceDeviceResets();
+
+            if (player.isAdaptiveBufferSizingEnabled()
+                && Time::getMillisecondCounterHiRes() >= nextSizingTime)
+            {
+                player.updateAdaptiveBufferSizing();
+                nextSizingTime += MultiDevicePlayer::bufferSizingIntervalInMs;
+            }
+        }
+    }
+
+    void printResults (MultiDevicePlayer& player,
+                       const String& mainName,
+                       const StringArray& linkedNames)
+    {
+        std::cout << std::endl << "Results" << std::endl;
+
+        std::cout << "  " << mainName << ": "
+                  << describeStatistics (player.getMainStatistics());
+
+        if (player.getRenderAheadTime() > 0.0)
+            std::cout << ", render-ahead underruns " << player.getRenderAheadUnderruns();
+
+        std::cout << std::endl;
+
+        for (int i = 0; i < linkedNames.size(); ++i)
+        {
+            std::cout << "  " << linkedNames[i] << ": "
+                      << describeStatistics (player.getLinkedStatistics (i))
+                      << ", drift estimate " << String (player.getEstimatedDriftInPpm (i), 1)
+                      << " ppm, alignment error "
+                      << String (player.getAlignmentErrorInSamples (i), 2) << " samples" << std::endl;
+        }
+
+        std::cout << std::endl << "Stage timing, p50/p99/p99.9/max us" << std::endl;
+
+        for (int device = 0; device <= linkedNames.size(); ++device)
+        {
+            const auto& profiler = device == 0 ? player.getMainProfiler()
+                                               : player.getLinkedProfiler (device - 1);
+
+            std::cout << "  " << (device == 0 ? mainName : linkedNames[device - 1])
+                      << ", deadline " << String (profiler.getDeadlineInMicroseconds(), 1)
+                      << " us" << std::endl;
+
+            for (int stage = 0; stage < StageProfiler::numStages; ++stage)
+            {
+                const auto summary = profiler.getSummary (stage);
+
+                if (summary.count == 0)
+                    continue;
+
+                std::cout << "    " << StageProfiler::getStageName (stage) << ": "
+                          << String (summary.p50, 1) << "/" << String (summary.p99, 1) << "/"
+                          << String (summary.p999, 1) << "/" << String (summary.max, 1)
+                          << ", over deadline " << summary.numOverDeadline
+                          << " of " << summary.count << std::endl;
+            }
+        }
+    }
+
+    void addSimulatedDevice (AudioDeviceManager& manager,
+                             const SimulatedAudioIODevice::Settings& settings)
+    {
+        manager.addAudioDeviceType (std::make_unique<SimulatedAudioIODeviceType>
+                                        (Array<SimulatedAudioIODevice::Settings> { settings }));
+    }
+
+    //==========================================================================
+    // Latency compensation range, same as the application
+    constexpr double maxLatencyInMs = 250.0;
+}
+
+//==============================================================================
+/*
+    Runs the player with simulated devices, each on its own thread.
+*/
+static int runSimulation (const ArgumentList& args)
+{
+    const double duration = jmax (1.0, getValue (args, "--duration", 60.0));
+    const double speed = jmax (0.01, getValue (args, "--speed", 10.0));
+    const double reportInterval = jmax (0.1, getValue (args, "--report-interval", 10.0));
+    const auto seed = static_cast<int64> (getValue (args, "--seed", 1.0));
+
+    const int numLinkedDevices
+        = jlimit (1, MultiDevicePlayer::maxNumLinkedDevices,
+                  roundToInt (getValue (args, "--linked-devices", 1.0)));
+
+    //==========================================================================
+    // Set up the player with simulated devices
+    MultiDevicePlayer player (maxLatencyInMs, numLinkedDevices);
+    player.setDeviceHostTimeEnabled (true);
+    player.setDriftCorrectionEnabled (! args.containsOption ("--no-drift-correction"));
+    player.setResamplingQuality (getQuality (args));
+    player.setRenderAheadTime (jmax (0.0, getValue (args, "--render-ahead", 0.0)));
+
+    if (args.containsOption ("--crossover"))
+    {
+        player.setCrossoverFrequency (static_cast<float> (getValue (args, "--crossover", 80.0)));
+        player.setCrossoverEnabled (true);
+    }
+
+    if (args.containsOption ("--adaptive-buffer"))
+    {
+        const auto rate = args.getValueForOption ("--adaptive-buffer");
+        player.setMaxUnderrunRate (rate.isNotEmpty() ? jmax (0.001, rate.getDoubleValue()) : 1.0);
+        player.setAdaptiveBufferSizingEnabled (true);
+    }
+
+    auto mainSettings = getDeviceSettings (args, "--main", 0, 48000.0);
+    mainSettings.name = "Simulated Main";
+    mainSettings.speed = speed;
+    mainSettings.randomSeed = seed;
+
+    addSimulatedDevice (player.mainDeviceManager, mainSettings);
+
+    Array<SimulatedAudioIODevice::Settings> linkedSettings;
+    StringArray linkedNames;
+
+    for (int i = 0; i < numLinkedDevices; ++i)
+    {
+        auto settings = getDeviceSettings (args, "--linked", i, 44100.0);
+        settings.name = "Simulated Linked " + String (i + 1);
+        settings.speed = speed;
+        settings.randomSeed = seed + i + 1;
+
+        addSimulatedDevice (player.getLinkedDeviceManager (i), settings);
+        linkedSettings.add (settings);
+        linkedNames.add (settings.name);
+    }
+
+    std::cout << describeDevice (mainSettings) << std::endl;
+
+    for (const auto& settings : linkedSettings)
+        std::cout << describeDevice (settings) << std::endl;
+
+    std::cout << "Running " << duration << " s at " << speed << "x speed, drift correction "
+              << (player.isDriftCorrectionEnabled() ? "on" : "off");
+
+    if (player.getRenderAheadTime() > 0.0)
+        std::cout << ", rendering " << player.getRenderAheadTime() << " ms ahead";
+
+    std::cout << std::endl;
+
+    //==========================================================================
+    // Run the simulation
+    ToneGeneratorAudioSource tone;
+    tone.setFrequency (440.0);
+    tone.setAmplitude (0.25f);
+
+    if (args.containsOption ("--record"))
+        player.startTraceRecording();
+
+    player.initialiseAudio (&tone, 2);
+
+    if (player.mainDeviceManager.getCurrentAudioDevice() == nullptr)
+    {
+        std::cerr << "Failed to open the simulated Main device" << std::endl;
+        return 1;
+    }
+
+    // Telemetry is sampled in wall clock time, so faster runs get fewer samples
+    TelemetryRecorder telemetry (player);
+
+    if (args.containsOption ("--telemetry"))
+    {
+        const File telemetryFile (File::getCurrentWorkingDirectory()
+                                      .getChildFile (args.getValueForOption ("--telemetry")));
+
+        if (! telemetry.startLogging (telemetryFile))
+        {
+            std::cerr << "Failed to open " << telemetryFile.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        telemetry.start();
+    }
+
+    double simulatedTime = 0.0;
+
+    while (simulatedTime < duration)
+    {
+        const double step = jmin (reportInterval, duration - simulatedTime);
+        waitAndServicePlayer (player, 1000.0 * step / speed);
+        simulatedTime += step;
+
+        std::cout << "t = " << String (simulatedTime, 1) << " s";
+
+        if (player.isAdaptiveBufferSizingEnabled())
+            std::cout << ", shared buffer depth " << player.getSharedBufferDepth();
+
+        std::cout << std::endl;
+
+        for (int i = 0; i < numLinkedDevices; ++i)
+        {
+            std::cout << "  " << linkedNames[i] << ": drift estimate "
+                      << String (player.getEstimatedDriftInPpm (i), 1) << " ppm, alignment error "
+                      << String (player.getAlignmentErrorInSamples (i), 2) << " samples, "
+                      << describeStatistics (player.getLinkedStatistics (i)) << std::endl;
+        }
+    }
+
+    // Devices are deleted on shutdown, so collect their counters first
+    std::cout << std::endl << "Late callbacks: "
+              << mainSettings.name << " " << getXRunCount (player.mainDeviceManager);
+
+    for (int i = 0; i < numLinkedDevices; ++i)
+    {
+        std::cout << ", " << linkedNames[i] << " "
+                  << getXRunCount (player.getLinkedDeviceManager (i));
+    }
+
+    std::cout << std::endl;
+
+    telemetry.stop();
+    player.shutdownAudio();
+
+    printResults (player, mainSettings.name, linkedNames);
+
+    for (int i = 0; i < numLinkedDevices; ++i)
+    {
+        // Drift estimate is positive when the Main device runs faster
+        const double actualDriftInPpm = ((1.0 + mainSettings.driftInPpm * 1.0e-6)
+                                         / (1.0 + linkedSettings[i].driftInPpm * 1.0e-6)
+                                         - 1.0) * 1.0e6;
+
+        std::cout << "  " << linkedNames[i] << ": actual drift "
+                  << String (actualDriftInPpm, 1) << " ppm" << std::endl;
+    }
+
+    if (args.containsOption ("--record"))
+    {
+        const File traceFile (File::getCurrentWorkingDirectory()
+                                  .getChildFile (args.getValueForOption ("--record")));
+
+        if (! player.saveTrace (traceFile))
+        {
+            std::cerr << "Failed to save the trace to " << traceFile.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        std::cout << "Trace saved to " << traceFile.getFullPathName() << std::endl;
+    }
+
+    if (args.containsOption ("--timing"))
+    {
+        const File timingFile (File::getCurrentWorkingDirectory()
+                                   .getChildFile (args.getValueForOption ("--timing")));
+
+        if (! telemetry.exportStageTimings (timingFile))
+        {
+            std::cerr << "Failed to save the stage timings to "
+                      << timingFile.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        std::cout << "Stage timings saved to " << timingFile.getFullPathName() << std::endl;
+    }
+
+    return 0;
+}
+
+//==============================================================================
+/*
+    Measures the latencies of the Linked devices through a simulated loopback
+    input, applies them, and measures again to verify the compensation.
+*/
+static int runCalibration (const ArgumentList& args)
+{
+    const double speed = jmax (0.01, getValue (args, "--speed", 10.0));
+    const auto seed = static_cast<int64> (getValue (args, "--seed", 1.0));
+
+    const int numLinkedDevices
+        = jlimit (1, MultiDevicePlayer::maxNumLinkedDevices,
+                  roundToInt (getValue (args, "--linked-devices", 1.0)));
+
+    //==========================================================================
+    // Set up the player with simulated devices that play into a loopback
+    auto loopback = std::make_shared<SimulatedLoopback>();
+
+    MultiDevicePlayer player (maxLatencyInMs, numLinkedDevices);
+    player.setDeviceHostTimeEnabled (true);
+    player.setDriftCorrectionEnabled (! args.containsOption ("--no-drift-correction"));
+    player.setResamplingQuality (getQuality (args));
+
+    auto mainSettings = getDeviceSettings (args, "--main", 0, 48000.0);
+    mainSettings.name = "Simulated Main";
+    mainSettings.speed = speed;
+    mainSettings.randomSeed = seed;
+    mainSettings.loopback = loopback;
+
+    addSimulatedDevice (player.mainDeviceManager, mainSettings);
+    std::cout << describeDevice (mainSettings) << ", "
+              << mainSettings.outputLatencyInMs << " ms output latency" << std::endl;
+
+    StringArray linkedNames;
+
+    for (int i = 0; i < numLinkedDevices; ++i)
+    {
+        auto settings = getDeviceSettings (args, "--linked", i, 44100.0);
+        settings.name = "Simulated Linked " + String (i + 1);
+        settings.speed = speed;
+        settings.randomSeed = seed + i + 1;
+        settings.loopback = loopback;
+
+        addSimulatedDevice (player.getLinkedDeviceManager (i), settings);
+        linkedNames.add (settings.name);
+
+        std::cout << describeDevice (settings) << ", "
+                  << settings.outputLatencyInMs << " ms output latency" << std::endl;
+    }
+
+    //==========================================================================
+    // The calibrator plays the test signal and listens through the loopback
+    LatencyCalibrator calibrator (player, maxLatencyInMs);
+
+    SimulatedAudioIODevice::Settings inputSettings;
+    inputSettings.name = "Simulated Loopback Input";
+    inputSettings.numOutputChannels = 0;
+    inputSettings.numInputChannels = 1;
+    inputSettings.bufferSize = 256;
+    inputSettings.speed = speed;
+    inputSettings.loopback = loopback;
+
+    addSimulatedDevice (calibrator.getInputDeviceManager(), inputSettings);
+
+    // The calibrator opens the loopback input whenever it's started
+    player.initialiseAudio (&calibrator, 2);
+
+    if (player.mainDeviceManager.getCurrentAudioDevice() == nullptr)
+    {
+        std::cerr << "Failed to open the simulated devices" << std::endl;
+        return 1;
+    }
+
+    //==========================================================================
+    // Returns the largest remaining offset, or a negative value on failure
+    auto calibrate = [&] (const String& title)
+    {
+        // Let the shared buffer fill and the latency changes settle
+        waitAndServicePlayer (player, 2000.0 / speed);
+
+        std::cout << std::endl << title << std::endl;
+
+        calibrator.start();
+
+        while (calibrator.getState() == LatencyCalibrator::State::measuring
+               || calibrator.getState() == LatencyCalibrator::State::analysing)
+            waitAndServicePlayer (player, 20.0);
+
+        // There is no message loop, so the input is closed from here
+        while (! calibrator.serviceInput())
+            waitAndServicePlayer (player, 20.0);
+
+        if (calibrator.getState() != LatencyCalibrator::State::finished)
+        {
+            std::cout << "  Failed: " << calibrator.getErrorMessage() << std::endl;
+            return -1.0f;
+        }
+
+        float maxOffset = 0.0f;
+
+        for (int i = 0; i < numLinkedDevices; ++i)
+        {
+            const auto result = calibrator.getResult (i);
+
+            if (! result.isValid)
+            {
+                std::cout << "  " << linkedNames[i] << ": not detected" << std::endl;
+                return -1.0f;
+            }
+
+            std::cout << "  " << linkedNames[i] << ": offset "
+                      << String (result.measuredOffsetInMs, 3) << " ms, latency set to "
+                      << String (result.newLatencyInMs, 3) << " ms, peak to RMS "
+                      << String (result.peakToRmsRatio, 1) << std::endl;
+
+            maxOffset = jmax (maxOffset, std::abs (result.measuredOffsetInMs));
+        }
+
+        return maxOffset;
+    };
+
+    const bool hasMeasured = calibrate ("Calibration") >= 0.0f;
+    const float residualOffset = hasMeasured ? calibrate ("Verification") : -1.0f;
+
+    player.shutdownAudio();
+
+    // The compensation should leave less than a millisecond
+    if (residualOffset < 0.0f || residualOffset > 1.0f)
+    {
+        std::cerr << std::endl << "Calibration failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << std::endl << "Calibration succeeded" << std::endl;
+    return 0;
+}
+
+//==============================================================================
+/*
+    Feeds the callback schedule of a recorded trace through the player.
+
+    All devices are driven from this thread in the recorded order, and
+    every callback reports its recorded time as the host time, which the
+    player timestamps it with. The result of a replay is thus deterministic
+    and doesn't depend on the speed of the machine.
+*/
+static int runReplay (const ArgumentList& args)
+{
+    const File traceFile (File::getCurrentWorkingDirectory()
+                              .getChildFile (args.getValueForOption ("--replay")));
+
+    Array<CallbackTrace::Event> events;
+    int numDevices = 0;
+
+    if (! CallbackTrace::loadFromFile (traceFile, events, numDevices))
+    {
+        std::cerr << "Failed to load the trace from " << traceFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    const int numLinkedDevices = numDevices - 1;
+
+    if (! isPositiveAndNotGreaterThan (numLinkedDevices, MultiDevicePlayer::maxNumLinkedDevices)
+        || numLinkedDevices == 0)
+    {
+        std::cerr << "The trace must contain the Main device and at least one Linked device"
+                  << std::endl;
+        return 1;
+    }
+
+    //==========================================================================
+    // Each device is opened with the first reported sample rate and a buffer
+    //  size that fits its largest recorded block
+    Array<SimulatedAudioIODevice::Settings> deviceSettings;
+
+    for (int device = 0; device < numDevices; ++device)
+    {
+        SimulatedAudioIODevice::Settings settings;
+        settings.name = device == 0 ? String ("Replayed Main")
+                                    : "Replayed Linked " + String (device);
+        settings.sampleRate = 0.0;
+        settings.bufferSize = 0;
+        settings.runOnDeviceThread = false;
+
+        deviceSettings.add (settings);
+    }
+
+    int numSampleRateChanges = 0;
+
+    for (const auto& event : events)
+    {
+        auto& settings = deviceSettings.getReference (event.device);
+
+        if (settings.sampleRate == 0.0)
+            settings.sampleRate = event.sampleRate;
+        else if (event.sampleRate != settings.sampleRate)
+            ++numSampleRateChanges;
+
+        settings.bufferSize = jmax (settings.bufferSize, event.numSamples);
+    }
+
+    for (const auto& settings : deviceSettings)
+    {
+        if (settings.sampleRate <= 0.0 || settings.bufferSize <= 0)
+        {
+            std::cerr << "The trace has no callbacks of " << settings.name << std::endl;
+            return 1;
+        }
+    }
+
+    //==========================================================================
+    // Set up the player with devices that are driven from this thread
+    MultiDevicePlayer player (maxLatencyInMs, numLinkedDevices);
+    player.setDeviceHostTimeEnabled (true);
+    player.setDriftCorrectionEnabled (! args.containsOption ("--no-drift-correction"));
+    player.setResamplingQuality (getQuality (args));
+
+    addSimulatedDevice (player.mainDeviceManager, deviceSettings[0]);
+    StringArray linkedNames;
+
+    for (int i = 0; i < numLinkedDevices; ++i)
+    {
+        addSimulatedDevice (player.getLinkedDeviceManager (i), deviceSettings[i + 1]);
+        linkedNames.add (deviceSettings[i + 1].name);
+    }
+
+    for (const auto& settings : deviceSettings)
+        std::cout << describeDevice (settings) << std::endl;
+
+    std::cout << "Replaying " << events.size() << " callbacks from "
+              << traceFile.getFileName() << std::endl;
+
+    if (numSampleRateChanges > 0)
+    {
+        std::cout << numSampleRateChanges << " callbacks reported a changed sample rate. "
+                  << "Device resets are not replayed." << std::endl;
+    }
+
+    ToneGeneratorAudioSource tone;
+    tone.setFrequency (440.0);
+    tone.setAmplitude (0.25f);
+
+    player.initialiseAudio (&tone, 2);
+
+    Array<SimulatedAudioIODevice*> devices;
+    devices.add (dynamic_cast<SimulatedAudioIODevice*>
+                     (player.mainDeviceManager.getCurrentAudioDevice()));
+
+    for (int i = 0; i < numLinkedDevices; ++i)
+        devices.add (dynamic_cast<SimulatedAudioIODevice*>
+                         (player.getLinkedDeviceManager (i).getCurrentAudioDevice()));
+
+    if (devices.contains (nullptr))
+    {
+        std::cerr << "Failed to open the replayed devices" << std::endl;
+        return 1;
+    }
+
+    //==========================================================================
+    // Replay the callbacks in the recorded order
+    for (const auto& event : events)
+    {
+        devices[event.device]->renderNextBlock (event.numSamples, event.timeInNs * 1.0e-9);
+
+        // A device that asks for a reset is prepared again before the next callback
+        player.serviceDeviceResets();
+    }
+
+    player.shutdownAudio();
+
+    printResults (player, deviceSettings[0].name, linkedNames);
+
+    return 0;
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    const ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--help|-h"))
+    {
+        std::cout << helpText;
+        return 0;
+    }
+
+    // Audio device managers and the player's timer need a message manager
+    ScopedJuceInitialiser_GUI juceInitialiser;
+
+    if (args.containsOption ("--replay"))
+        return runReplay (args);
+
+    if (args.containsOption ("--calibrate"))
+        return runCalibration (args);
+
+    return runSimulation (args);
+}
@@ -1,34 +1,34 @@
-/*
-  ==============================================================================
-
-    AppLookAndFeel.h
-    Created: 29 Sep 2022 3:47:50pm
-    Author:  Anthony Alfimov
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-
-class AppLookAndFeel  : public LookAndFeel_V4
-{
-public:
-    /**
-        Creates and initialises AppLookAndFeel.
-     */
-    AppLookAndFeel();
-
-    enum ColourIds
-    {
-        headingColourId = 1,
-        playButtonColourId,
-        stopButtonColourId
-    };
-
-private:
-
-    //==============================================================================
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AppLookAndFeel)
-};
+/*
+  ==============================================================================
+
+    AppLookAndFeel.h
+    Created: 29 Sep 2022 3:47:50pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class AppLookAndFeel  : public LookAndFeel_V4
+{
+public:
+    /**
+        Creates and initialises AppLookAndFeel.
+     */
+    AppLookAndFeel();
+
+    enum ColourIds
+    {
+        headingColourId = 1,
+        playButtonColourId,
+        stopButtonColourId
+    };
+
+private:
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AppLookAndFeel)
+};
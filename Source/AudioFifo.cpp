@@ -1,158 +1,379 @@
-/*
-  ==============================================================================
-
-    AudioFifo.cpp
-    Created: 28 Sep 2022 7:40:25pm
-    Author:  Anthony Alfimov
-
-  ==============================================================================
-*/
-
-#include "AudioFifo.h"
-
-int AudioFifo::getTotalSize() const
-{
-    jassert (buffer.getNumSamples() == fifoManager.getTotalSize());
-    return fifoManager.getTotalSize();
-}
-
-//==========================================================================
-void AudioFifo::setSize (int newNumChannels, int newNumSamples)
-{
-    buffer.setSize (newNumChannels, newNumSamples, false, true, false);
-    fifoManager.setTotalSize (newNumSamples);
-}
-
-void AudioFifo::reset()
-{
-    buffer.clear();
-    fifoManager.reset();
-}
-
-//==========================================================================
-int AudioFifo::push (const AudioSourceChannelInfo& inInfo)
-{
-    return pushWithRamp (inInfo, 1.0f, 1.0f);
-}
-
-int AudioFifo::pop (const AudioSourceChannelInfo& outInfo)
-{
-    return popWithRamp (outInfo, 1.0f, 1.0f);
-}
-
-int AudioFifo::pushWithRamp (const AudioSourceChannelInfo& inInfo,
-                             float startGain, float endGain)
-{
-    const auto status = fifoManager.write (inInfo.numSamples);
-
-    const auto* inBuffer = inInfo.buffer;
-    const auto channelsRequired = buffer.getNumChannels();
-    const auto channelsToProcess = jmin (inBuffer->getNumChannels(), channelsRequired);
-    
-    const float midGain = getMidGain (startGain, endGain,
-                                      status.blockSize1, status.blockSize2);
-
-    if (status.blockSize1 > 0)
-    {
-        const int inStartIndex1 = inInfo.startSample;
-
-        for (int ch = 0; ch < channelsToProcess; ++ch)
-        {
-            buffer.copyFromWithRamp (ch, status.startIndex1,
-                                     inBuffer->getReadPointer (ch, inStartIndex1),
-                                     status.blockSize1,
-                                     startGain, midGain);
-        }
-
-        // Clear any remaining channels:
-        for (int ch = channelsToProcess; ch < channelsRequired; ++ch)
-        {
-            buffer.clear (ch, status.startIndex1, status.blockSize1);
-        }
-    }
-
-    if (status.blockSize2 > 0)
-    {
-        const int inStartIndex2 = inInfo.startSample + status.blockSize1;
-
-        for (int ch = 0; ch < channelsToProcess; ++ch)
-        {
-            buffer.copyFromWithRamp (ch, status.startIndex2,
-                                     inBuffer->getReadPointer (ch, inStartIndex2),
-                                     status.blockSize2,
-                                     midGain, endGain);
-        }
-
-        // Clear any remaining channels:
-        for (int ch = channelsToProcess; ch < channelsRequired; ++ch)
-        {
-            buffer.clear (ch, status.startIndex2, status.blockSize2);
-        }
-    }
-
-    return status.blockSize1 + status.blockSize2;
-}
-
-int AudioFifo::popWithRamp (const AudioSourceChannelInfo& outInfo,
-                            float startGain, float endGain)
-{
-    const auto status = fifoManager.read (outInfo.numSamples);
-
-    auto* outBuffer = outInfo.buffer;
-    const auto channelsRequired = outBuffer->getNumChannels();
-    const auto channelsToProcess = jmin (buffer.getNumChannels(), channelsRequired);
-
-    const float midGain = getMidGain (startGain, endGain,
-                                      status.blockSize1, status.blockSize2);
-
-    if (status.blockSize1 > 0)
-    {
-        const int outStartIndex1 = outInfo.startSample;
-
-        for (int ch = 0; ch < channelsToProcess; ++ch)
-        {
-            outBuffer->copyFromWithRamp (ch, outStartIndex1,
-                                         buffer.getReadPointer (ch, status.startIndex1),
-                                         status.blockSize1,
-                                         startGain, midGain);
-        }
-
-        // Clear any remaining channels:
-        for (int ch = channelsToProcess; ch < channelsRequired; ++ch)
-        {
-            outBuffer->clear (ch, outStartIndex1, status.blockSize1);
-        }
-    }
-
-    if (status.blockSize2 > 0)
-    {
-        const int outStartIndex2 = outInfo.startSample + status.blockSize1;
-
-        for (int ch = 0; ch < channelsToProcess; ++ch)
-        {
-            outBuffer->copyFromWithRamp (ch, outStartIndex2,
-                                         buffer.getReadPointer (ch, status.startIndex2),
-                                         status.blockSize2,
-                                         midGain, endGain);
-        }
-
-        // Clear any remaining channels:
-        for (int ch = channelsToProcess; ch < channelsRequired; ++ch)
-        {
-            outBuffer->clear (ch, outStartIndex2, status.blockSize2);
-        }
-    }
-
-    return status.blockSize1 + status.blockSize2;
-}
-
-float AudioFifo::getMidGain (float startGain, float endGain,
-                             int blockSize1, int blockSize2)
-{
-    if (startGain == endGain)
-        return startGain;
-
-    float midRatio = static_cast<float> (blockSize1) / (blockSize1 + blockSize2);
-
-    return jmap (midRatio, startGain, endGain);
-}
+/*
+  ==============================================================================
+
+    AudioFifo.cpp
+    Created: 28 Sep 2022 7:40:25pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "AudioFifo.h"
+
+AudioFifo::Storage::Storage (int numChannels, int numSamples)
+    : buffer (numChannels, nextPowerOfTwo (numSamples)),
+      size (numSamples),
+      capacity (buffer.getNumSamples()),
+      mask (static_cast<uint32> (capacity - 1))
+{
+    jassert (numSamples > 0);
+    jassert (isPowerOfTwo (capacity));
+
+    buffer.clear();
+}
+
+//==============================================================================
+AudioFifo::AudioFifo()
+{
+    auto* initialStorage = storages.add (std::make_unique<Storage> (2, defaultSize));
+
+    publishedStorage.store (initialStorage);
+    numChannels.store (initialStorage->buffer.getNumChannels());
+    totalSize.store (initialStorage->size);
+    producer.storage = initialStorage;
+    producer.acknowledged.store (initialStorage);
+
+    //==========================================================================
+    // Check that atomic storage pointer and positions are lock-free
+    static_assert (std::atomic<Storage*>::is_always_lock_free,
+                   "std::atomic for pointer type must be always lock free");
+    static_assert (std::atomic<uint32>::is_always_lock_free,
+                   "std::atomic for type uint32 must be always lock free");
+}
+
+//==============================================================================
+int AudioFifo::getNumChannels() const
+{
+    return numChannels.load (std::memory_order_relaxed);
+}
+
+int AudioFifo::getTotalSize() const
+{
+    return totalSize.load (std::memory_order_relaxed);
+}
+
+int AudioFifo::getFreeSpace()
+{
+    return getFreeSpace (getProducerStorage());
+}
+
+int AudioFifo::getNumReady (int reader)
+{
+    auto& storage = getReaderStorage (reader);
+
+    const auto writePosition = storage.writePosition.value.load (std::memory_order_acquire);
+    const auto readPosition = storage.readPositions[reader].value
+                                     .load (std::memory_order_relaxed);
+
+    return static_cast<int> (writePosition - readPosition);
+}
+
+int AudioFifo::getFreeSpace (Storage& storage) const
+{
+    const auto writePosition = storage.writePosition.value.load (std::memory_order_relaxed);
+
+    // Only the slowest active reader limits the producer
+    int maxNumReady = 0;
+
+    for (int reader = 0; reader < maxNumReaders; ++reader)
+    {
+        if (! readers[reader].active.load (std::memory_order_acquire))
+            continue;
+
+        const auto readPosition = storage.readPositions[reader].value
+                                         .load (std::memory_order_acquire);
+        maxNumReady = jmax (maxNumReady, static_cast<int> (writePosition - readPosition));
+    }
+
+    return storage.size - maxNumReady;
+}
+
+//==============================================================================
+void AudioFifo::setSize (int newNumChannels, int newNumSamples)
+{
+    retireStorage();
+
+    auto* newStorage = storages.add (std::make_unique<Storage> (newNumChannels,
+                                                                newNumSamples));
+    numChannels.store (newNumChannels, std::memory_order_relaxed);
+    totalSize.store (newNumSamples, std::memory_order_relaxed);
+    publishedStorage.store (newStorage, std::memory_order_release);
+}
+
+void AudioFifo::reset (int reader)
+{
+    auto& storage = getReaderStorage (reader);
+
+    storage.readPositions[reader].value
+           .store (storage.writePosition.value.load (std::memory_order_acquire),
+                   std::memory_order_release);
+}
+
+int AudioFifo::discard (int reader, int numSamples)
+{
+    auto& storage = getReaderStorage (reader);
+    auto& readPosition = storage.readPositions[reader].value;
+
+    const auto writePosition = storage.writePosition.value.load (std::memory_order_acquire);
+    const auto position = readPosition.load (std::memory_order_relaxed);
+
+    const int numDiscarded = jlimit (0, static_cast<int> (writePosition - position), numSamples);
+    readPosition.store (position + static_cast<uint32> (numDiscarded), std::memory_order_release);
+
+    return numDiscarded;
+}
+
+//==============================================================================
+void AudioFifo::attachReader (int reader)
+{
+    jassert (isPositiveAndBelow (reader, maxNumReaders));
+
+    readers[reader].attachRequested.store (true);
+}
+
+void AudioFifo::detachReader (int reader)
+{
+    jassert (isPositiveAndBelow (reader, maxNumReaders));
+
+    auto& view = readers[reader];
+
+    view.attachRequested.store (false);
+    view.active.store (false);
+
+    // The reader thread has stopped, so its view can be reset from here
+    view.storage = nullptr;
+    view.acknowledged.store (nullptr);
+}
+
+//==============================================================================
+AudioFifo::Storage& AudioFifo::getProducerStorage()
+{
+    auto* latestStorage = publishedStorage.load (std::memory_order_acquire);
+
+    if (producer.storage != latestStorage)
+    {
+        producer.storage = latestStorage;
+        producer.acknowledged.store (latestStorage, std::memory_order_release);
+    }
+
+    return *producer.storage;
+}
+
+AudioFifo::Storage& AudioFifo::getReaderStorage (int reader)
+{
+    jassert (isPositiveAndBelow (reader, maxNumReaders));
+
+    auto& view = readers[reader];
+    auto* latestStorage = publishedStorage.load (std::memory_order_acquire);
+
+    if (view.storage != latestStorage)
+    {
+        view.storage = latestStorage;
+        view.acknowledged.store (latestStorage, std::memory_order_release);
+    }
+
+    auto& storage = *view.storage;
+
+    // A newly attached reader starts from the current write position
+    if (view.attachRequested.load (std::memory_order_acquire))
+    {
+        storage.readPositions[reader].value
+               .store (storage.writePosition.value.load (std::memory_order_acquire),
+                       std::memory_order_release);
+
+        // Become active before clearing the request, so that the reader
+        //  is never seen as detached while it is running
+        view.active.store (true, std::memory_order_release);
+        view.attachRequested.store (false, std::memory_order_release);
+    }
+
+    jassert (view.active.load (std::memory_order_relaxed));
+
+    return storage;
+}
+
+void AudioFifo::retireStorage()
+{
+    auto* latestStorage = publishedStorage.load (std::memory_order_acquire);
+
+    // Once all audio threads have acknowledged the latest storage, they can
+    //  never load an older one again. Until then, keep all of them alive.
+    //  If one of the threads is not running, old storage is kept until it is.
+    if (producer.acknowledged.load (std::memory_order_acquire) != latestStorage)
+        return;
+
+    for (auto& view : readers)
+    {
+        const bool isAttached = view.active.load (std::memory_order_acquire)
+                             || view.attachRequested.load (std::memory_order_acquire);
+
+        if (isAttached && view.acknowledged.load (std::memory_order_acquire) != latestStorage)
+            return;
+    }
+
+    for (int i = storages.size(); --i >= 0;)
+    {
+        if (storages.getUnchecked (i) != latestStorage)
+            storages.remove (i);
+    }
+}
+
+//==============================================================================
+int AudioFifo::push (const AudioSourceChannelInfo& inInfo)
+{
+    return pushWithRamp (inInfo, 1.0f, 1.0f);
+}
+
+int AudioFifo::pop (int reader, const AudioSourceChannelInfo& outInfo)
+{
+    return popWithRamp (reader, outInfo, 1.0f, 1.0f);
+}
+
+int AudioFifo::pushWithRamp (const AudioSourceChannelInfo& inInfo,
+                             float startGain, float endGain)
+{
+    auto& storage = getProducerStorage();
+
+    const auto writePosition = storage.writePosition.value.load (std::memory_order_relaxed);
+    const int numToWrite = jmin (inInfo.numSamples, getFreeSpace (storage));
+
+    if (numToWrite <= 0)
+        return 0;
+
+    const int startIndex1 = static_cast<int> (writePosition & storage.mask);
+    const int blockSize1 = jmin (numToWrite, storage.capacity - startIndex1);
+    const int blockSize2 = numToWrite - blockSize1;
+
+    const auto* inBuffer = inInfo.buffer;
+    auto& buffer = storage.buffer;
+    const auto channelsRequired = buffer.getNumChannels();
+    const auto channelsToProcess = jmin (inBuffer->getNumChannels(), channelsRequired);
+
+    const float midGain = getMidGain (startGain, endGain, blockSize1, blockSize2);
+
+    if (blockSize1 > 0)
+    {
+        const int inStartIndex1 = inInfo.startSample;
+
+        for (int ch = 0; ch < channelsToProcess; ++ch)
+        {
+            buffer.copyFromWithRamp (ch, startIndex1,
+                                     inBuffer->getReadPointer (ch, inStartIndex1),
+                                     blockSize1,
+                                     startGain, midGain);
+        }
+
+        // Clear any remaining channels:
+        for (int ch = channelsToProcess; ch < channelsRequired; ++ch)
+        {
+            buffer.clear (ch, startIndex1, blockSize1);
+        }
+    }
+
+    if (blockSize2 > 0)
+    {
+        const int inStartIndex2 = inInfo.startSample + blockSize1;
+
+        for (int ch = 0; ch < channelsToProcess; ++ch)
+        {
+            buffer.copyFromWithRamp (ch, 0,
+                                     inBuffer->getReadPointer (ch, inStartIndex2),
+                                     blockSize2,
+                                     midGain, endGain);
+        }
+
+        // Clear any remaining channels:
+        for (int ch = channelsToProcess; ch < channelsRequired; ++ch)
+        {
+            buffer.clear (ch, 0, blockSize2);
+        }
+    }
+
+    // Publish the samples to the readers
+    storage.writePosition.value.store (writePosition + static_cast<uint32> (numToWrite),
+                                       std::memory_order_release);
+
+    return numToWrite;
+}
+
+int AudioFifo::popWithRamp (int reader, const AudioSourceChannelInfo& outInfo,
+                            float startGain, float endGain)
+{
+    auto& storage = getReaderStorage (reader);
+    auto& readPositionRef = storage.readPositions[reader].value;
+
+    const auto writePosition = storage.writePosition.value.load (std::memory_order_acquire);
+    const auto readPosition = readPositionRef.load (std::memory_order_relaxed);
+
+    const int numReady = static_cast<int> (writePosition - readPosition);
+    const int numToRead = jmin (outInfo.numSamples, numReady);
+
+    if (numToRead <= 0)
+        return 0;
+
+    const int startIndex1 = static_cast<int> (readPosition & storage.mask);
+    const int blockSize1 = jmin (numToRead, storage.capacity - startIndex1);
+    const int blockSize2 = numToRead - blockSize1;
+
+    auto* outBuffer = outInfo.buffer;
+    const auto& buffer = storage.buffer;
+    const auto channelsRequired = outBuffer->getNumChannels();
+    const auto channelsToProcess = jmin (buffer.getNumChannels(), channelsRequired);
+
+    const float midGain = getMidGain (startGain, endGain, blockSize1, blockSize2);
+
+    if (blockSize1 > 0)
+    {
+        const int outStartIndex1 = outInfo.startSample;
+
+        for (int ch = 0; ch < channelsToProcess; ++ch)
+        {
+            outBuffer->copyFromWithRamp (ch, outStartIndex1,
+                                         buffer.getReadPointer (ch, startIndex1),
+                                         blockSize1,
+                                         startGain, midGain);
+        }
+
+        // Clear any remaining channels:
+        for (int ch = channelsToProcess; ch < channelsRequired; ++ch)
+        {
+            outBuffer->clear (ch, outStartIndex1, blockSize1);
+        }
+    }
+
+    if (blockSize2 > 0)
+    {
+        const int outStartIndex2 = outInfo.startSample + blockSize1;
+
+        for (int ch = 0; ch < channelsToProcess; ++ch)
+        {
+            outBuffer->copyFromWithRamp (ch, outStartIndex2,
+                                         buffer.getReadPointer (ch, 0),
+                                         blockSize2,
+                                         midGain, endGain);
+        }
+
+        // Clear any remaining channels:
+        for (int ch = channelsToProcess; ch < channelsRequired; ++ch)
+        {
+            outBuffer->clear (ch, outStartIndex2, blockSize2);
+        }
+    }
+
+    // Release the space to the producer
+    readPositionRef.store (readPosition + static_cast<uint32> (numToRead),
+                           std::memory_order_release);
+
+    return numToRead;
+}
+
+float AudioFifo::getMidGain (float startGain, float endGain,
+                             int blockSize1, int blockSize2)
+{
+    if (startGain == endGain)
+        return startGain;
+
+    float midRatio = static_cast<float> (blockSize1) / (blockSize1 + blockSize2);
+
+    return jmap (midRatio, startGain, endGain);
+}
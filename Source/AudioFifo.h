@@ -1,105 +1,210 @@
-/*
-  ==============================================================================
-
-    AudioFifo.h
-    Created: 28 Sep 2022 7:40:25pm
-    Author:  Anthony Alfimov
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-
-/**
-    Thread-safe resizable FIFO for audio samples
-*/
-class AudioFifo
-{
-public:
-    AudioFifo() = default;
-
-    //==========================================================================
-    /** [Realtime] [Thread-safe]
-        Returns the number of channels of audio data that this FIFO contains.
-    */
-    int getNumChannels() const { return buffer.getNumChannels(); }
-
-    /** [Realtime] [Thread-safe]
-        Returns the number of samples allocated in each of the FIFO's channels.
-    */
-    int getTotalSize() const;
-
-    /** [Realtime] [Thread-safe]
-        Returns the number of samples that can currently be added to the FIFO
-        without it overflowing.
-    */
-    int getFreeSpace() const { return fifoManager.getFreeSpace(); }
-
-    /** [Realtime] [Thread-safe]
-        Returns the number of samples that can currently be read from the FIFO.
-    */
-    int getNumReady() const { return fifoManager.getNumReady(); }
-
-    //==========================================================================
-    /** [Non-realtime] [Non-thread-safe]
-        Changes the FIFO's size or number of channels.
-
-        This can expand or contract the FIFO's length, and add or remove channels.
-
-        If the required memory can't be allocated, this will throw a std::bad_alloc
-        exception.
-
-        @param newNumChannels       the new number of channels.
-        @param newNumSamples        the new number of samples.
-     */
-    void setSize (int newNumChannels, int newNumSamples);
-
-    /** [Realtime] [Non-thread-safe]
-        Clears the FIFO.
-    */
-    void reset();
-
-    //==========================================================================
-    /** [Realtime] [Thread-safe]
-        Push samples to the FIFO.
-
-        @returns    the number of samples pushed to the FIFO.
-    */
-    int push (const AudioSourceChannelInfo& inInfo);
-
-    /** [Realtime] [Thread-safe]
-        Pop samples from the FIFO.
-
-        @returns    the number of samples popped from the FIFO.
-    */
-    int pop (const AudioSourceChannelInfo& outInfo);
-
-    /** [Realtime] [Thread-safe]
-     Push samples to the FIFO and apply a gain ramp.
-
-     @returns    the number of samples pushed to the FIFO.
-     */
-    int pushWithRamp (const AudioSourceChannelInfo& inInfo,
-                      float startGain, float endGain);
-
-    /** [Realtime] [Thread-safe]
-     Pop samples from the FIFO and apply a gain ramp.
-
-     @returns    the number of samples popped from the FIFO.
-     */
-    int popWithRamp (const AudioSourceChannelInfo& outInfo,
-                     float startGain, float endGain);
-
-private:
-    AbstractFifo fifoManager { defaultSize };
-    AudioBuffer<float> buffer { 2, defaultSize };
-
-    inline static constexpr int defaultSize = 512;
-
-    float getMidGain (float startGain, float endGain, int blockSize1, int blockSize2);
-
-    //==========================================================================
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioFifo)
-};
+/*
+  ==============================================================================
+
+    AudioFifo.h
+    Created: 28 Sep 2022 7:40:25pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Wait-free resizable broadcast FIFO for audio samples
+
+    One producer thread pushes each block once, and up to `maxNumReaders`
+    consumer threads pop it independently, each through its own read cursor.
+    Nobody ever waits for anybody else. The producer can only overwrite samples
+    that every active reader has already consumed.
+
+    Write and read positions live on separate cache lines and wrap around
+    a power-of-two capacity with a bit mask.
+
+    Resizing never blocks the audio threads. A new storage block is published,
+    and each audio thread switches to it at the start of its next call and
+    acknowledges the switch. Storage blocks that all threads have moved past
+    are retired on the next resize.
+
+    Readers must be attached before they start popping and detached when they
+    stop, so that a stopped reader doesn't hold the producer back.
+*/
+class AudioFifo
+{
+public:
+    AudioFifo();
+
+    //==========================================================================
+    /** [Realtime] [Thread-safe]
+        Returns the number of channels of audio data that this FIFO contains.
+    */
+    int getNumChannels() const;
+
+    /** [Realtime] [Thread-safe]
+        Returns the number of samples that the FIFO can hold.
+    */
+    int getTotalSize() const;
+
+    /** [Realtime] [Producer thread only]
+        Returns the number of samples that can currently be added to the FIFO
+        without overwriting samples that an active reader hasn't read yet.
+    */
+    int getFreeSpace();
+
+    /** [Realtime] [Reader thread only]
+        Returns the number of samples that can currently be read by the reader.
+    */
+    int getNumReady (int reader);
+
+    //==========================================================================
+    /** [Non-realtime] [Non-thread-safe]
+        Changes the FIFO's size or number of channels.
+
+        The new storage is published to the audio threads, which pick it up
+        on their next call. The contents of the FIFO are discarded.
+
+        Must not be called concurrently from several threads, but is safe to call
+        while the producer and reader threads are running.
+
+        If the required memory can't be allocated, this will throw a std::bad_alloc
+        exception.
+
+        @param newNumChannels       the new number of channels.
+        @param newNumSamples        the new number of samples.
+     */
+    void setSize (int newNumChannels, int newNumSamples);
+
+    /** [Realtime] [Reader thread only]
+        Discards all samples that are ready to be read by the reader.
+    */
+    void reset (int reader);
+
+    /** [Realtime] [Reader thread only]
+        Discards up to `numSamples` of the oldest samples ready to be read
+        by the reader.
+
+        @returns    the number of samples discarded.
+    */
+    int discard (int reader, int numSamples);
+
+    //==========================================================================
+    /** [Non-realtime] [Thread-safe]
+        Attaches a reader. Must be called before the reader thread starts.
+        The reader starts reading from the current write position on its
+        first call.
+    */
+    void attachReader (int reader);
+
+    /** [Non-realtime] [Thread-safe]
+        Detaches a reader. Must be called after the reader thread has stopped.
+    */
+    void detachReader (int reader);
+
+    //==========================================================================
+    /** [Realtime] [Producer thread only]
+        Push samples to the FIFO.
+
+        @returns    the number of samples pushed to the FIFO.
+    */
+    int push (const AudioSourceChannelInfo& inInfo);
+
+    /** [Realtime] [Reader thread only]
+        Pop samples from the FIFO.
+
+        @returns    the number of samples popped from the FIFO.
+    */
+    int pop (int reader, const AudioSourceChannelInfo& outInfo);
+
+    /** [Realtime] [Producer thread only]
+     Push samples to the FIFO and apply a gain ramp.
+
+     @returns    the number of samples pushed to the FIFO.
+     */
+    int pushWithRamp (const AudioSourceChannelInfo& inInfo,
+                      float startGain, float endGain);
+
+    /** [Realtime] [Reader thread only]
+     Pop samples from the FIFO and apply a gain ramp.
+
+     @returns    the number of samples popped from the FIFO.
+     */
+    int popWithRamp (int reader, const AudioSourceChannelInfo& outInfo,
+                     float startGain, float endGain);
+
+    //==========================================================================
+    inline static constexpr int maxNumReaders = 8;
+
+private:
+    //==========================================================================
+    inline static constexpr int defaultSize = 512;
+    inline static constexpr size_t cacheLineSize = 64;
+
+    struct alignas (cacheLineSize) Position
+    {
+        std::atomic<uint32> value { 0 };
+    };
+
+    /** Sample storage together with its write and read positions.
+
+        Positions are free-running counters, so the number of samples ready
+        for a reader is always `writePosition - readPosition`, and the index
+        into the buffer is the position masked by `capacity - 1`.
+    */
+    struct Storage
+    {
+        Storage (int numChannels, int numSamples);
+
+        AudioBuffer<float> buffer;
+        const int size;         // number of samples the FIFO can hold
+        const int capacity;     // allocated size, power of two
+        const uint32 mask;
+
+        Position writePosition;
+        Position readPositions[maxNumReaders];
+
+        JUCE_DECLARE_NON_COPYABLE (Storage)
+    };
+
+    /** State of an audio thread that accesses the FIFO. */
+    struct alignas (cacheLineSize) View
+    {
+        Storage* storage = nullptr;     // only accessed by the audio thread
+        std::atomic<Storage*> acknowledged { nullptr };
+
+        // Reader state
+        std::atomic<bool> active { false };
+        std::atomic<bool> attachRequested { false };
+    };
+
+    //==========================================================================
+    // Storage handoff between the resizing thread and the audio threads
+    OwnedArray<Storage> storages;
+    std::atomic<Storage*> publishedStorage { nullptr };
+
+    View producer;
+    View readers[maxNumReaders];
+
+    // Dimensions of the published storage, so that they can be read from any
+    //  thread without holding on to a storage block that may be retired
+    std::atomic<int> numChannels { 0 };
+    std::atomic<int> totalSize { 0 };
+
+    /** [Realtime] Switches the calling audio thread to the latest storage. */
+    Storage& getProducerStorage();
+    Storage& getReaderStorage (int reader);
+
+    /** [Non-realtime] Deletes the storage blocks no audio thread can access. */
+    void retireStorage();
+
+    /** [Realtime] Returns free space as seen by the producer. */
+    int getFreeSpace (Storage& storage) const;
+
+    //==========================================================================
+    static float getMidGain (float startGain, float endGain,
+                             int blockSize1, int blockSize2);
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioFifo)
+};
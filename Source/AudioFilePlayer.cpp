@@ -1,176 +1,460 @@
-/*
-  ==============================================================================
-
-    AudioFilePlayer.cpp
-    Created: 18 Sep 2022 7:27:20pm
-    Author:  Anthony Alfimov
-
-  ==============================================================================
-*/
-
-#include "AudioFilePlayer.h"
-
-AudioFilePlayer::AudioFilePlayer()
-{
-    transportSource.addChangeListener (this);
-
-    //==========================================================================
-    // Check that atomic bool is lock-free
-    static_assert (std::atomic<bool>::is_always_lock_free,
-                   "std::atomic for type bool must be always lock free");
-}
-
-//==============================================================================
-void AudioFilePlayer::setAudioFormatReader (AudioFormatReader* reader)
-{
-    if (reader == nullptr)      // if reader is not created, abort
-        return;
-
-    // Pass reader ownership to newSource:
-    auto newSource = std::make_unique<AudioFormatReaderSource> (reader, true);
-
-    {
-        SpinLock::ScopedLockType readerLoopingLock (readerLoopingMutex);
-
-        // Set input source for the transportSource object:
-        transportSource.setSource (newSource.get(), 0, nullptr, reader->sampleRate);
-
-        // Transfer memory ownership of the audio source to readerSource ptr:
-        readerSource.reset (newSource.release());
-
-        // Update transport state:
-        changeState (TransportState::Stopped);
-    }
-}
-
-//==========================================================================
-void AudioFilePlayer::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
-{
-    transportSource.prepareToPlay (samplesPerBlockExpected, sampleRate);
-}
-
-void AudioFilePlayer::getNextAudioBlock (const AudioSourceChannelInfo& info)
-{
-    {
-        SpinLock::ScopedTryLockType readerLoopingLock (readerLoopingMutex);
-
-        if (readerLoopingLock.isLocked() && readerSource != nullptr)
-            readerSource->setLooping (looping.load());
-    }
-
-    transportSource.getNextAudioBlock (info);
-
-    if (! transportSource.isPlaying())
-    {
-        shouldFadeIn = true;
-        return;
-    }
-
-    if (shouldFadeIn)
-    {
-        // Just started playing, so fade in the first block:
-        const int fadeInLength = jmin (256, info.numSamples);
-        info.buffer->applyGainRamp (info.startSample, fadeInLength, 0.0f, 1.0f);
-        shouldFadeIn = false;
-    }
-}
-
-void AudioFilePlayer::releaseResources()
-{
-    transportSource.releaseResources();
-}
-
-//==============================================================================
-void AudioFilePlayer::playPause()
-{
-    if ((state == TransportState::Stopped) || (state == TransportState::Paused))
-        changeState (TransportState::Starting);
-    else if (state == TransportState::Playing)
-        changeState (TransportState::Pausing);
-}
-
-void AudioFilePlayer::stop()
-{
-    if (state == TransportState::Stopped)
-        return;
-
-    if (state == TransportState::Paused)
-        changeState (TransportState::Stopped);
-    else
-        changeState (TransportState::Stopping);
-}
-
-//==============================================================================
-double AudioFilePlayer::getCurrentPosition() const
-{
-    // getCurrentPosition() method accesses readerSource, so we need to lock:
-    SpinLock::ScopedLockType readerLoopingLock (readerLoopingMutex);
-    return transportSource.getCurrentPosition();
-}
-
-//==============================================================================
-void AudioFilePlayer::addChangeListener (ChangeListener* listener)
-{
-    transportSource.addChangeListener (listener);
-}
-
-//==============================================================================
-void AudioFilePlayer::changeState (TransportState newState)
-{
-    if (state == newState)
-        return;
-
-    state = newState;
-
-    switch (state)
-    {
-        case TransportState::Stopped:
-            transportSource.setPosition (0.0);
-
-            if (onTransportStopped != nullptr)
-                onTransportStopped();
-
-            break;
-
-        case TransportState::Starting:
-            transportSource.start();
-            break;
-
-        case TransportState::Playing:
-            if (onTransportStarted != nullptr)
-                onTransportStarted();
-
-            break;
-
-        case TransportState::Pausing:
-            transportSource.stop();
-            break;
-
-        case TransportState::Paused:
-            if (onTransportPaused != nullptr)
-                onTransportPaused();
-
-            break;
-
-        case TransportState::Stopping:
-            transportSource.stop();
-            break;
-
-        default:
-            break;
-    }
-}
-
-//==============================================================================
-void AudioFilePlayer::changeListenerCallback (ChangeBroadcaster* source)
-{
-    if (source != &transportSource)
-        return;
-
-    if (transportSource.isPlaying())
-        changeState (TransportState::Playing);
-    else if ((state == TransportState::Stopping) || (state == TransportState::Playing))
-        changeState (TransportState::Stopped);
-    else if (state == TransportState::Pausing)
-        changeState (TransportState::Paused);
-}
+/*
+  ==============================================================================
+
+    AudioFilePlayer.cpp
+    Created: 18 Sep 2022 7:27:20pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "AudioFilePlayer.h"
+
+AudioFilePlayer::AudioFilePlayer()
+{
+    transportSource.addChangeListener (this);
+    readAheadThread.startThread();
+    prefetchThread.startThread();
+
+    //==========================================================================
+    // Check that atomic bool is lock-free
+    static_assert (std::atomic<bool>::is_always_lock_free,
+                   "std::atomic for type bool must be always lock free");
+}
+
+AudioFilePlayer::~AudioFilePlayer()
+{
+    // Queued files are opened with the objects below
+    waitForQueuedFiles();
+}
+
+//==============================================================================
+void AudioFilePlayer::setAudioFormatReader (AudioFormatReader* reader)
+{
+    if (reader == nullptr)      // if reader is not created, abort
+        return;
+
+    preloader.reset();
+    setSource (createTrack (reader));
+}
+
+void AudioFilePlayer::setDecodedAudio (DecodedAudioCache::DecodedAudioPtr audio)
+{
+    if (audio == nullptr)
+        return;
+
+    preloader.reset();
+
+    const auto sampleRate = audio->sampleRate;
+    const auto numChannels = getNumTrackChannels (audio->buffer.getNumChannels());
+    setSource (std::make_unique<PlaylistAudioSource::Track> (std::make_unique<CachedAudioSource> (std::move (audio)),
+                                                             sampleRate, numChannels));
+}
+
+bool AudioFilePlayer::preloadFile (const File& file, AudioFormatManager& formatManager)
+{
+    // Free the cores from a previous preload first
+    preloader.reset();
+
+    auto newPreloader = std::make_unique<ParallelAudioDecoder> (formatManager, file);
+    auto audio = newPreloader->getDecodedAudio();
+
+    if (audio == nullptr)
+        return false;
+
+    preloader = std::move (newPreloader);
+
+    const auto sampleRate = audio->sampleRate;
+    const auto numChannels = getNumTrackChannels (audio->buffer.getNumChannels());
+    setSource (std::make_unique<PlaylistAudioSource::Track> (std::make_unique<CachedAudioSource> (std::move (audio)),
+                                                             sampleRate, numChannels));
+
+    return true;
+}
+
+double AudioFilePlayer::getPreloadProgress() const
+{
+    if (preloader == nullptr || preloader->isFinished())
+        return 1.0;
+
+    return preloader->getProgress();
+}
+
+bool AudioFilePlayer::isReadyToPlay() const
+{
+    return preloader == nullptr
+        || preloader->hasDecodingFailed()
+        || preloader->getDecodedAudio()->numReadySamples.load() > 0;
+}
+
+bool AudioFilePlayer::hasPreloadFailed() const
+{
+    return preloader != nullptr && preloader->hasDecodingFailed();
+}
+
+void AudioFilePlayer::setSource (std::unique_ptr<PlaylistAudioSource::Track> firstTrack)
+{
+    auto newSource = std::make_unique<PlaylistAudioSource> (std::move (firstTrack));
+    newSource->setCrossfadeTime (crossfadeTime);
+
+    newSource->onTrackChanged = [this]
+    {
+        // The preloaded file has finished playing
+        preloader.reset();
+
+        if (onQueuedFileStarted != nullptr)
+            onQueuedFileStarted();
+    };
+
+    const ScopedLock queueScopedLock (queueLock);
+    SpinLock::ScopedLockType readerLoopingLock (readerLoopingMutex);
+
+    // Set input source for the transportSource object. The playlist resamples
+    //  every file to the output sample rate itself.
+    transportSource.setSource (newSource.get(), 0, nullptr, 0.0);
+
+    // Transfer memory ownership of the audio source to readerSource ptr:
+    readerSource = std::move (newSource);
+    ++numFilesLoaded;
+
+    startScheduled.store (false);
+
+    // Update transport state:
+    changeState (TransportState::Stopped);
+}
+
+std::unique_ptr<PlaylistAudioSource::Track> AudioFilePlayer::createTrack (AudioFormatReader* reader)
+{
+    const auto numChannels = getNumTrackChannels (static_cast<int> (reader->numChannels));
+    const auto sampleRate = reader->sampleRate;
+
+    // Pass reader ownership to newSource, which reads it on the background
+    //  thread:
+    auto newSource = std::make_unique<ReadAheadAudioSource>
+        (new AudioFormatReaderSource (reader, true), true,
+         readAheadThread, readAheadTime, numChannels);
+
+    auto* newReadAheadSource = newSource.get();
+    auto track = std::make_unique<PlaylistAudioSource::Track> (std::move (newSource),
+                                                               sampleRate, numChannels,
+                                                               newReadAheadSource);
+
+    // Keep the pages of a memory-mapped file resident ahead of the read-ahead
+    //  window, so that reading it doesn't wait for the disk
+    if (auto* mappedReader = dynamic_cast<MemoryMappedAudioFormatReader*> (reader))
+        track->prefetcher = std::make_unique<MappedReaderPrefetcher> (*mappedReader,
+                                                                      *track->source,
+                                                                      prefetchThread,
+                                                                      2.0 * readAheadTime);
+
+    return track;
+}
+
+//==============================================================================
+void AudioFilePlayer::queueFile (const File& file, AudioFormatManager& formatManager)
+{
+    const auto fileLoaded = numFilesLoaded;
+
+    queueThread.addJob ([this, file, &formatManager, fileLoaded]
+    {
+        // Uncompressed files are memory-mapped, others are streamed
+        AudioFormatReader* reader = MappedReaderPrefetcher::createMappedReader (formatManager, file);
+
+        if (reader == nullptr)
+            reader = formatManager.createReaderFor (file);
+
+        if (reader == nullptr)
+            return;
+
+        auto track = createTrack (reader);
+
+        // Queueing prepares the track, which only registers its read-ahead
+        //  source with the read-ahead thread. The buffer fills there, well
+        //  before the track starts
+        const ScopedLock queueScopedLock (queueLock);
+
+        if (readerSource != nullptr && numFilesLoaded == fileLoaded)
+            readerSource->queueTrack (std::move (track));
+    });
+}
+
+void AudioFilePlayer::queueDecodedAudio (DecodedAudioCache::DecodedAudioPtr audio)
+{
+    if (audio == nullptr)
+        return;
+
+    const auto sampleRate = audio->sampleRate;
+    const auto numChannels = getNumTrackChannels (audio->buffer.getNumChannels());
+    auto track = std::make_unique<PlaylistAudioSource::Track> (std::make_unique<CachedAudioSource> (std::move (audio)),
+                                                               sampleRate, numChannels);
+
+    const ScopedLock queueScopedLock (queueLock);
+
+    if (readerSource != nullptr)
+        readerSource->queueTrack (std::move (track));
+}
+
+void AudioFilePlayer::waitForQueuedFiles()
+{
+    queueThread.removeAllJobs (false, -1);
+}
+
+bool AudioFilePlayer::hasQueuedFile() const
+{
+    const ScopedLock queueScopedLock (queueLock);
+    return readerSource != nullptr && readerSource->hasQueuedTrack();
+}
+
+void AudioFilePlayer::setCrossfadeTime (double crossfadeInSeconds)
+{
+    crossfadeTime = jmax (0.0, crossfadeInSeconds);
+
+    const ScopedLock queueScopedLock (queueLock);
+
+    if (readerSource != nullptr)
+        readerSource->setCrossfadeTime (crossfadeTime);
+}
+
+//==========================================================================
+void AudioFilePlayer::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    outputSampleRate = sampleRate;
+    transportSource.prepareToPlay (samplesPerBlockExpected, sampleRate);
+}
+
+void AudioFilePlayer::getNextAudioBlock (const AudioSourceChannelInfo& info)
+{
+    {
+        SpinLock::ScopedTryLockType readerLoopingLock (readerLoopingMutex);
+
+        if (readerLoopingLock.isLocked() && readerSource != nullptr)
+            readerSource->setLooping (looping.load());
+    }
+
+    if (startScheduled.load())
+    {
+        if (! renderScheduledStart (info))
+            info.clearActiveBufferRegion();
+
+        return;
+    }
+
+    transportSource.getNextAudioBlock (info);
+
+    if (! transportSource.isPlaying())
+    {
+        shouldFadeIn = true;
+        return;
+    }
+
+    if (shouldFadeIn)
+    {
+        // Just started playing, so fade in the first block:
+        const int fadeInLength = jmin (256, info.numSamples);
+        info.buffer->applyGainRamp (info.startSample, fadeInLength, 0.0f, 1.0f);
+        shouldFadeIn = false;
+    }
+}
+
+void AudioFilePlayer::releaseResources()
+{
+    transportSource.releaseResources();
+}
+
+bool AudioFilePlayer::renderScheduledStart (const AudioSourceChannelInfo& info)
+{
+    // The transport is started on the message thread after the start is
+    //  scheduled, so it may not be playing yet
+    if (! transportSource.isPlaying())
+        return false;
+
+    const auto ticksUntilStart = scheduledStartTime.load() - nextBlockOutputTime;
+    const auto startOffset = static_cast<double> (ticksUntilStart) * outputSampleRate
+                           / static_cast<double> (Time::getHighResolutionTicksPerSecond());
+
+    if (startOffset >= info.numSamples)
+        return false;
+
+    startScheduled.store (false);
+
+    if (startOffset < 0.0)
+    {
+        // Too late for the exact sample, so start now and fade in
+        lastStartLateness.store (-startOffset / outputSampleRate);
+        transportSource.getNextAudioBlock (info);
+        info.buffer->applyGainRamp (info.startSample, jmin (256, info.numSamples), 0.0f, 1.0f);
+    }
+    else
+    {
+        const auto numSilent = static_cast<int> (startOffset);
+
+        lastStartLateness.store (0.0);
+        info.buffer->clear (info.startSample, numSilent);
+        transportSource.getNextAudioBlock (AudioSourceChannelInfo (info.buffer,
+                                                                   info.startSample + numSilent,
+                                                                   info.numSamples - numSilent));
+    }
+
+    shouldFadeIn = false;
+    return true;
+}
+
+//==============================================================================
+void AudioFilePlayer::playPause()
+{
+    if ((state == TransportState::Stopped) || (state == TransportState::Paused))
+        changeState (TransportState::Starting);
+    else if (state == TransportState::Playing)
+        changeState (TransportState::Pausing);
+}
+
+void AudioFilePlayer::stop()
+{
+    startScheduled.store (false);
+
+    if (state == TransportState::Stopped)
+        return;
+
+    if (state == TransportState::Paused)
+        changeState (TransportState::Stopped);
+    else
+        changeState (TransportState::Stopping);
+}
+
+bool AudioFilePlayer::playAt (int64 hostTimeInTicks)
+{
+    if (! prerollScheduledStart())
+        return false;
+
+    scheduleStart (hostTimeInTicks);
+    return true;
+}
+
+bool AudioFilePlayer::playAt (Time wallClockTime)
+{
+    if (! prerollScheduledStart())
+        return false;
+
+    // The clocks are read after the pre-roll, which may have taken a while
+    const auto delayInMs = wallClockTime.toMilliseconds() - Time::currentTimeMillis();
+    scheduleStart (Time::getHighResolutionTicks()
+                   + Time::secondsToHighResolutionTicks (0.001 * static_cast<double> (delayInMs)));
+    return true;
+}
+
+bool AudioFilePlayer::playIn (double delayInSeconds)
+{
+    if (! prerollScheduledStart())
+        return false;
+
+    scheduleStart (Time::getHighResolutionTicks()
+                   + Time::secondsToHighResolutionTicks (delayInSeconds));
+    return true;
+}
+
+bool AudioFilePlayer::prerollScheduledStart()
+{
+    if ((state != TransportState::Stopped) && (state != TransportState::Paused))
+        return false;
+
+    // Pre-roll the read-ahead buffer before the start is armed, so that
+    //  the first block is ready whenever the start time comes
+    if (readerSource != nullptr)
+        readerSource->waitForNextAudioBlockReady (startTimeout);
+
+    return true;
+}
+
+void AudioFilePlayer::scheduleStart (int64 hostTimeInTicks)
+{
+    scheduledStartTime.store (hostTimeInTicks);
+    startScheduled.store (true);
+
+    changeState (TransportState::Starting);
+}
+
+//==============================================================================
+double AudioFilePlayer::getCurrentPosition() const
+{
+    // getCurrentPosition() method accesses readerSource, so we need to lock:
+    SpinLock::ScopedLockType readerLoopingLock (readerLoopingMutex);
+    return transportSource.getCurrentPosition();
+}
+
+int AudioFilePlayer::getNumReadAheadUnderruns() const
+{
+    SpinLock::ScopedLockType readerLoopingLock (readerLoopingMutex);
+    return readerSource != nullptr ? readerSource->getNumReadAheadUnderruns() : 0;
+}
+
+//==============================================================================
+void AudioFilePlayer::addChangeListener (ChangeListener* listener)
+{
+    transportSource.addChangeListener (listener);
+}
+
+//==============================================================================
+void AudioFilePlayer::changeState (TransportState newState)
+{
+    if (state == newState)
+        return;
+
+    state = newState;
+
+    switch (state)
+    {
+        case TransportState::Stopped:
+            transportSource.setPosition (0.0);
+
+            if (onTransportStopped != nullptr)
+                onTransportStopped();
+
+            break;
+
+        case TransportState::Starting:
+            // Give the background thread a chance to buffer the first block.
+            //  A scheduled start has been pre-rolled already
+            if (readerSource != nullptr && ! startScheduled.load())
+                readerSource->waitForNextAudioBlockReady (startTimeout);
+
+            transportSource.start();
+            break;
+
+        case TransportState::Playing:
+            if (onTransportStarted != nullptr)
+                onTransportStarted();
+
+            break;
+
+        case TransportState::Pausing:
+            transportSource.stop();
+            break;
+
+        case TransportState::Paused:
+            if (onTransportPaused != nullptr)
+                onTransportPaused();
+
+            break;
+
+        case TransportState::Stopping:
+            transportSource.stop();
+            break;
+
+        default:
+            break;
+    }
+}
+
+//==============================================================================
+void AudioFilePlayer::changeListenerCallback (ChangeBroadcaster* source)
+{
+    if (source != &transportSource)
+        return;
+
+    if (transportSource.isPlaying())
+        changeState (TransportState::Playing);
+    else if ((state == TransportState::Stopping) || (state == TransportState::Playing))
+        changeState (TransportState::Stopped);
+    else if (state == TransportState::Pausing)
+        changeState (TransportState::Paused);
+}
@@ -1,83 +1,254 @@
-/*
-  ==============================================================================
-
-    AudioFilePlayer.h
-    Created: 18 Sep 2022 7:27:20pm
-    Author:  Anthony Alfimov
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-
-// TODO: Pre-buffer the file that is playing
-
-class AudioFilePlayer  : public AudioSource,
-                         public ChangeListener
-{
-public:
-    AudioFilePlayer();
-
-    //==========================================================================
-    // Load audio to play
-    void setAudioFormatReader (AudioFormatReader* reader);
-
-    //==========================================================================
-    // Audio processing
-    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
-    void getNextAudioBlock (const AudioSourceChannelInfo& info) override;
-    void releaseResources() override;
-
-    //==========================================================================
-    // Player transport controls
-    void playPause();
-    void stop();
-    void setLooping (bool shouldLoop) { looping.store (shouldLoop); }
-
-    //==========================================================================
-    // Player transport state
-    bool isPlaying() const { return transportSource.isPlaying(); }
-    bool isLooping() const { return transportSource.isLooping(); }
-    double getCurrentPosition() const;
-
-    //==========================================================================
-    // Transport state change callbacks
-    std::function<void()> onTransportStarted;
-    std::function<void()> onTransportPaused;
-    std::function<void()> onTransportStopped;
-
-    //==========================================================================
-    // Register a listener to receive change callbacks
-    void addChangeListener (ChangeListener* listener);
-
-private:
-    enum class TransportState
-    {
-        Stopped,
-        Starting,
-        Playing,
-        Pausing,
-        Paused,
-        Stopping
-    };
-
-    void changeState (TransportState newState);
-
-    std::atomic<bool> looping = false;
-    bool shouldFadeIn = true;
-
-    std::unique_ptr<AudioFormatReaderSource> readerSource;
-    AudioTransportSource transportSource;
-    TransportState state = TransportState::Stopped;
-
-    SpinLock readerLoopingMutex;
-
-    //==========================================================================
-    // Change listener callback
-    void changeListenerCallback (ChangeBroadcaster* source) override;
-
-    //==========================================================================
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioFilePlayer);
-};
+/*
+  ==============================================================================
+
+    AudioFilePlayer.h
+    Created: 18 Sep 2022 7:27:20pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ReadAheadAudioSource.h"
+#include "MappedReaderPrefetcher.h"
+#include "CachedAudioSource.h"
+#include "ParallelAudioDecoder.h"
+#include "PlaylistAudioSource.h"
+
+class AudioFilePlayer  : public AudioSource,
+                         public ChangeListener
+{
+public:
+    AudioFilePlayer();
+    ~AudioFilePlayer() override;
+
+    //==========================================================================
+    // Load audio to play. Memory-mapped readers are prefetched ahead of
+    //  the play head.
+    void setAudioFormatReader (AudioFormatReader* reader);
+
+    // Play a file from the decoded audio cache, without decoding it
+    void setDecodedAudio (DecodedAudioCache::DecodedAudioPtr audio);
+
+    /** Decodes the whole file into memory on all CPU cores and plays it from
+        there. Playback can start as soon as the first segment is decoded.
+
+        @returns    false if the file can't be read.
+    */
+    bool preloadFile (const File& file, AudioFormatManager& formatManager);
+
+    /** Returns the decoded proportion of the preloaded file, between 0 and 1.
+        Returns 1 if the file isn't being preloaded.
+    */
+    double getPreloadProgress() const;
+
+    /** Returns false while the start of a preloaded file is being decoded. */
+    bool isReadyToPlay() const;
+
+    /** Returns true if the preloaded file couldn't be decoded completely.
+        It then plays up to the end of its decoded part.
+    */
+    bool hasPreloadFailed() const;
+
+    /** Sets the size of the window that is read ahead of the playback position
+        on the background thread. Applies to the next file that is loaded.
+    */
+    void setReadAheadTime (double readAheadInSeconds) { readAheadTime = readAheadInSeconds; }
+    double getReadAheadTime() const { return readAheadTime; }
+
+    //==========================================================================
+    /** Queues a file to play right after the current one, with no gap and
+        no need to press play again. The file is opened, and the start of it
+        is buffered, on a background thread. A file queued earlier is replaced
+        if it hasn't started yet.
+
+        Does nothing if no file is loaded.
+    */
+    void queueFile (const File& file, AudioFormatManager& formatManager);
+
+    // Queue a file from the decoded audio cache
+    void queueDecodedAudio (DecodedAudioCache::DecodedAudioPtr audio);
+
+    /** Blocks until the files passed to queueFile() have been opened.
+        The format manager must not be deleted before this returns.
+    */
+    void waitForQueuedFiles();
+
+    /** Returns true if a queued file is waiting to start. */
+    bool hasQueuedFile() const;
+
+    /** Sets the time over which the current file fades out while the queued
+        one fades in. Zero splices the files sample-accurately, without
+        overlap.
+    */
+    void setCrossfadeTime (double crossfadeInSeconds);
+    double getCrossfadeTime() const { return crossfadeTime; }
+
+    // Called on the message thread after a queued file has started
+    std::function<void()> onQueuedFileStarted;
+
+    //==========================================================================
+    // Audio processing
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    void getNextAudioBlock (const AudioSourceChannelInfo& info) override;
+    void releaseResources() override;
+
+    //==========================================================================
+    // Player transport controls
+    void playPause();
+    void stop();
+    void setLooping (bool shouldLoop) { looping.store (shouldLoop); }
+
+    //==========================================================================
+    /** Starts playback so that the first sample leaves the output at a given
+        host time. The read-ahead buffer is filled first, then the audio
+        thread holds the transport back until the block that contains the
+        start time, and starts it at the exact sample within that block.
+        The output time of every block must be set with
+        setNextBlockOutputTime().
+
+        If the start time has passed by the time it's rendered, playback
+        starts straight away with the usual fade-in.
+
+        @param hostTimeInTicks  time in Time::getHighResolutionTicks() units
+        @returns                false if the player is already playing.
+    */
+    bool playAt (int64 hostTimeInTicks);
+
+    // Start playback at a wall clock time, or after a delay. The delay is
+    //  counted from the end of the pre-roll, which can take up to startTimeout
+    bool playAt (Time wallClockTime);
+    bool playIn (double delayInSeconds);
+
+    /** [Realtime] [Audio thread only]
+        Sets the host time at which the first sample of the next block
+        leaves the output, in Time::getHighResolutionTicks() units.
+    */
+    void setNextBlockOutputTime (int64 hostTimeInTicks) { nextBlockOutputTime = hostTimeInTicks; }
+
+    /** Returns true while a scheduled start is waiting for its time. */
+    bool isStartScheduled() const { return startScheduled.load(); }
+
+    /** Returns how late the last scheduled start was heard, in seconds.
+        Zero if it started at the exact sample.
+    */
+    double getLastStartLateness() const { return lastStartLateness.load(); }
+
+    //==========================================================================
+    // Player transport state
+    bool isPlaying() const { return transportSource.isPlaying(); }
+    bool isLooping() const { return transportSource.isLooping(); }
+    double getCurrentPosition() const;
+
+    /** Returns the number of blocks that were played before they had been
+        read from disk, since the current file was loaded, including the
+        files queued after it.
+    */
+    int getNumReadAheadUnderruns() const;
+
+    //==========================================================================
+    // Transport state change callbacks. With a scheduled start, the transport
+    //  starts and onTransportStarted is called as soon as the start is armed,
+    //  before the start time; isStartScheduled() is true until it's heard
+    std::function<void()> onTransportStarted;
+    std::function<void()> onTransportPaused;
+    std::function<void()> onTransportStopped;
+
+    //==========================================================================
+    // Register a listener to receive change callbacks
+    void addChangeListener (ChangeListener* listener);
+
+private:
+    enum class TransportState
+    {
+        Stopped,
+        Starting,
+        Playing,
+        Pausing,
+        Paused,
+        Stopping
+    };
+
+    void changeState (TransportState newState);
+
+    void setSource (std::unique_ptr<PlaylistAudioSource::Track> firstTrack);
+
+    /** Creates a track that reads a file ahead on the background thread.
+        Memory-mapped readers are prefetched ahead of the play head.
+    */
+    std::unique_ptr<PlaylistAudioSource::Track> createTrack (AudioFormatReader* reader);
+
+    /** Returns the number of channels a track of a file renders. Mono files
+        are rendered on two channels, so they play on both sides of a pair.
+    */
+    static int getNumTrackChannels (int numFileChannels)
+    {
+        return jlimit (2, ChannelRouting::maxNumChannels, numFileChannels);
+    }
+
+    std::atomic<bool> looping = false;
+    bool shouldFadeIn = true;
+
+    //==========================================================================
+    // Scheduled start
+    std::atomic<bool> startScheduled { false };
+    std::atomic<int64> scheduledStartTime { 0 };    // [ticks]
+    std::atomic<double> lastStartLateness { 0.0 };  // [s]
+
+    // [Audio thread]
+    int64 nextBlockOutputTime = 0;                  // [ticks]
+    double outputSampleRate = 44100.0;
+
+    /** [Audio thread] Renders the block that may contain the scheduled start.
+
+        @returns    false if the start is later than this block.
+    */
+    bool renderScheduledStart (const AudioSourceChannelInfo& info);
+
+    /** Fills the read-ahead buffer before a scheduled start.
+
+        @returns    false if the player is already playing.
+    */
+    bool prerollScheduledStart();
+
+    /** Arms the start at a host time and starts the transport. */
+    void scheduleStart (int64 hostTimeInTicks);
+
+    // Files are read and decoded on this thread, never on the audio thread
+    TimeSliceThread readAheadThread { "Audio file read-ahead" };
+    double readAheadTime = defaultReadAheadTime;
+
+    // Pages of memory-mapped files are faulted in on this thread
+    TimeSliceThread prefetchThread { "Audio file prefetch" };
+
+    // Plays the loaded file and the files queued after it
+    std::unique_ptr<PlaylistAudioSource> readerSource;
+    std::unique_ptr<ParallelAudioDecoder> preloader;
+    AudioTransportSource transportSource;
+    TransportState state = TransportState::Stopped;
+
+    SpinLock readerLoopingMutex;
+
+    //==========================================================================
+    // Queued files are opened on this thread. The lock keeps readerSource
+    //  alive while a track is queued to it.
+    mutable CriticalSection queueLock;
+    int numFilesLoaded = 0;
+    double crossfadeTime = 0.0;     // [s]
+
+    ThreadPool queueThread { 1 };
+
+    inline static constexpr double defaultReadAheadTime = 2.0 /*s*/;
+
+    // Longest time to wait for the buffer to fill when playback starts [ms]
+    inline static constexpr int startTimeout = 500;
+
+    //==========================================================================
+    // Change listener callback
+    void changeListenerCallback (ChangeBroadcaster* source) override;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioFilePlayer);
+};
@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    CachedAudioSource.cpp
+    Created: 17 Oct 2026 4:12:09pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "CachedAudioSource.h"
+
+CachedAudioSource::CachedAudioSource (DecodedAudioCache::DecodedAudioPtr audioToPlay)
+    : audio (std::move (audioToPlay))
+{
+    jassert (audio != nullptr);
+}
+
+//==============================================================================
+int64 CachedAudioSource::getTotalLength() const
+{
+    // Decoding that failed doesn't extend the ready part any more
+    if (audio->isIncomplete.load())
+        return audio->numReadySamples.load();
+
+    return audio->buffer.getNumSamples();
+}
+
+void CachedAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    const auto& source = audio->buffer;
+    const auto length = getTotalLength();
+    const auto numSourceChannels = source.getNumChannels();
+
+    // Only the start of the file may be decoded while it's being preloaded
+    const auto numReady = audio->numReadySamples.load (std::memory_order_acquire);
+
+    if (numSourceChannels == 0)
+    {
+        bufferToFill.clearActiveBufferRegion();
+        return;
+    }
+
+    const auto startPosition = nextPlayPosition.load();
+    auto position = startPosition;
+    int numDone = 0;
+
+    while (numDone < bufferToFill.numSamples)
+    {
+        if (position >= length)
+        {
+            if (! looping.load() || length == 0)
+            {
+                // Past the end of the file, so the rest of the block is silent
+                bufferToFill.buffer->clear (bufferToFill.startSample + numDone,
+                                            bufferToFill.numSamples - numDone);
+                position += bufferToFill.numSamples - numDone;
+                break;
+            }
+
+            position %= length;
+        }
+
+        if (position >= numReady)
+        {
+            // Wait for the decoder without moving on, so nothing is skipped
+            bufferToFill.buffer->clear (bufferToFill.startSample + numDone,
+                                        bufferToFill.numSamples - numDone);
+            break;
+        }
+
+        const auto numToCopy = static_cast<int> (jmin (static_cast<int64> (bufferToFill.numSamples
+                                                                           - numDone),
+                                                       numReady - position));
+
+        // Mono files are played on all channels, and channels that other
+        //  files don't have are silent
+        for (int ch = 0; ch < bufferToFill.buffer->getNumChannels(); ++ch)
+        {
+            if (numSourceChannels == 1 || ch < numSourceChannels)
+                bufferToFill.buffer->copyFrom (ch, bufferToFill.startSample + numDone,
+                                               source, numSourceChannels == 1 ? 0 : ch,
+                                               static_cast<int> (position), numToCopy);
+            else
+                bufferToFill.buffer->clear (ch, bufferToFill.startSample + numDone, numToCopy);
+        }
+
+        position += numToCopy;
+        numDone += numToCopy;
+    }
+
+    // Keep the new position if the source was moved during this block
+    auto expected = startPosition;
+    nextPlayPosition.compare_exchange_strong (expected, position);
+}
@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    CachedAudioSource.h
+    Created: 17 Oct 2026 4:12:09pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DecodedAudioCache.h"
+
+/**
+    Positionable source that plays a file from the decoded audio cache.
+
+    Playback only copies samples, so it has no decoding or disk cost. The source
+    keeps its decoded audio alive, even if it is evicted from the cache.
+
+    If the audio is still being decoded, playback holds its position with
+    silence when it reaches the part that is not ready yet.
+*/
+class CachedAudioSource  : public PositionableAudioSource
+{
+public:
+    explicit CachedAudioSource (DecodedAudioCache::DecodedAudioPtr audioToPlay);
+
+    //==========================================================================
+    void prepareToPlay (int /*samplesPerBlockExpected*/, double /*sampleRate*/) override {}
+    void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
+    void releaseResources() override {}
+
+    //==========================================================================
+    /** [Realtime] [Thread-safe] */
+    void setNextReadPosition (int64 newPosition) override { nextPlayPosition.store (newPosition); }
+
+    /** [Realtime] [Thread-safe] */
+    int64 getNextReadPosition() const override { return nextPlayPosition.load(); }
+
+    /** [Realtime] [Thread-safe]
+        Returns the length of the file, or of its decoded part if decoding
+        failed.
+    */
+    int64 getTotalLength() const override;
+
+    /** [Realtime] [Thread-safe] */
+    bool isLooping() const override { return looping.load(); }
+
+    /** [Realtime] [Thread-safe] */
+    void setLooping (bool shouldLoop) override { looping.store (shouldLoop); }
+
+private:
+    const DecodedAudioCache::DecodedAudioPtr audio;
+
+    std::atomic<int64> nextPlayPosition { 0 };
+    std::atomic<bool> looping { false };
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CachedAudioSource)
+};
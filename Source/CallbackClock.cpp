@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    CallbackClock.cpp
+    Created: 17 Oct 2026 11:24:06pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "CallbackClock.h"
+
+CallbackClock::CallbackClock()
+    : ticksPerSecond (static_cast<double> (Time::getHighResolutionTicksPerSecond()))
+{
+    reset (44100.0);
+}
+
+void CallbackClock::reset (double sampleRate)
+{
+    jassert (sampleRate > 0.0);
+
+    ticksPerSample.store (ticksPerSecond / sampleRate);
+    hasEstimate = false;
+    estimatedTime = 0.0;
+    previousNumSamples = 0;
+    peakJitter.store (0.0);
+}
+
+int64 CallbackClock::update (int64 callbackTimeInTicks, int numSamples)
+{
+    const auto measuredTime = static_cast<double> (callbackTimeInTicks);
+    const auto previousBlockDuration = previousNumSamples
+                                     * ticksPerSample.load (std::memory_order_relaxed);
+    const auto predictedTime = estimatedTime + previousBlockDuration;
+
+    const auto error = measuredTime - predictedTime;
+
+    if (! hasEstimate || std::abs (error) > maxErrorInSeconds * ticksPerSecond)
+    {
+        estimatedTime = measuredTime;
+        hasEstimate = true;
+    }
+    else
+    {
+        estimatedTime = predictedTime + smoothingCoefficient * error;
+
+        // Discontinuities are not jitter, so only these errors are measured
+        const auto jitter = std::abs (measuredTime - estimatedTime) / ticksPerSecond;
+        const auto release = std::exp (-previousBlockDuration / (peakJitterReleaseTime * ticksPerSecond));
+
+        peakJitter.store (jmax (jitter, release * peakJitter.load (std::memory_order_relaxed)),
+                          std::memory_order_relaxed);
+    }
+
+    previousNumSamples = numSamples;
+
+    return static_cast<int64> (estimatedTime);
+}
@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    CallbackClock.h
+    Created: 17 Oct 2026 11:24:06pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Estimates the host time of every audio callback of a device from the
+    jittery times at which the callbacks are entered.
+
+    The device plays its samples at a steady rate, but the audio thread is
+    woken with a scheduling delay that varies from callback to callback.
+    The clock predicts each callback time from the previous one and the number
+    of samples played since, and only moves the prediction a small part of
+    the way towards the measured time. The estimate thus follows the sample
+    clock of the device instead of the wake-up jitter, so a sample offset
+    within a block maps to a stable host time.
+
+    The distance between the measured and the estimated times is the wake-up
+    jitter of the device. Its recent peak is kept to size the shared buffer.
+*/
+class CallbackClock
+{
+public:
+    CallbackClock();
+
+    //==========================================================================
+    /** [Non-realtime] [Non-thread-safe]
+        Forgets the estimate. Must not be called while the device is running.
+    */
+    void reset (double sampleRate);
+
+    /** [Realtime] [Single writer]
+        Updates the estimate with the time at which a callback was entered,
+        and returns the estimated time of the callback.
+
+        @param callbackTimeInTicks  Time::getHighResolutionTicks() on entry
+        @param numSamples           number of samples in the callback
+    */
+    int64 update (int64 callbackTimeInTicks, int numSamples);
+
+    /** [Realtime] [Thread-safe]
+        Converts a number of samples of the device to high resolution ticks.
+    */
+    int64 samplesToTicks (double numSamples) const
+    {
+        return static_cast<int64> (numSamples * ticksPerSample.load (std::memory_order_relaxed));
+    }
+
+    /** [Realtime] [Thread-safe]
+        Converts high resolution ticks to a number of samples of the device.
+    */
+    double ticksToSamples (int64 numTicks) const
+    {
+        return static_cast<double> (numTicks) / ticksPerSample.load (std::memory_order_relaxed);
+    }
+
+    /** [Realtime] [Thread-safe]
+        Returns the largest recent distance between a measured callback time
+        and its estimate, in seconds. Older peaks are released over
+        `peakJitterReleaseTime` seconds.
+    */
+    double getPeakJitterInSeconds() const { return peakJitter.load (std::memory_order_relaxed); }
+
+private:
+    const double ticksPerSecond;
+    std::atomic<double> ticksPerSample { 0.0 };
+    std::atomic<double> peakJitter { 0.0 };         // [s]
+
+    bool hasEstimate = false;
+    double estimatedTime = 0.0;     // [ticks]
+    int previousNumSamples = 0;
+
+    //==========================================================================
+    // Proportion of the prediction error that is corrected every callback
+    inline static constexpr double smoothingCoefficient = 1.0 / 32.0;
+
+    // Errors larger than this are discontinuities, such as a device restart
+    //  or a dropout, and the estimate restarts from the measured time
+    inline static constexpr double maxErrorInSeconds = 0.02 /*s*/;
+
+    // Time over which a jitter peak is released
+    inline static constexpr double peakJitterReleaseTime = 10.0 /*s*/;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CallbackClock)
+};
@@ -0,0 +1,186 @@
+/*
+  ==============================================================================
+
+    CallbackTrace.cpp
+    Created: 17 Oct 2026 1:26:05pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "CallbackTrace.h"
+
+CallbackTrace::CallbackTrace (int numDevicesToTrace, int maxNumEventsPerDevice)
+    : numDevices (numDevicesToTrace),
+      capacity (nextPowerOfTwo (jmax (1, maxNumEventsPerDevice))),
+      mask (static_cast<uint32> (capacity - 1))
+{
+    jassert (isPositiveAndBelow (numDevices, 256));
+
+    for (int i = 0; i < numDevices; ++i)
+        rings.add (std::make_unique<EventRing>());
+
+    //==========================================================================
+    // Check that atomic counters and timestamps are lock-free
+    static_assert (std::atomic<uint32>::is_always_lock_free,
+                   "std::atomic for type uint32 must be always lock free");
+}
+
+//==============================================================================
+void CallbackTrace::start()
+{
+    stop();
+
+    // Allocate only once, so that audio threads that are still finishing
+    //  a previous recording never see the rings reallocated
+    if (! ringsAllocated)
+    {
+        for (auto* ring : rings)
+            ring->events.calloc (static_cast<size_t> (capacity));
+
+        ringsAllocated = true;
+    }
+
+    for (auto* ring : rings)
+        ring->numWritten.store (0);
+
+    recording.store (true, std::memory_order_release);
+}
+
+void CallbackTrace::record (int device, int64 callbackTimeInTicks,
+                            int numSamples, double sampleRate)
+{
+    if (! recording.load (std::memory_order_acquire))
+        return;
+
+    jassert (isPositiveAndBelow (device, numDevices));
+
+    auto& ring = *rings.getUnchecked (device);
+    const auto numWritten = ring.numWritten.load (std::memory_order_relaxed);
+
+    auto& event = ring.events[numWritten & mask];
+    event.timeInNs = static_cast<int64> (Time::highResolutionTicksToSeconds (callbackTimeInTicks) * 1.0e9);
+    event.sampleRate = sampleRate;
+    event.numSamples = numSamples;
+    event.device = device;
+
+    ring.numWritten.store (numWritten + 1, std::memory_order_release);
+}
+
+//==============================================================================
+Array<CallbackTrace::Event> CallbackTrace::getEvents() const
+{
+    Array<Event> events;
+
+    if (! ringsAllocated)
+        return events;
+
+    for (auto* ring : rings)
+    {
+        const auto numWritten = ring->numWritten.load (std::memory_order_acquire);
+
+        // When the ring has wrapped around, the oldest slot may be overwritten
+        //  by a callback that is still running, so it is skipped
+        const uint32 numAvailable = numWritten < static_cast<uint32> (capacity)
+                                  ? numWritten
+                                  : static_cast<uint32> (capacity - 1);
+
+        for (uint32 i = numWritten - numAvailable; i != numWritten; ++i)
+            events.add (ring->events[i & mask]);
+    }
+
+    std::stable_sort (events.begin(), events.end(),
+                      [] (const Event& a, const Event& b)
+                      {
+                          return a.timeInNs < b.timeInNs
+                                 || (a.timeInNs == b.timeInNs && a.device < b.device);
+                      });
+
+    // The callbacks are timestamped on the clock of the player, so the
+    //  times are made relative to the first one
+    if (! events.isEmpty())
+    {
+        const auto startTime = events.getReference (0).timeInNs;
+
+        for (auto& event : events)
+            event.timeInNs -= startTime;
+    }
+
+    return events;
+}
+
+//==============================================================================
+bool CallbackTrace::saveToFile (const File& file) const
+{
+    const auto events = getEvents();
+
+    FileOutputStream out (file);
+
+    if (out.failedToOpen())
+        return false;
+
+    out.setPosition (0);
+    out.truncate();
+
+    out.write (fileMagic, 4);
+    out.writeInt (fileFormatVersion);
+    out.writeInt (numDevices);
+    out.writeInt64 (events.size());
+
+    for (const auto& event : events)
+    {
+        out.writeInt64 (event.timeInNs);
+        out.writeByte (static_cast<char> (event.device));
+        out.writeInt (event.numSamples);
+        out.writeFloat (static_cast<float> (event.sampleRate));
+    }
+
+    out.flush();
+
+    return out.getStatus().wasOk();
+}
+
+bool CallbackTrace::loadFromFile (const File& file,
+                                  Array<Event>& events,
+                                  int& numTracedDevices)
+{
+    FileInputStream in (file);
+
+    if (in.failedToOpen())
+        return false;
+
+    char magic[4] = {};
+
+    if (in.read (magic, 4) != 4 || std::memcmp (magic, fileMagic, 4) != 0)
+        return false;
+
+    if (in.readInt() != fileFormatVersion)
+        return false;
+
+    numTracedDevices = in.readInt();
+    const auto numEvents = in.readInt64();
+
+    if (! isPositiveAndBelow (numTracedDevices, 256)
+        || numEvents < 0
+        || numEvents * eventSizeInBytes > in.getNumBytesRemaining())
+        return false;
+
+    events.clearQuick();
+    events.ensureStorageAllocated (static_cast<int> (numEvents));
+
+    for (int64 i = 0; i < numEvents; ++i)
+    {
+        Event event;
+        event.timeInNs = in.readInt64();
+        event.device = static_cast<uint8> (in.readByte());
+        event.numSamples = in.readInt();
+        event.sampleRate = in.readFloat();
+
+        if (! isPositiveAndBelow (event.device, numTracedDevices) || event.numSamples < 0)
+            return false;
+
+        events.add (event);
+    }
+
+    return true;
+}
@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    CallbackTrace.h
+    Created: 17 Oct 2026 1:26:05pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Flight recorder for the audio callbacks of several devices.
+
+    Every device has its own preallocated ring of events that is only written
+    by the audio thread of that device, so recording is wait-free. When a ring
+    is full, the oldest events are overwritten, so the trace always holds
+    the most recent callbacks.
+
+    The trace can be saved to a compact binary file and loaded again, so that
+    the exact callback schedule can be replayed offline.
+*/
+class CallbackTrace
+{
+public:
+    struct Event
+    {
+        int64 timeInNs = 0;         // callback time, since the first recorded callback
+        double sampleRate = 0.0;    // sample rate the device was prepared at
+        int numSamples = 0;
+        int device = 0;             // 0 for the Main device, i + 1 for Linked device i
+    };
+
+    //==========================================================================
+    CallbackTrace (int numDevicesToTrace, int maxNumEventsPerDevice);
+
+    //==========================================================================
+    /** [Non-realtime] [Non-thread-safe]
+        Clears the trace and starts recording. The event rings are allocated
+        on the first call.
+    */
+    void start();
+
+    /** [Realtime] [Thread-safe]
+        Stops recording. The recorded events are kept.
+    */
+    void stop() { recording.store (false); }
+
+    /** [Realtime] [Thread-safe] */
+    bool isRecording() const { return recording.load(); }
+
+    /** [Realtime] [Audio thread of the device only]
+        Records a callback of a device. Does nothing if the trace isn't recording.
+
+        @param callbackTimeInTicks  time of the callback that the player
+                                    timestamps it with, so that a replay that
+                                    reports it as the host time reproduces it
+    */
+    void record (int device, int64 callbackTimeInTicks, int numSamples, double sampleRate);
+
+    //==========================================================================
+    /** [Non-realtime] [Thread-safe]
+        Returns the recorded events of all devices in time order. Times are
+        counted from the first event.
+    */
+    Array<Event> getEvents() const;
+
+    int getNumDevices() const { return numDevices; }
+
+    //==========================================================================
+    /** [Non-realtime] [Thread-safe]
+        Saves the recorded events to a binary trace file.
+    */
+    bool saveToFile (const File& file) const;
+
+    /** [Non-realtime] [Thread-safe]
+        Loads the events of a binary trace file.
+
+        @returns    false if the file can't be read or isn't a valid trace.
+    */
+    static bool loadFromFile (const File& file,
+                              Array<Event>& events,
+                              int& numTracedDevices);
+
+private:
+    struct EventRing
+    {
+        HeapBlock<Event> events;
+        std::atomic<uint32> numWritten { 0 };
+    };
+
+    const int numDevices;
+    const int capacity;             // events per device, power of two
+    const uint32 mask;
+
+    OwnedArray<EventRing> rings;
+    bool ringsAllocated = false;
+
+    std::atomic<bool> recording { false };
+
+    //==========================================================================
+    // Binary file format:
+    //  "MDPT", format version, number of devices, number of events,
+    //  then for every event: time [ns], device, block size, sample rate
+    inline static constexpr const char* fileMagic = "MDPT";
+    inline static constexpr int fileFormatVersion = 1;
+    inline static constexpr int64 eventSizeInBytes = 8 + 1 + 4 + 4;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CallbackTrace)
+};
@@ -0,0 +1,173 @@
+/*
+  ==============================================================================
+
+    ChannelRouting.cpp
+    Created: 18 Oct 2026 1:26:49am
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "ChannelRouting.h"
+
+ChannelRouting::ChannelRouting (int numSourceChannelsToUse)
+{
+    setNumSourceChannels (numSourceChannelsToUse);
+
+    for (auto& device : sourceChannels)
+        for (int outputChannel = 0; outputChannel < maxNumChannels; ++outputChannel)
+            device[outputChannel] = outputChannel < numSourceChannels ? outputChannel : none;
+}
+
+//==============================================================================
+void ChannelRouting::setNumSourceChannels (int newNumSourceChannels)
+{
+    numSourceChannels = jlimit (1, maxNumChannels, newNumSourceChannels);
+}
+
+void ChannelRouting::setSourceChannel (int device, int outputChannel, int sourceChannel)
+{
+    jassert (isPositiveAndBelow (device, maxNumDevices));
+    jassert (isPositiveAndBelow (outputChannel, maxNumChannels));
+
+    sourceChannels[device][outputChannel] = isPositiveAndBelow (sourceChannel, maxNumChannels)
+                                          ? sourceChannel : none;
+}
+
+int ChannelRouting::getSourceChannel (int device, int outputChannel) const
+{
+    if (! isPositiveAndBelow (device, maxNumDevices)
+        || ! isPositiveAndBelow (outputChannel, maxNumChannels))
+        return none;
+
+    // Channels the source doesn't have play nothing
+    const auto sourceChannel = sourceChannels[device][outputChannel];
+    return sourceChannel < numSourceChannels ? sourceChannel : none;
+}
+
+Array<int> ChannelRouting::getLinkedSourceChannels (int numLinkedDevices) const
+{
+    Array<int> linkedChannels;
+
+    for (int device = 1; device <= jmin (numLinkedDevices, maxNumDevices - 1); ++device)
+    {
+        for (int outputChannel = 0; outputChannel < maxNumChannels; ++outputChannel)
+        {
+            const auto sourceChannel = getSourceChannel (device, outputChannel);
+
+            if (sourceChannel != none)
+                linkedChannels.addIfNotAlreadyThere (sourceChannel);
+        }
+    }
+
+    linkedChannels.sort();
+    return linkedChannels;
+}
+
+//==============================================================================
+String ChannelRouting::toString (int device, int numOutputChannels) const
+{
+    StringArray channels;
+
+    for (int outputChannel = 0; outputChannel < jmin (numOutputChannels, maxNumChannels); ++outputChannel)
+        channels.add (String (getSourceChannel (device, outputChannel) + 1));
+
+    return channels.joinIntoString (":");
+}
+
+int ChannelRouting::setFromString (int device, const String& routingText)
+{
+    auto channels = StringArray::fromTokens (routingText, ":", "");
+    channels.trim();
+
+    const auto numOutputChannels = jmin (channels.size(), maxNumChannels);
+
+    for (int outputChannel = 0; outputChannel < maxNumChannels; ++outputChannel)
+        setSourceChannel (device, outputChannel,
+                          outputChannel < numOutputChannels ? channels[outputChannel].getIntValue() - 1
+                                                            : none);
+
+    return numOutputChannels;
+}
+
+//==============================================================================
+void ChannelRouting::OutputMap::prepare (const ChannelRouting& routing, int device,
+                                         const Array<int>& renderedSourceChannels,
+                                         int maxBlockSize)
+{
+    numRenderedChannels = jmin (renderedSourceChannels.size(), maxNumChannels);
+
+    renderedChannelOfOutput.fill (none);
+    firstOutputOfRenderedChannel.fill (none);
+
+    for (int outputChannel = 0; outputChannel < maxNumChannels; ++outputChannel)
+    {
+        const auto sourceChannel = routing.getSourceChannel (device, outputChannel);
+
+        if (sourceChannel == none)
+            continue;
+
+        const auto renderedChannel = renderedSourceChannels.indexOf (sourceChannel);
+
+        if (! isPositiveAndBelow (renderedChannel, numRenderedChannels))
+            continue;
+
+        renderedChannelOfOutput[static_cast<size_t> (outputChannel)] = renderedChannel;
+
+        auto& firstOutput = firstOutputOfRenderedChannel[static_cast<size_t> (renderedChannel)];
+
+        if (firstOutput == none)
+            firstOutput = outputChannel;
+    }
+
+    scratch.setSize (jmax (1, numRenderedChannels), jmax (1, maxBlockSize));
+    scratch.clear();
+}
+
+AudioBuffer<float>& ChannelRouting::OutputMap::mapOutputs (const AudioSourceChannelInfo& outputInfo)
+{
+    jassert (outputInfo.numSamples <= scratch.getNumSamples());
+
+    auto* outputs = outputInfo.buffer;
+
+    for (int renderedChannel = 0; renderedChannel < numRenderedChannels; ++renderedChannel)
+    {
+        const auto outputChannel = firstOutputOfRenderedChannel[static_cast<size_t> (renderedChannel)];
+
+        renderedChannels[static_cast<size_t> (renderedChannel)]
+            = isPositiveAndBelow (outputChannel, outputs->getNumChannels())
+                ? outputs->getWritePointer (outputChannel, outputInfo.startSample)
+                : scratch.getWritePointer (renderedChannel);
+    }
+
+    // Refers to the channel pointers without allocating
+    renderView.setDataToReferTo (renderedChannels.data(), numRenderedChannels, outputInfo.numSamples);
+    return renderView;
+}
+
+void ChannelRouting::OutputMap::fillOutputs (const AudioSourceChannelInfo& outputInfo)
+{
+    auto* outputs = outputInfo.buffer;
+    const auto numOutputChannels = jmin (outputs->getNumChannels(), maxNumChannels);
+
+    for (int outputChannel = 0; outputChannel < numOutputChannels; ++outputChannel)
+    {
+        const auto renderedChannel = renderedChannelOfOutput[static_cast<size_t> (outputChannel)];
+
+        if (renderedChannel == none)
+        {
+            outputs->clear (outputChannel, outputInfo.startSample, outputInfo.numSamples);
+            continue;
+        }
+
+        auto* output = outputs->getWritePointer (outputChannel, outputInfo.startSample);
+        const auto* rendered = renderedChannels[static_cast<size_t> (renderedChannel)];
+
+        if (rendered != output)
+            FloatVectorOperations::copy (output, rendered, outputInfo.numSamples);
+    }
+
+    // Outputs beyond the routing play nothing
+    for (int outputChannel = numOutputChannels; outputChannel < outputs->getNumChannels(); ++outputChannel)
+        outputs->clear (outputChannel, outputInfo.startSample, outputInfo.numSamples);
+}
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    ChannelRouting.h
+    Created: 18 Oct 2026 1:26:49am
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AudioFifo.h"
+
+/**
+    Maps the channels of a multichannel source to the output channels of
+    the Main device and the Linked devices.
+
+    Every output channel plays one source channel or nothing, and a source
+    channel can play on any number of outputs, on any device. Device 0 is
+    the Main device, device i + 1 is the Linked device i. By default output
+    channel n plays source channel n on every device.
+*/
+class ChannelRouting
+{
+public:
+    explicit ChannelRouting (int numSourceChannels = 2);
+
+    //==========================================================================
+    inline static constexpr int maxNumChannels = 16;
+    inline static constexpr int maxNumDevices = 1 + AudioFifo::maxNumReaders;
+    inline static constexpr int none = -1;
+
+    //==========================================================================
+    void setNumSourceChannels (int newNumSourceChannels);
+    int getNumSourceChannels() const { return numSourceChannels; }
+
+    /** Sets the source channel that an output channel of a device plays,
+        or `none`.
+    */
+    void setSourceChannel (int device, int outputChannel, int sourceChannel);
+
+    /** Returns the source channel that an output channel of a device plays,
+        or `none`.
+    */
+    int getSourceChannel (int device, int outputChannel) const;
+
+    /** Returns the source channels that play on any Linked device, in
+        ascending order. Only these channels go through the shared buffer.
+    */
+    Array<int> getLinkedSourceChannels (int numLinkedDevices) const;
+
+    //==========================================================================
+    /** Returns the routing of a device as the 1-based source channel of each
+        output channel, separated by colons, with 0 for none, such as "1:2:0".
+    */
+    String toString (int device, int numOutputChannels) const;
+
+    /** Sets the routing of a device from a string made by toString(). The
+        remaining output channels play nothing.
+
+        @returns    the number of output channels in the string.
+    */
+    int setFromString (int device, const String& routingText);
+
+    //==========================================================================
+    /**
+        Plays a set of rendered channels on the output channels of one device.
+
+        A rendered channel is rendered straight into the first output channel
+        that plays it, by pointing the rendered buffer at the output buffer,
+        so most channels are never copied. Only a channel that plays on
+        several outputs is copied, and only outputs that play nothing are
+        cleared. Rendered channels that play on no output of the device go
+        to scratch memory.
+    */
+    class OutputMap
+    {
+    public:
+        OutputMap() = default;
+
+        /** [Non-realtime] [Non-thread-safe]
+            Sets up the map and allocates the scratch memory.
+
+            @param routing                  routing to follow
+            @param device                   device of the outputs
+            @param renderedSourceChannels   source channel of each rendered channel
+            @param maxBlockSize             largest block that will be mapped
+        */
+        void prepare (const ChannelRouting& routing, int device,
+                      const Array<int>& renderedSourceChannels, int maxBlockSize);
+
+        /** [Realtime] [Non-thread-safe]
+            Returns a buffer to render into, whose channels are the rendered
+            channels in the order given to prepare(). Its channels point at
+            the output channels of `outputInfo` where possible.
+        */
+        AudioBuffer<float>& mapOutputs (const AudioSourceChannelInfo& outputInfo);
+
+        /** [Realtime] [Non-thread-safe]
+            Completes the outputs after rendering into the buffer returned by
+            mapOutputs(): copies the channels that play on further outputs,
+            and clears the outputs that play nothing.
+        */
+        void fillOutputs (const AudioSourceChannelInfo& outputInfo);
+
+        /** Returns the number of rendered channels. */
+        int getNumRenderedChannels() const { return numRenderedChannels; }
+
+    private:
+        int numRenderedChannels = 0;
+
+        // Rendered channel that each output plays, or `none`
+        std::array<int, maxNumChannels> renderedChannelOfOutput {};
+
+        // First output that each rendered channel plays on, or `none`
+        std::array<int, maxNumChannels> firstOutputOfRenderedChannel {};
+
+        std::array<float*, maxNumChannels> renderedChannels {};
+        AudioBuffer<float> scratch;
+        AudioBuffer<float> renderView;
+
+        JUCE_DECLARE_NON_COPYABLE (OutputMap)
+    };
+
+private:
+    int numSourceChannels = 2;
+    int sourceChannels[maxNumDevices][maxNumChannels];
+};
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    CrossoverFilter.cpp
+    Created: 18 Oct 2026 12:41:17am
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "CrossoverFilter.h"
+
+CrossoverFilter::CrossoverFilter (Type filterType)
+    : type (filterType)
+{
+    prepare (2, sampleRate);
+}
+
+//==============================================================================
+void CrossoverFilter::prepare (int numChannels, double newSampleRate)
+{
+    jassert (newSampleRate > 0.0);
+
+    sampleRate = newSampleRate;
+    numChannelGroups = (jmax (1, numChannels) + numLanes - 1) / numLanes;
+    state.resize (static_cast<size_t> (numChannelGroups * numSections));
+
+    // Recalculate the coefficients for the new sample rate on the next block
+    cutoffFrequency = 0.0f;
+    reset();
+}
+
+void CrossoverFilter::reset()
+{
+    for (auto& section : state)
+        section.s1 = section.s2 = Lanes::expand (0.0f);
+}
+
+void CrossoverFilter::updateCoefficients (float newCutoffFrequency)
+{
+    cutoffFrequency = newCutoffFrequency;
+
+    // Butterworth section, Q = 1 / sqrt (2)
+    const auto frequency = jlimit (1.0, 0.49 * sampleRate, static_cast<double> (newCutoffFrequency));
+    const auto w0 = MathConstants<double>::twoPi * frequency / sampleRate;
+    const auto cosW0 = std::cos (w0);
+    const auto alpha = std::sin (w0) / MathConstants<double>::sqrt2;
+    const auto a0 = 1.0 + alpha;
+
+    const auto b0Value = type == Type::lowPass ? 0.5 * (1.0 - cosW0) : 0.5 * (1.0 + cosW0);
+    const auto b1Value = type == Type::lowPass ? 1.0 - cosW0 : -(1.0 + cosW0);
+
+    b0 = Lanes::expand (static_cast<float> (b0Value / a0));
+    b1 = Lanes::expand (static_cast<float> (b1Value / a0));
+    b2 = b0;
+    a1 = Lanes::expand (static_cast<float> (-2.0 * cosW0 / a0));
+    a2 = Lanes::expand (static_cast<float> ((1.0 - alpha) / a0));
+}
+
+//==============================================================================
+void CrossoverFilter::process (const AudioSourceChannelInfo& info, float cutoffFrequencyInHz)
+{
+    // The state decays towards zero in silence
+    ScopedNoDenormals noDenormals;
+
+    if (cutoffFrequencyInHz != cutoffFrequency)
+        updateCoefficients (cutoffFrequencyInHz);
+
+    auto* buffer = info.buffer;
+    const auto numChannels = jmin (buffer->getNumChannels(), numChannelGroups * numLanes);
+
+    // Samples of one group of channels, moved in and out of the lanes
+    alignas (sizeof (Lanes)) float frame[numLanes] = {};
+
+    for (int group = 0; group * numLanes < numChannels; ++group)
+    {
+        const auto firstChannel = group * numLanes;
+        const auto numGroupChannels = jmin (numLanes, numChannels - firstChannel);
+
+        float* channels[numLanes] = {};
+
+        for (int lane = 0; lane < numGroupChannels; ++lane)
+            channels[lane] = buffer->getWritePointer (firstChannel + lane, info.startSample);
+
+        auto* sections = state.data() + group * numSections;
+
+        for (int i = 0; i < info.numSamples; ++i)
+        {
+            for (int lane = 0; lane < numGroupChannels; ++lane)
+                frame[lane] = channels[lane][i];
+
+            auto x = Lanes::fromRawArray (frame);
+
+            for (int section = 0; section < numSections; ++section)
+            {
+                auto& s = sections[section];
+                const auto y = b0 * x + s.s1;
+
+                s.s1 = b1 * x - a1 * y + s.s2;
+                s.s2 = b2 * x - a2 * y;
+                x = y;
+            }
+
+            x.copyToRawArray (frame);
+
+            for (int lane = 0; lane < numGroupChannels; ++lane)
+                channels[lane][i] = frame[lane];
+        }
+    }
+}
@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    CrossoverFilter.h
+    Created: 18 Oct 2026 12:41:17am
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    One side of a 4th order Linkwitz-Riley crossover.
+
+    The filter is a cascade of two identical 2nd order Butterworth sections.
+    The low-pass and high-pass sides have the same phase response at every
+    frequency, so they sum back to a flat response even when they run on
+    different devices at different sample rates.
+
+    The channels are processed together, each one in a lane of a SIMD
+    register, so a stereo or 4-channel block costs about as much as a mono
+    one.
+*/
+class CrossoverFilter
+{
+public:
+    enum class Type
+    {
+        lowPass,
+        highPass
+    };
+
+    explicit CrossoverFilter (Type filterType);
+
+    //==========================================================================
+    /** [Non-realtime] [Non-thread-safe]
+        Allocates the filter state for a number of channels and clears it.
+    */
+    void prepare (int numChannels, double sampleRate);
+
+    /** [Realtime] [Non-thread-safe]
+        Clears the filter state.
+    */
+    void reset();
+
+    /** [Realtime] [Non-thread-safe]
+        Filters a block in place. The coefficients are recalculated first if
+        the cutoff frequency has changed.
+    */
+    void process (const AudioSourceChannelInfo& info, float cutoffFrequencyInHz);
+
+private:
+    using Lanes = dsp::SIMDRegister<float>;
+    inline static constexpr int numLanes = static_cast<int> (Lanes::SIMDNumElements);
+    inline static constexpr int numSections = 2;
+
+    const Type type;
+
+    double sampleRate = 44100.0;
+    float cutoffFrequency = 0.0f;   // [Hz], zero until the first block
+
+    // Normalised coefficients of the transposed direct form II section
+    Lanes b0, b1, b2, a1, a2;
+
+    // Two state registers per section for every group of `numLanes` channels
+    struct SectionState
+    {
+        Lanes s1, s2;
+    };
+
+    std::vector<SectionState> state;
+    int numChannelGroups = 0;
+
+    void updateCoefficients (float newCutoffFrequency);
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CrossoverFilter)
+};
@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    CrossoverPanel.cpp
+    Created: 18 Oct 2026 12:58:03am
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "CrossoverPanel.h"
+
+//==============================================================================
+CrossoverPanel::CrossoverPanel (MultiDevicePlayer& mdp)
+{
+    // Crossover panel label:
+    addAndMakeVisible (crossoverPanelLabel);
+    crossoverPanelLabel.setFont (headingFont);
+    const auto headingColour
+    = getLookAndFeel().findColour (AppLookAndFeel::headingColourId);
+    crossoverPanelLabel.setColour (Label::textColourId, headingColour);
+    crossoverPanelLabel.setText ("Crossover", dontSendNotification);
+
+    // Enable button:
+    addAndMakeVisible (crossoverButton);
+    crossoverButton.setButtonText ("Low Frequencies to Secondary Outputs");
+    crossoverButton.setToggleState (mdp.isCrossoverEnabled(), dontSendNotification);
+    crossoverButton.onClick = [this, &mdp]
+    {
+        mdp.setCrossoverEnabled (crossoverButton.getToggleState());
+    };
+
+    // Crossover frequency slider:
+    addAndMakeVisible (frequencySlider);
+    addAndMakeVisible (frequencySliderLabel);
+    frequencySlider.setTextBoxStyle (Slider::TextBoxRight, false,
+                                     buttonWidth, buttonHeight);
+    frequencySlider.setScrollWheelEnabled (false);
+    frequencySlider.setRange ({ minFrequency, maxFrequency }, 1.0);
+    frequencySlider.setSkewFactorFromMidPoint (120.0);
+    frequencySlider.setValue (mdp.getCrossoverFrequency(), dontSendNotification);
+    frequencySlider.setDoubleClickReturnValue (true, mdp.getCrossoverFrequency());
+    frequencySlider.setTextValueSuffix (" Hz");
+    frequencySliderLabel.setText ("Frequency", dontSendNotification);
+
+    frequencySlider.onValueChange = [this, &mdp]
+    {
+        mdp.setCrossoverFrequency (static_cast<float> (frequencySlider.getValue()));
+    };
+}
+
+void CrossoverPanel::resized()
+{
+    // Manage panel hight
+    const int requiredHeight = 3 * buttonHeight + 4 * padding;
+    setSize (getWidth(), requiredHeight);
+
+    auto bounds = getLocalBounds().reduced (padding);   // get usable bounds
+
+    // Section label:
+    crossoverPanelLabel.setBounds (bounds.removeFromTop (buttonHeight));
+
+    // Enable button:
+    bounds.removeFromTop (padding);     // add spacing
+    crossoverButton.setBounds (bounds.removeFromTop (buttonHeight)
+                                     .withWidth (3 * buttonWidth));
+
+    // Crossover frequency:
+    bounds.removeFromTop (padding);     // add spacing
+    setSliderBounds (frequencySlider, frequencySliderLabel,
+                     bounds.removeFromTop (buttonHeight));
+}
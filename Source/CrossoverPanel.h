@@ -0,0 +1,41 @@
+/*
+  ==============================================================================
+
+    CrossoverPanel.h
+    Created: 18 Oct 2026 12:58:03am
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "InterfacePanel.h"
+#include "MultiDevicePlayer.h"
+
+//==============================================================================
+class CrossoverPanel  : public InterfacePanel
+{
+public:
+    explicit CrossoverPanel (MultiDevicePlayer& multiDevice);
+
+    //==========================================================================
+    void resized() override;
+
+private:
+    //==========================================================================
+    // UI Components
+    Label crossoverPanelLabel;
+    ToggleButton crossoverButton;
+    Slider frequencySlider;
+    Label frequencySliderLabel;
+
+    //==========================================================================
+    // Crossover frequency range [Hz]
+    inline static constexpr double minFrequency = 40.0;
+    inline static constexpr double maxFrequency = 500.0;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CrossoverPanel)
+};
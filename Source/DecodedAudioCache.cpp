@@ -0,0 +1,167 @@
+/*
+  ==============================================================================
+
+    DecodedAudioCache.cpp
+    Created: 17 Oct 2026 4:12:09pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "DecodedAudioCache.h"
+
+DecodedAudioCache::DecodedAudioCache (AudioFormatManager& formatManager,
+                                      int64 maxSizeInBytes)
+    : formats (formatManager), maxSize (jmax (int64 { 0 }, maxSizeInBytes))
+{
+}
+
+DecodedAudioCache::~DecodedAudioCache()
+{
+    decodePool.removeAllJobs (true, 5000);
+}
+
+//==============================================================================
+void DecodedAudioCache::setMaxSizeInBytes (int64 newMaxSizeInBytes)
+{
+    const ScopedLock sl (entriesLock);
+
+    maxSize = jmax (int64 { 0 }, newMaxSizeInBytes);
+    evictToFit (0);
+}
+
+int64 DecodedAudioCache::getMaxSizeInBytes() const
+{
+    const ScopedLock sl (entriesLock);
+    return maxSize;
+}
+
+int64 DecodedAudioCache::getSizeInBytes() const
+{
+    const ScopedLock sl (entriesLock);
+    return totalSize;
+}
+
+//==============================================================================
+DecodedAudioCache::DecodedAudioPtr DecodedAudioCache::find (const File& file)
+{
+    const auto key = makeKey (file);
+    const ScopedLock sl (entriesLock);
+
+    for (auto& entry : entries)
+    {
+        if (entry.key == key)
+        {
+            entry.lastUsed = ++useCounter;
+            return entry.audio;
+        }
+    }
+
+    return nullptr;
+}
+
+void DecodedAudioCache::decodeInBackground (const File& file)
+{
+    const auto key = makeKey (file);
+
+    {
+        const ScopedLock sl (entriesLock);
+
+        if (maxSize == 0 || pendingKeys.contains (key)
+            || std::any_of (entries.begin(), entries.end(),
+                            [&key] (const Entry& e) { return e.key == key; }))
+            return;
+
+        pendingKeys.add (key);
+    }
+
+    decodePool.addJob ([this, file, key]
+    {
+        auto audio = decode (file);
+
+        const ScopedLock sl (entriesLock);
+        pendingKeys.removeString (key);
+
+        if (audio == nullptr)
+            return;
+
+        const auto size = getBufferSizeInBytes (audio->buffer);
+
+        if (size > maxSize)
+            return;
+
+        evictToFit (maxSize - size);
+
+        entries.push_back ({ key, std::move (audio), size, ++useCounter });
+        totalSize += size;
+    });
+}
+
+//==============================================================================
+void DecodedAudioCache::evictToFit (int64 sizeToFit)
+{
+    // Evict the least recently used files first
+    while (totalSize > sizeToFit && ! entries.empty())
+    {
+        const auto oldest = std::min_element (entries.begin(), entries.end(),
+                                              [] (const Entry& a, const Entry& b)
+                                              {
+                                                  return a.lastUsed < b.lastUsed;
+                                              });
+
+        totalSize -= oldest->sizeInBytes;
+        entries.erase (oldest);
+    }
+}
+
+String DecodedAudioCache::makeKey (const File& file)
+{
+    return file.getFullPathName()
+           + "|" + String (file.getSize())
+           + "|" + String (file.getLastModificationTime().toMilliseconds());
+}
+
+//==============================================================================
+DecodedAudioCache::DecodedAudioPtr DecodedAudioCache::decode (const File& file)
+{
+    std::unique_ptr<AudioFormatReader> reader (formats.createReaderFor (file));
+
+    if (reader == nullptr || reader->lengthInSamples <= 0
+        || reader->lengthInSamples > std::numeric_limits<int>::max())
+        return nullptr;
+
+    const auto numChannels = static_cast<int> (reader->numChannels);
+    const auto length = static_cast<int> (reader->lengthInSamples);
+
+    // Don't decode files that would never fit
+    if (static_cast<int64> (numChannels) * length * static_cast<int64> (sizeof (float))
+            > getMaxSizeInBytes())
+        return nullptr;
+
+    auto audio = std::make_shared<DecodedAudio>();
+    audio->buffer.setSize (numChannels, length);
+    audio->sampleRate = reader->sampleRate;
+
+    for (int start = 0; start < length; start += decodeChunkSize)
+    {
+        // Give up when the cache is being deleted
+        if (auto* job = ThreadPoolJob::getCurrentThreadPoolJob())
+            if (job->shouldExit())
+                return nullptr;
+
+        const auto numSamples = jmin (decodeChunkSize, length - start);
+
+        if (! reader->read (&audio->buffer, start, numSamples, start, true, true))
+            return nullptr;
+    }
+
+    audio->numReadySamples.store (length);
+
+    return audio;
+}
+
+int64 DecodedAudioCache::getBufferSizeInBytes (const AudioBuffer<float>& buffer)
+{
+    return static_cast<int64> (buffer.getNumChannels()) * buffer.getNumSamples()
+           * static_cast<int64> (sizeof (float));
+}
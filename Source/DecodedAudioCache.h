@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    DecodedAudioCache.h
+    Created: 17 Oct 2026 4:12:09pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    In-memory cache of fully decoded audio files.
+
+    Files are identified by their path, size and modification time, so a file
+    that changed on disk is decoded again. Files are decoded on a background
+    thread, and when the cache exceeds its size budget, the least recently
+    used files are evicted.
+
+    Decoded audio is shared, so a file that is evicted while it is playing
+    stays in memory until its player releases it.
+*/
+class DecodedAudioCache
+{
+public:
+    struct DecodedAudio
+    {
+        AudioBuffer<float> buffer;
+        double sampleRate = 0.0;
+
+        // Length of the decoded part at the start of the buffer. It's less
+        //  than the buffer length while the file is still being decoded.
+        std::atomic<int64> numReadySamples { 0 };
+
+        // Set if decoding failed part way. The audio then ends after the
+        //  ready samples, since the rest of the buffer is never filled.
+        std::atomic<bool> isIncomplete { false };
+    };
+
+    using DecodedAudioPtr = std::shared_ptr<const DecodedAudio>;
+
+    //==========================================================================
+    /** Creates a cache.
+
+        @param formatManager    formats used to decode the files. Must outlive
+                                the cache
+        @param maxSizeInBytes   size budget of the decoded audio. The cache is
+                                disabled if it's zero
+    */
+    DecodedAudioCache (AudioFormatManager& formatManager, int64 maxSizeInBytes);
+    ~DecodedAudioCache();
+
+    //==========================================================================
+    /** [Non-realtime] [Thread-safe]
+        Sets the size budget and evicts files to fit into it.
+    */
+    void setMaxSizeInBytes (int64 newMaxSizeInBytes);
+
+    /** [Non-realtime] [Thread-safe] */
+    int64 getMaxSizeInBytes() const;
+
+    /** [Non-realtime] [Thread-safe]
+        Returns the size of all cached files.
+    */
+    int64 getSizeInBytes() const;
+
+    //==========================================================================
+    /** [Non-realtime] [Thread-safe]
+        Returns the decoded audio of a file and marks it as recently used.
+
+        @returns    nullptr if the file isn't cached.
+    */
+    DecodedAudioPtr find (const File& file);
+
+    /** [Non-realtime] [Thread-safe]
+        Decodes a file on the background thread and adds it to the cache.
+        Does nothing if the file is already cached or being decoded, or if it
+        doesn't fit into the cache.
+    */
+    void decodeInBackground (const File& file);
+
+private:
+    AudioFormatManager& formats;
+
+    //==========================================================================
+    struct Entry
+    {
+        String key;
+        DecodedAudioPtr audio;
+        int64 sizeInBytes = 0;
+        uint64 lastUsed = 0;
+    };
+
+    CriticalSection entriesLock;
+    std::vector<Entry> entries;
+    StringArray pendingKeys;
+
+    int64 maxSize = 0;
+    int64 totalSize = 0;
+    uint64 useCounter = 0;
+
+    /** Must be called with entriesLock held. */
+    void evictToFit (int64 sizeToFit);
+
+    static String makeKey (const File& file);
+
+    //==========================================================================
+    // Decoding
+    ThreadPool decodePool { 1 };
+
+    /** [Decode thread only]
+        Decodes the whole file.
+
+        @returns    nullptr if the file can't be read or the job was cancelled.
+    */
+    DecodedAudioPtr decode (const File& file);
+
+    static int64 getBufferSizeInBytes (const AudioBuffer<float>& buffer);
+
+    // Number of samples decoded at a time
+    inline static constexpr int decodeChunkSize = 65536;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DecodedAudioCache)
+};
@@ -1,75 +1,186 @@
-/*
-  ==============================================================================
-
-    DelayAudioSource.cpp
-    Created: 9 Oct 2022 9:54:05pm
-    Author:  Anthony Alfimov
-
-  ==============================================================================
-*/
-
-#include "DelayAudioSource.h"
-
-DelayAudioSource::DelayAudioSource (int numChannels, int maxDelayInSamples)
-{
-    setDelayBufferSize (numChannels, maxDelayInSamples);
-}
-
-//==============================================================================
-void DelayAudioSource::setDelayBufferSize (int numChannels, int maxDelayInSamples)
-{
-    channels = numChannels;
-    maxDelay = maxDelayInSamples;
-
-    bufferResizePending = true;
-}
-
-//==============================================================================
-void DelayAudioSource::setDelay (int delayInSamples)
-{
-    delaySmoothed.setTargetValue (jmin (delayInSamples, maxDelay));
-}
-
-//==============================================================================
-void DelayAudioSource::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
-{
-    const dsp::ProcessSpec spec { sampleRate,
-                                  static_cast<uint32> (samplesPerBlockExpected),
-                                  static_cast<uint32> (channels) };
-    delayBuffer.prepare (spec);
-    delayBuffer.setMaximumDelayInSamples (maxDelay + 1);
-
-    bufferResizePending = false;
-
-    delaySmoothed.reset (sampleRate, delaySmoothingInSeconds);
-}
-
-void DelayAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
-{
-    jassert (! bufferResizePending);
-
-    const int numChannels = jmin (channels, bufferToFill.buffer->getNumChannels());
-
-    const auto inBuffer = bufferToFill.buffer->getArrayOfReadPointers();
-    auto outBuffer = bufferToFill.buffer->getArrayOfWritePointers();
-
-    const auto startSample = bufferToFill.startSample;
-    const auto endSample = startSample + bufferToFill.numSamples;
-
-    for (int i = startSample; i < endSample; ++i)
-    {
-        const auto delayValue = delaySmoothed.getNextValue();
-
-        for (int ch = 0; ch < numChannels; ++ch)
-        {
-            delayBuffer.pushSample (ch, inBuffer[ch][i]);
-            outBuffer[ch][i] = delayBuffer.popSample (ch, delayValue);
-        }
-    }
-}
-
-void DelayAudioSource::releaseResources()
-{
-    delayBuffer.reset();
-    delaySmoothed.setCurrentAndTargetValue (0.0f);
-}
+/*
+  ==============================================================================
+
+    DelayAudioSource.cpp
+    Created: 9 Oct 2022 9:54:05pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "DelayAudioSource.h"
+
+DelayAudioSource::DelayAudioSource (int numChannels, int maxDelayInSamples)
+{
+    setDelayBufferSize (numChannels, maxDelayInSamples);
+}
+
+//==============================================================================
+void DelayAudioSource::setDelayBufferSize (int numChannels, int maxDelayInSamples)
+{
+    channels = numChannels;
+    maxDelay = maxDelayInSamples;
+
+    bufferResizePending = true;
+}
+
+//==============================================================================
+void DelayAudioSource::setDelay (int delayInSamples)
+{
+    delaySmoothed.setTargetValue (jmin (delayInSamples, maxDelay));
+}
+
+//==============================================================================
+void DelayAudioSource::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    maxBlockSize = jmax (1, samplesPerBlockExpected);
+
+    // Interpolation reads up to 2 samples beyond the max delay
+    delayBuffer.setSize (channels, maxDelay + maxBlockSize + numTaps);
+    delayBuffer.clear();
+    writePosition = 0;
+
+    rampReadPositions.calloc (static_cast<size_t> (maxBlockSize));
+    rampWeights.calloc (static_cast<size_t> (numTaps * maxBlockSize));
+
+    bufferResizePending = false;
+
+    delaySmoothed.reset (sampleRate, delaySmoothingInSeconds);
+}
+
+void DelayAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    jassert (! bufferResizePending);
+
+    // Split blocks larger than the prepared size, so the input never
+    //  overwrites the delayed samples that are still to be read
+    for (int done = 0; done < bufferToFill.numSamples; done += maxBlockSize)
+    {
+        processBlock (*bufferToFill.buffer,
+                      bufferToFill.startSample + done,
+                      jmin (maxBlockSize, bufferToFill.numSamples - done));
+    }
+}
+
+void DelayAudioSource::releaseResources()
+{
+    delayBuffer.setSize (channels, 0);
+    rampReadPositions.free();
+    rampWeights.free();
+    writePosition = 0;
+
+    delaySmoothed.setCurrentAndTargetValue (0.0f);
+}
+
+//==============================================================================
+void DelayAudioSource::processBlock (AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    const int numChannels = jmin (channels, buffer.getNumChannels());
+    const int bufferSize = delayBuffer.getNumSamples();
+
+    // Write the input first, so a zero delay reads it back straight away
+    const int numBeforeWrap = jmin (numSamples, bufferSize - writePosition);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const auto* input = buffer.getReadPointer (ch, startSample);
+
+        FloatVectorOperations::copy (delayBuffer.getWritePointer (ch, writePosition),
+                                     input, numBeforeWrap);
+        FloatVectorOperations::copy (delayBuffer.getWritePointer (ch),
+                                     input + numBeforeWrap, numSamples - numBeforeWrap);
+    }
+
+    if (delaySmoothed.isSmoothing())
+        readRampingDelay (buffer, startSample, numSamples);
+    else
+        readSteadyDelay (buffer, startSample, numSamples);
+
+    writePosition = (writePosition + numSamples) % bufferSize;
+}
+
+void DelayAudioSource::readSteadyDelay (AudioBuffer<float>& buffer, int startSample,
+                                        int numSamples)
+{
+    const int numChannels = jmin (channels, buffer.getNumChannels());
+    const int bufferSize = delayBuffer.getNumSamples();
+
+    // The target delay is a whole number of samples
+    const int delay = jlimit (0, maxDelay, roundToInt (delaySmoothed.getCurrentValue()));
+
+    int readPosition = writePosition - delay;
+
+    if (readPosition < 0)
+        readPosition += bufferSize;
+
+    const int numBeforeWrap = jmin (numSamples, bufferSize - readPosition);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* output = buffer.getWritePointer (ch, startSample);
+
+        FloatVectorOperations::copy (output, delayBuffer.getReadPointer (ch, readPosition),
+                                     numBeforeWrap);
+        FloatVectorOperations::copy (output + numBeforeWrap, delayBuffer.getReadPointer (ch),
+                                     numSamples - numBeforeWrap);
+    }
+}
+
+void DelayAudioSource::readRampingDelay (AudioBuffer<float>& buffer, int startSample,
+                                         int numSamples)
+{
+    const int numChannels = jmin (channels, buffer.getNumChannels());
+    const int bufferSize = delayBuffer.getNumSamples();
+
+    //==========================================================================
+    // Compute the taps once for all channels. The taps are the samples delayed
+    //  by `base` to `base + 3`, centred around the delay where possible.
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float delay = jlimit (0.0f, static_cast<float> (maxDelay),
+                                    delaySmoothed.getNextValue());
+        const int base = jmax (0, static_cast<int> (delay) - 1);
+        const float x = delay - static_cast<float> (base);
+
+        int readPosition = writePosition + i - base;
+
+        if (readPosition < 0)
+            readPosition += bufferSize;
+        else if (readPosition >= bufferSize)
+            readPosition -= bufferSize;
+
+        rampReadPositions[i] = readPosition;
+
+        auto* weights = rampWeights + numTaps * i;
+        const float x1 = x - 1.0f, x2 = x - 2.0f, x3 = x - 3.0f;
+
+        weights[0] = -x1 * x2 * x3 * (1.0f / 6.0f);
+        weights[1] = x * x2 * x3 * 0.5f;
+        weights[2] = -x * x1 * x3 * 0.5f;
+        weights[3] = x * x1 * x2 * (1.0f / 6.0f);
+    }
+
+    //==========================================================================
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const auto* data = delayBuffer.getReadPointer (ch);
+        auto* output = buffer.getWritePointer (ch, startSample);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const int p = rampReadPositions[i];
+            const auto* weights = rampWeights + numTaps * i;
+
+            // Tap j is the sample delayed by `base + j`
+            float sum = 0.0f;
+
+            for (int j = 0; j < numTaps; ++j)
+            {
+                const int tapPosition = p >= j ? p - j : p - j + bufferSize;
+                sum += weights[j] * data[tapPosition];
+            }
+
+            output[i] = sum;
+        }
+    }
+}
@@ -1,71 +1,102 @@
-/*
-  ==============================================================================
-
-    DelayAudioSource.h
-    Created: 9 Oct 2022 9:54:05pm
-    Author:  Anthony Alfimov
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-
-class DelayAudioSource  : public AudioSource
-{
-public:
-    /** Default constructor of a DelayAudioSource object.
-
-        setDelayBufferSize() method must be called before the first
-        prepareToPlay() call. Otherwise default values for the buffer size
-        will be used.
-    */
-    DelayAudioSource() = default;
-
-    /** Creates a DelayAudioSource and sets its delay buffer size.
-    */
-    DelayAudioSource (int numChannels, int maxDelayInSamples);
-
-    //==========================================================================
-    /** [Realtime] [Non-thread-safe]
-        Sets the size of the internal delay buffer. The changes to the buffer
-        size are only applied when prepareToPlay() is called.
-
-        If the object was created using the default constructor,
-        this method must be called before the first prepareToPlay() call.
-        Otherwise default values for the buffer size will be used.
-    */
-    void setDelayBufferSize (int numChannels, int maxDelayInSamples);
-
-    /** [Realtime] [Non-thread-safe]
-        Returns true when internal delay buffer has been resized to the
-        requested size.
-     */
-    bool isDelayBufferReady() const { return ! bufferResizePending; }
-
-    //==========================================================================
-    void setDelay (int delayInSamples);
-
-    //==========================================================================
-    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
-    void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
-    void releaseResources() override;
-
-private:
-    int channels = 2;
-    int maxDelay = 512;
-
-    bool bufferResizePending = true;
-
-    //==========================================================================
-    SmoothedValue<float> delaySmoothed;
-    using InterpolationMethod = dsp::DelayLineInterpolationTypes::Lagrange3rd;
-    dsp::DelayLine <float, InterpolationMethod> delayBuffer;
-
-    //==========================================================================
-    inline static constexpr float delaySmoothingInSeconds = 0.05f;
-
-    //==========================================================================
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DelayAudioSource);
-};
+/*
+  ==============================================================================
+
+    DelayAudioSource.h
+    Created: 9 Oct 2022 9:54:05pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Delays its input by a smoothly changing number of samples.
+
+    The input is written to a circular buffer. A steady delay is a whole
+    number of samples, so the output is copied straight from the buffer.
+    Lagrange interpolation is only used while the delay ramps to a new value,
+    with the weights of every sample computed once for all channels.
+*/
+class DelayAudioSource  : public AudioSource
+{
+public:
+    /** Default constructor of a DelayAudioSource object.
+
+        setDelayBufferSize() method must be called before the first
+        prepareToPlay() call. Otherwise default values for the buffer size
+        will be used.
+    */
+    DelayAudioSource() = default;
+
+    /** Creates a DelayAudioSource and sets its delay buffer size.
+    */
+    DelayAudioSource (int numChannels, int maxDelayInSamples);
+
+    //==========================================================================
+    /** [Realtime] [Non-thread-safe]
+        Sets the size of the internal delay buffer. The changes to the buffer
+        size are only applied when prepareToPlay() is called.
+
+        If the object was created using the default constructor,
+        this method must be called before the first prepareToPlay() call.
+        Otherwise default values for the buffer size will be used.
+    */
+    void setDelayBufferSize (int numChannels, int maxDelayInSamples);
+
+    /** [Realtime] [Non-thread-safe]
+        Returns true when internal delay buffer has been resized to the
+        requested size.
+     */
+    bool isDelayBufferReady() const { return ! bufferResizePending; }
+
+    //==========================================================================
+    /** [Realtime] [Non-thread-safe]
+        Sets the target delay. The delay ramps to it over a short time.
+    */
+    void setDelay (int delayInSamples);
+
+    //==========================================================================
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
+    void releaseResources() override;
+
+private:
+    int channels = 2;
+    int maxDelay = 512;
+
+    bool bufferResizePending = true;
+
+    //==========================================================================
+    SmoothedValue<float> delaySmoothed;
+
+    // Circular buffer that holds the max delay and one block of input
+    AudioBuffer<float> delayBuffer;
+    int writePosition = 0;
+    int maxBlockSize = 0;
+
+    // Interpolation taps of every sample in a ramping block
+    HeapBlock<int> rampReadPositions;
+    HeapBlock<float> rampWeights;
+
+    //==========================================================================
+    /** Processes a block that is not larger than maxBlockSize. */
+    void processBlock (AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    /** Copies the output of a steady whole-sample delay. */
+    void readSteadyDelay (AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    /** Interpolates the output while the delay is ramping. */
+    void readRampingDelay (AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    //==========================================================================
+    inline static constexpr float delaySmoothingInSeconds = 0.05f;
+
+    // Third order Lagrange interpolation uses 4 taps
+    inline static constexpr int numTaps = 4;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DelayAudioSource);
+};
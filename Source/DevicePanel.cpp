@@ -1,83 +1,116 @@
-/*
-  ==============================================================================
-
-    DevicePanel.cpp
-    Created: 18 Sep 2022 7:28:47pm
-    Author:  Anthony Alfimov
-
-  ==============================================================================
-*/
-
-#include "DevicePanel.h"
-
-//==============================================================================
-DeviceSettingsView::DeviceSettingsView (MultiDevicePlayer& mpd,
-                                        AudioFilePlayer& syncPlayer,
-                                        double maxLatencyInMs)
-    : mainDevicePanel ("Primary Output Device", mpd.mainDeviceManager, false,
-                       [&mpd] (float newGain) { mpd.setMainGain (newGain); }),
-      linkedDevicePanel ("Secondary Output Device", mpd.linkedDeviceManager, true,
-                         [&mpd] (float newGain) { mpd.setLinkedGain (newGain); }),
-      latencyPanel (syncPlayer, maxLatencyInMs,
-                    [&mpd] (float newLatency) { mpd.setLatency (newLatency); })
-{
-    addAndMakeVisible (mainDevicePanel);
-    addAndMakeVisible (linkedDevicePanel);
-    addAndMakeVisible (latencyPanel);
-}
-
-void DeviceSettingsView::resized()
-{
-    // Manage panel hight
-    int requiredHeight = mainDevicePanel.getHeight()
-                       + linkedDevicePanel.getHeight()
-                       + latencyPanel.getHeight();
-    setSize (getWidth(), requiredHeight);
-
-    auto bounds = getLocalBounds();     // get usable bounds
-
-    mainDevicePanel.setBounds (bounds.removeFromTop (mainDevicePanel.getHeight()));
-    linkedDevicePanel.setBounds (bounds.removeFromTop (linkedDevicePanel.getHeight()));
-    latencyPanel.setBounds (bounds.removeFromTop (latencyPanel.getHeight()));
-}
-
-void DeviceSettingsView::setDeviceSelectorEnabled (bool shouldBeEnabled)
-{
-    mainDevicePanel.setDeviceSelectorEnabled (shouldBeEnabled);
-    linkedDevicePanel.setDeviceSelectorEnabled (shouldBeEnabled);
-}
-
-bool DeviceSettingsView::isDeviceSelectorEnabled() const
-{
-    return mainDevicePanel.isDeviceSelectorEnabled()
-           && linkedDevicePanel.isDeviceSelectorEnabled();
-}
-
-//==============================================================================
-DevicePanel::DevicePanel (MultiDevicePlayer& multiDevice, AudioFilePlayer& syncPlayer,
-                          double maxLatencyInMs)
-    : deviceSettings (multiDevice, syncPlayer, maxLatencyInMs)
-{
-    addAndMakeVisible (devicePanelViewport);
-    devicePanelViewport.setViewedComponent (&deviceSettings, false);
-    devicePanelViewport.setScrollBarsShown (true, false);
-}
-
-void DevicePanel::resized()
-{
-    deviceSettings.resized();
-
-    const auto bounds = getLocalBounds();
-    devicePanelViewport.setBounds (bounds);
-    deviceSettings.setSize (bounds.getWidth(), deviceSettings.getHeight());
-}
-
-void DevicePanel::setDeviceSelectorEnabled (bool shouldBeEnabled)
-{
-    deviceSettings.setDeviceSelectorEnabled (shouldBeEnabled);
-}
-
-bool DevicePanel::isDeviceSelectorEnabled() const
-{
-    return deviceSettings.isDeviceSelectorEnabled();
-}
+/*
+  ==============================================================================
+
+    DevicePanel.cpp
+    Created: 18 Sep 2022 7:28:47pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "DevicePanel.h"
+
+//==============================================================================
+DeviceSettingsView::DeviceSettingsView (MultiDevicePlayer& mpd,
+                                        AudioFilePlayer& syncPlayer,
+                                        LatencyCalibrator& calibrator,
+                                        TelemetryRecorder& telemetry,
+                                        double maxLatencyInMs)
+    : mainDevicePanel ("Primary Output Device", mpd.mainDeviceManager, false,
+                       [&mpd] (float newGain) { mpd.setMainGain (newGain); }),
+      routingPanel (mpd),
+      crossoverPanel (mpd),
+      latencyPanel (syncPlayer, calibrator, maxLatencyInMs, mpd.getNumLinkedDevices(),
+                    [&mpd] (int linkedDeviceIndex, float newLatency)
+                    {
+                        mpd.setLatency (linkedDeviceIndex, newLatency);
+                    }),
+      telemetryPanel (telemetry)
+{
+    addAndMakeVisible (mainDevicePanel);
+
+    const int numLinkedDevices = mpd.getNumLinkedDevices();
+
+    for (int i = 0; i < numLinkedDevices; ++i)
+    {
+        String outputName = "Secondary Output Device";
+
+        if (numLinkedDevices > 1)
+            outputName << " " << (i + 1);
+
+        auto* panel = linkedDevicePanels.add (std::make_unique<OutputConfigurationPanel>
+            (outputName, mpd.getLinkedDeviceManager (i), true,
+             [&mpd, i] (float newGain) { mpd.setLinkedGain (i, newGain); }));
+        addAndMakeVisible (panel);
+    }
+
+    addAndMakeVisible (routingPanel);
+    addAndMakeVisible (crossoverPanel);
+    addAndMakeVisible (latencyPanel);
+    addAndMakeVisible (telemetryPanel);
+}
+
+void DeviceSettingsView::resized()
+{
+    // Manage panel hight
+    int requiredHeight = mainDevicePanel.getHeight() + routingPanel.getHeight()
+                       + crossoverPanel.getHeight()
+                       + latencyPanel.getHeight() + telemetryPanel.getHeight();
+
+    for (auto* panel : linkedDevicePanels)
+        requiredHeight += panel->getHeight();
+
+    setSize (getWidth(), requiredHeight);
+
+    auto bounds = getLocalBounds();     // get usable bounds
+
+    mainDevicePanel.setBounds (bounds.removeFromTop (mainDevicePanel.getHeight()));
+
+    for (auto* panel : linkedDevicePanels)
+        panel->setBounds (bounds.removeFromTop (panel->getHeight()));
+
+    routingPanel.setBounds (bounds.removeFromTop (routingPanel.getHeight()));
+    crossoverPanel.setBounds (bounds.removeFromTop (crossoverPanel.getHeight()));
+    latencyPanel.setBounds (bounds.removeFromTop (latencyPanel.getHeight()));
+    telemetryPanel.setBounds (bounds.removeFromTop (telemetryPanel.getHeight()));
+}
+
+void DeviceSettingsView::setMainDeviceSelectorEnabled (bool shouldBeEnabled)
+{
+    mainDevicePanel.setDeviceSelectorEnabled (shouldBeEnabled);
+}
+
+bool DeviceSettingsView::isMainDeviceSelectorEnabled() const
+{
+    return mainDevicePanel.isDeviceSelectorEnabled();
+}
+
+//==============================================================================
+DevicePanel::DevicePanel (MultiDevicePlayer& multiDevice, AudioFilePlayer& syncPlayer,
+                          LatencyCalibrator& calibrator, TelemetryRecorder& telemetry,
+                          double maxLatencyInMs)
+    : deviceSettings (multiDevice, syncPlayer, calibrator, telemetry, maxLatencyInMs)
+{
+    addAndMakeVisible (devicePanelViewport);
+    devicePanelViewport.setViewedComponent (&deviceSettings, false);
+    devicePanelViewport.setScrollBarsShown (true, false);
+}
+
+void DevicePanel::resized()
+{
+    deviceSettings.resized();
+
+    const auto bounds = getLocalBounds();
+    devicePanelViewport.setBounds (bounds);
+    deviceSettings.setSize (bounds.getWidth(), deviceSettings.getHeight());
+}
+
+void DevicePanel::setMainDeviceSelectorEnabled (bool shouldBeEnabled)
+{
+    deviceSettings.setMainDeviceSelectorEnabled (shouldBeEnabled);
+}
+
+bool DevicePanel::isMainDeviceSelectorEnabled() const
+{
+    return deviceSettings.isMainDeviceSelectorEnabled();
+}
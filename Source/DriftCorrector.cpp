@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    DriftCorrector.cpp
+    Created: 17 Oct 2026 10:14:32am
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "DriftCorrector.h"
+
+void DriftCorrector::prepare (double nominalResamplingRatio,
+                              double inputSampleRate,
+                              double callbackPeriodInSeconds)
+{
+    jassert (nominalResamplingRatio > 0.0);
+    jassert (inputSampleRate > 0.0);
+    jassert (callbackPeriodInSeconds > 0.0);
+
+    nominalRatio = nominalResamplingRatio;
+    inputRate = inputSampleRate;
+    callbackPeriod = callbackPeriodInSeconds;
+
+    smoothingCoefficient = 1.0 - std::exp (-callbackPeriod / fillSmoothingTime);
+}
+
+void DriftCorrector::restart (double fillLevel)
+{
+    smoothedFillLevel = fillLevel;
+    lastTargetFillLevel = fillLevel;
+}
+
+//==============================================================================
+void DriftCorrector::addMeasurement (double fillLevel)
+{
+    // The fill level seen by the pop side can be a sawtooth, so smooth it first
+    smoothedFillLevel += smoothingCoefficient * (fillLevel - smoothedFillLevel);
+}
+
+double DriftCorrector::getNextRatio (double targetFillLevel)
+{
+    // Proportional term: the correction that would drain the fill level error
+    //  in `correctionTime` seconds
+    const double proportionalTerm = (smoothedFillLevel - targetFillLevel)
+                                  / (inputRate * correctionTime);
+
+    // Integral term converges to the relative clock drift of the devices
+    integralTerm += proportionalTerm * callbackPeriod / (4.0 * correctionTime);
+    integralTerm = jlimit (-maxCorrection, maxCorrection, integralTerm);
+
+    // Feed-forward term: the correction that moves the fill level along with
+    //  a target that changes gradually, so the integral term only sees the drift
+    const double feedForwardTerm = (lastTargetFillLevel - targetFillLevel)
+                                 / (inputRate * callbackPeriod);
+    lastTargetFillLevel = targetFillLevel;
+
+    const double correction = jlimit (-maxCorrection, maxCorrection,
+                                      proportionalTerm + integralTerm + feedForwardTerm);
+
+    return nominalRatio * (1.0 + correction);
+}
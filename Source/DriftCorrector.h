@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    DriftCorrector.h
+    Created: 17 Oct 2026 10:14:32am
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Closed-loop controller for the resampling ratio of the Linked device.
+
+    The clocks of two independent audio devices are never exactly the same,
+    so a fixed resampling ratio slowly drains or fills the shared buffer.
+    DriftCorrector observes the shared buffer fill level on every pop and
+    adjusts the resampling ratio with a PI controller, so that the fill level
+    settles at its target indefinitely. The integral term of the controller
+    converges to the relative clock drift between the devices.
+
+    The fill level can be fractional, so it can include the samples held by
+    the resampler and the time since the Main device last pushed.
+*/
+class DriftCorrector
+{
+public:
+    DriftCorrector() = default;
+
+    //==========================================================================
+    /** [Non-realtime] [Non-thread-safe]
+        Prepares the controller for a new device configuration.
+
+        @param nominalResamplingRatio   ratio derived from nominal sample rates
+        @param inputSampleRate          sample rate of the audio in the shared buffer
+        @param callbackPeriodInSeconds  time between consecutive calls
+                                        to getNextRatio()
+    */
+    void prepare (double nominalResamplingRatio,
+                  double inputSampleRate,
+                  double callbackPeriodInSeconds);
+
+    /** [Realtime] [Non-thread-safe]
+        Resets the fill level estimate to the given value. Call this when
+        the playback restarts after the shared buffer has been refilled.
+        The drift estimate is kept, since it is a property of the devices.
+    */
+    void restart (double fillLevel);
+
+    /** [Realtime] [Non-thread-safe]
+        Adds a fill level measurement to the smoothed estimate. Call this
+        once before every pop, even if the ratio isn't corrected.
+
+        @param fillLevel    samples between the Main device and the output
+                            of the Linked device, in input samples
+    */
+    void addMeasurement (double fillLevel);
+
+    /** [Realtime] [Non-thread-safe]
+        Returns the resampling ratio corrected towards the target fill level.
+        Call this after addMeasurement().
+
+        The target may move gradually between calls, and the fill level
+        follows it, as long as the change per second together with the drift
+        stays within `maxCorrection` of the input sample rate.
+
+        @param targetFillLevel  fill level the controller should maintain
+    */
+    double getNextRatio (double targetFillLevel);
+
+    /** [Realtime] [Non-thread-safe]
+        Returns the smoothed fill level, in input samples.
+    */
+    double getSmoothedFillLevel() const { return smoothedFillLevel; }
+
+    //==========================================================================
+    /** [Realtime] [Non-thread-safe]
+        Returns the estimated relative clock drift between the devices in ppm.
+        Positive values mean that the shared buffer is filled faster than
+        nominal sample rates suggest.
+    */
+    double getDriftInPpm() const { return integralTerm * 1.0e6; }
+
+    /** [Realtime] [Non-thread-safe]
+        Returns the largest resampling ratio the controller can request.
+        Use it to preallocate the resampling buffers.
+    */
+    double getMaxRatio() const { return nominalRatio * (1.0 + maxCorrection); }
+
+    /** [Realtime] [Non-thread-safe]
+        Returns the nominal resampling ratio, without any drift correction.
+    */
+    double getNominalRatio() const { return nominalRatio; }
+
+    //==========================================================================
+    // Largest correction that can be applied to the nominal ratio
+    inline static constexpr double maxCorrection = 1000.0e-6;
+
+private:
+    double nominalRatio = 1.0;
+    double inputRate = 44100.0;
+    double callbackPeriod = 0.01;
+
+    //==========================================================================
+    // Controller state
+    double smoothedFillLevel = 0.0;
+    double lastTargetFillLevel = 0.0;
+    double integralTerm = 0.0;
+    double smoothingCoefficient = 0.0;
+
+    //==========================================================================
+    // Time constants of the control loop [s]. The integral gain is chosen
+    //  so that the loop is critically damped.
+    inline static constexpr double fillSmoothingTime = 1.0;
+    inline static constexpr double correctionTime = 10.0;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DriftCorrector)
+};
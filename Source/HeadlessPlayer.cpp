@@ -0,0 +1,581 @@
+/*
+  ==============================================================================
+
+    HeadlessPlayer.cpp
+    Created: 17 Oct 2026 10:08:52pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "HeadlessPlayer.h"
+
+namespace
+{
+    /** Returns the value of a comma-separated option for a given device. */
+    String getDeviceValue (const ArgumentList& args, StringRef option, int deviceIndex)
+    {
+        auto values = StringArray::fromTokens (args.getValueForOption (option), ",", "\"");
+        values.trim();
+        values.removeEmptyStrings();
+
+        if (values.isEmpty())
+            return {};
+
+        return values[jmin (deviceIndex, values.size() - 1)].unquoted();
+    }
+
+    HeadlessPlayer::DeviceSettings getDeviceSettings (const ArgumentList& args,
+                                                      const String& prefix,
+                                                      int deviceIndex,
+                                                      float defaultGain)
+    {
+        HeadlessPlayer::DeviceSettings settings;
+
+        settings.typeName = getDeviceValue (args, prefix + "-type", deviceIndex);
+        settings.deviceName = getDeviceValue (args, prefix + "-device", deviceIndex);
+        settings.sampleRate = getDeviceValue (args, prefix + "-rate", deviceIndex).getDoubleValue();
+        settings.bufferSize = getDeviceValue (args, prefix + "-buffer", deviceIndex).getIntValue();
+        settings.latencyInMs = getDeviceValue (args, prefix + "-latency", deviceIndex).getFloatValue();
+        settings.route = getDeviceValue (args, prefix + "-route", deviceIndex);
+
+        const auto gain = getDeviceValue (args, prefix + "-gain", deviceIndex);
+        settings.gain = gain.isNotEmpty() ? jlimit (0.0f, 1.0f, gain.getFloatValue())
+                                          : defaultGain;
+
+        return settings;
+    }
+
+    /** Reads the files listed in a playlist, one per line. Relative paths are
+        relative to the playlist, and lines starting with # are comments,
+        as in M3U playlists.
+    */
+    Array<File> readPlaylist (const File& playlistFile)
+    {
+        StringArray lines;
+        playlistFile.readLines (lines);
+
+        Array<File> files;
+
+        for (auto line : lines)
+        {
+            line = line.trim();
+
+            if (line.isNotEmpty() && ! line.startsWithChar ('#'))
+                files.add (playlistFile.getParentDirectory().getChildFile (line.unquoted()));
+        }
+
+        return files;
+    }
+
+    /** Parses a time of day as HH:MM[:SS[.mmm]]. Returns the next time it
+        occurs, today or tomorrow, or a null Time if it can't be parsed.
+    */
+    Time parseTimeOfDay (const String& text)
+    {
+        const auto parts = StringArray::fromTokens (text, ":", "");
+
+        if (parts.size() < 2 || parts.size() > 3)
+            return {};
+
+        const auto seconds = parts[2].getDoubleValue();
+        const auto now = Time::getCurrentTime();
+
+        Time time (now.getYear(), now.getMonth(), now.getDayOfMonth(),
+                   parts[0].getIntValue(), parts[1].getIntValue(),
+                   static_cast<int> (seconds), roundToInt (1000.0 * (seconds - std::floor (seconds))));
+
+        if (time < now)
+            time += RelativeTime::days (1.0);
+
+        return time;
+    }
+}
+
+//==============================================================================
+HeadlessPlayer::Settings HeadlessPlayer::getSettings (const ArgumentList& args)
+{
+    Settings settings;
+
+    if (args.containsOption ("--file"))
+        settings.files.add (File::getCurrentWorkingDirectory()
+                                .getChildFile (args.getValueForOption ("--file")));
+
+    if (args.containsOption ("--playlist"))
+        settings.files.addArray (readPlaylist (File::getCurrentWorkingDirectory()
+                                                   .getChildFile (args.getValueForOption ("--playlist"))));
+
+    settings.preload = args.containsOption ("--preload");
+    settings.loop = args.containsOption ("--loop");
+
+    if (args.containsOption ("--start-at"))
+        settings.startTime = parseTimeOfDay (args.getValueForOption ("--start-at"));
+
+    if (args.containsOption ("--start-in"))
+        settings.startDelayInSeconds = jmax (0.0, args.getValueForOption ("--start-in").getDoubleValue());
+
+    if (args.containsOption ("--crossfade"))
+        settings.crossfadeInSeconds = jmax (0.0, args.getValueForOption ("--crossfade").getDoubleValue());
+
+    if (args.containsOption ("--status-interval"))
+        settings.statusIntervalInSeconds
+            = jmax (0.1, args.getValueForOption ("--status-interval").getDoubleValue());
+
+    if (args.containsOption ("--log-telemetry"))
+        settings.telemetryFile = File::getCurrentWorkingDirectory()
+                                     .getChildFile (args.getValueForOption ("--log-telemetry"));
+
+    if (args.containsOption ("--crossover"))
+        settings.crossoverFrequencyInHz = jmax (0.0f, args.getValueForOption ("--crossover").getFloatValue());
+
+    if (args.containsOption ("--render-ahead"))
+        settings.renderAheadInMs = jmax (0.0, args.getValueForOption ("--render-ahead").getDoubleValue());
+
+    if (args.containsOption ("--adaptive-buffer"))
+    {
+        const auto rate = args.getValueForOption ("--adaptive-buffer");
+        settings.maxUnderrunRate = rate.isNotEmpty() ? jmax (0.001, rate.getDoubleValue()) : 1.0;
+    }
+
+    settings.mainDevice = getDeviceSettings (args, "--main", 0, defaultGain);
+
+    int numLinkedDevices = 1;
+
+    if (args.containsOption ("--linked-devices"))
+        numLinkedDevices = jlimit (1, MultiDevicePlayer::maxNumLinkedDevices,
+                                   args.getValueForOption ("--linked-devices").getIntValue());
+
+    for (int i = 0; i < numLinkedDevices; ++i)
+        settings.linkedDevices.add (getDeviceSettings (args, "--linked", i, defaultGain));
+
+    return settings;
+}
+
+String HeadlessPlayer::getHelpText()
+{
+    return R"(Usage: "Mutli-Device Player" --headless --file=<file> [options]
+       "Mutli-Device Player" --headless --playlist=<file> [options]
+
+Playback:
+  --file=<file>             audio file to play
+  --playlist=<file>         text or M3U file listing the files to play in order,
+                            one per line, without gaps between them
+  --crossfade=<s>           crossfade between the files of a playlist (default 0)
+  --start-at=<HH:MM[:SS]>   start at a time of day, on every device at once
+  --start-in=<s>            start a given time after the devices are open
+  --preload                 decode the whole first file into memory first
+  --loop                    play the file or the playlist in a loop instead of
+                            quitting at the end
+  --status-interval=<s>     time between status lines (default 1)
+  --log-telemetry=<file>    log the telemetry to a CSV file
+  --list-devices            list the available output devices and quit
+
+Main device:
+  --main-type=<type>        device type, such as ALSA or CoreAudio
+  --main-device=<name>      output device name (default device if omitted)
+  --main-rate=<Hz>          sample rate
+  --main-buffer=<n>         buffer size
+  --main-gain=<0..1>        playback gain (default 0.25)
+  --main-route=<ch:ch:...>  source channel of each output channel, 1-based,
+                            0 for silence (default 1:2)
+  --render-ahead=<ms>       render on a separate thread this far ahead of the
+                            device, trading latency for robustness (default 0)
+
+Linked devices:
+  --linked-devices=<n>      number of Linked devices (default 1)
+  --linked-type=<type,...>
+  --linked-device=<name,...>
+  --linked-rate=<Hz,...>
+  --linked-buffer=<n,...>
+  --linked-gain=<0..1,...>
+  --linked-latency=<ms,...> latency relative to the Main device (default 0)
+  --linked-route=<ch:ch:...,...>
+  --crossover=<Hz>          play the frequencies below this on the Linked
+                            devices and the ones above on the Main device
+  --adaptive-buffer[=<n>]   size the shared buffer from the measured callback
+                            jitter, allowing n underruns per minute (default 1)
+
+Linked device options take a comma-separated value per device.
+The last value is used for the remaining devices.
+The file plays as many source channels as the highest routed channel.
+)";
+}
+
+String HeadlessPlayer::getDeviceList()
+{
+    AudioDeviceManager manager;
+    String list;
+
+    for (auto* type : manager.getAvailableDeviceTypes())
+    {
+        type->scanForDevices();
+        list << type->getTypeName() << ":\n";
+
+        for (const auto& name : type->getDeviceNames (false))
+            list << "  " << name << "\n";
+    }
+
+    return list;
+}
+
+//==============================================================================
+HeadlessPlayer::HeadlessPlayer (const Settings& settingsToUse)
+    : settings (settingsToUse),
+      audioOutput (maxLatencyInMs, jmax (1, settingsToUse.linkedDevices.size()))
+{
+    formatManager.registerBasicFormats();
+}
+
+HeadlessPlayer::~HeadlessPlayer()
+{
+    stopTimer();
+    telemetry.stop();
+    audioOutput.shutdownAudio();
+}
+
+String HeadlessPlayer::start()
+{
+    if (settings.files.isEmpty())
+        return "No file to play. Use --file=<file> or --playlist=<file>.";
+
+    for (const auto& file : settings.files)
+        if (! file.existsAsFile())
+            return "Can't find " + file.getFullPathName();
+
+    const auto& firstFile = settings.files.getReference (0);
+
+    //==========================================================================
+    // Open the devices
+    audioOutput.setRenderAheadTime (settings.renderAheadInMs);
+    audioOutput.setChannelRouting (getChannelRouting());
+    audioOutput.initialiseAudio (this, 2);
+
+    auto error = setUpDevice (audioOutput.mainDeviceManager, settings.mainDevice);
+
+    if (error.isNotEmpty())
+        return "Main device: " + error;
+
+    audioOutput.setMainGain (settings.mainDevice.gain);
+
+    if (settings.crossoverFrequencyInHz > 0.0f)
+    {
+        audioOutput.setCrossoverFrequency (settings.crossoverFrequencyInHz);
+        audioOutput.setCrossoverEnabled (true);
+    }
+
+    if (settings.maxUnderrunRate > 0.0)
+    {
+        audioOutput.setMaxUnderrunRate (settings.maxUnderrunRate);
+        audioOutput.setAdaptiveBufferSizingEnabled (true);
+    }
+
+    for (int i = 0; i < audioOutput.getNumLinkedDevices(); ++i)
+    {
+        const auto& deviceSettings = settings.linkedDevices.getReference (i);
+        error = setUpDevice (audioOutput.getLinkedDeviceManager (i), deviceSettings);
+
+        if (error.isNotEmpty())
+            return "Linked device " + String (i + 1) + ": " + error;
+
+        audioOutput.setLinkedGain (i, deviceSettings.gain);
+        audioOutput.setLatency (i, jlimit (static_cast<float> (-maxLatencyInMs),
+                                           static_cast<float> (maxLatencyInMs),
+                                           deviceSettings.latencyInMs));
+    }
+
+    std::cout << "Main: " << describeDevice (audioOutput.mainDeviceManager) << std::endl;
+
+    for (int i = 0; i < audioOutput.getNumLinkedDevices(); ++i)
+        std::cout << "Linked " << (i + 1) << ": "
+                  << describeDevice (audioOutput.getLinkedDeviceManager (i)) << std::endl;
+
+    //==========================================================================
+    // Load the first file
+    if (settings.preload)
+    {
+        if (! filePlayer.preloadFile (firstFile, formatManager))
+            return "Can't read " + firstFile.getFullPathName();
+    }
+    else
+    {
+        // Uncompressed files are memory-mapped, others are streamed
+        AudioFormatReader* reader = MappedReaderPrefetcher::createMappedReader (formatManager,
+                                                                                firstFile);
+
+        if (reader == nullptr)
+            reader = formatManager.createReaderFor (firstFile);
+
+        if (reader == nullptr)
+            return "Can't read " + firstFile.getFullPathName();
+
+        filePlayer.setAudioFormatReader (reader);
+    }
+
+    // A playlist loops as a whole, by queueing its first file again
+    filePlayer.setLooping (settings.loop && settings.files.size() == 1);
+    filePlayer.setCrossfadeTime (settings.crossfadeInSeconds);
+
+    filePlayer.onQueuedFileStarted = [this]
+    {
+        const auto index = (nextFileIndex + settings.files.size() - 1) % settings.files.size();
+        std::cout << "Playing " << settings.files.getReference (index).getFileName() << std::endl;
+
+        queueNextFile();
+    };
+
+    queueNextFile();
+    filePlayer.onTransportStopped = [this]
+    {
+        if (onPlaybackFinished != nullptr)
+            onPlaybackFinished();
+    };
+
+    //==========================================================================
+    // Start playback, or wait until the start of a preloaded file is decoded
+    if (settings.telemetryFile != File() && ! telemetry.startLogging (settings.telemetryFile))
+        return "Can't write " + settings.telemetryFile.getFullPathName();
+
+    telemetry.start();
+
+    std::cout << "Playing " << firstFile.getFileName() << std::endl;
+
+    isWaitingForPreload = ! filePlayer.isReadyToPlay();
+
+    if (! isWaitingForPreload)
+        startPlayback();
+
+    lastStatusTime = 0.001 * Time::getMillisecondCounterHiRes();
+    startTimerHz (10);
+
+    return {};
+}
+
+void HeadlessPlayer::startPlayback()
+{
+    auto startTime = settings.startTime;
+
+    if (settings.startDelayInSeconds >= 0.0)
+        startTime = Time::getCurrentTime() + RelativeTime::seconds (settings.startDelayInSeconds);
+
+    if (startTime == Time())
+    {
+        filePlayer.playPause();
+        return;
+    }
+
+    // A start is only heard on a Linked device once it plays from the shared
+    //  buffer, and can't be sooner than the output latency
+    if (! audioOutput.areLinkedDevicesStreaming())
+        std::cout << "Warning: not every Linked device is playing yet" << std::endl;
+
+    const auto minDelay = RelativeTime::seconds (audioOutput.getOutputLatencyInSeconds());
+
+    if (startTime < Time::getCurrentTime() + minDelay)
+        std::cout << "Warning: the start time is within the output latency of "
+                  << roundToInt (minDelay.inMilliseconds()) << " ms" << std::endl;
+
+    std::cout << "Starting at " << startTime.toString (false, true, true, true) << std::endl;
+
+    isWaitingForScheduledStart = filePlayer.playAt (startTime);
+}
+
+void HeadlessPlayer::queueNextFile()
+{
+    if (settings.files.size() < 2)
+        return;
+
+    if (nextFileIndex >= settings.files.size())
+    {
+        if (! settings.loop)
+            return;
+
+        nextFileIndex = 0;
+    }
+
+    filePlayer.queueFile (settings.files.getReference (nextFileIndex++), formatManager);
+}
+
+//==============================================================================
+void HeadlessPlayer::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    filePlayer.prepareToPlay (samplesPerBlockExpected, sampleRate);
+}
+
+void HeadlessPlayer::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    ScopedNoDenormals noDenormals;
+
+    // A scheduled start is placed against the time the block leaves the devices
+    filePlayer.setNextBlockOutputTime (audioOutput.getMainBlockOutputTime());
+
+    const StageProfiler::ScopedTimer decodeTimer (audioOutput.getMainProfiler(),
+                                                  StageProfiler::decode);
+
+    filePlayer.getNextAudioBlock (bufferToFill);
+}
+
+void HeadlessPlayer::releaseResources()
+{
+    filePlayer.releaseResources();
+}
+
+//==============================================================================
+String HeadlessPlayer::setUpDevice (AudioDeviceManager& manager,
+                                    const DeviceSettings& deviceSettings)
+{
+    if (deviceSettings.typeName.isNotEmpty()
+        && deviceSettings.typeName != manager.getCurrentAudioDeviceType())
+    {
+        manager.setCurrentAudioDeviceType (deviceSettings.typeName, true);
+
+        if (manager.getCurrentAudioDeviceType() != deviceSettings.typeName)
+            return "Unknown device type " + deviceSettings.typeName;
+    }
+
+    auto setup = manager.getAudioDeviceSetup();
+
+    if (deviceSettings.deviceName.isNotEmpty())
+        setup.outputDeviceName = deviceSettings.deviceName;
+
+    if (deviceSettings.sampleRate > 0.0)
+        setup.sampleRate = deviceSettings.sampleRate;
+
+    if (deviceSettings.bufferSize > 0)
+        setup.bufferSize = deviceSettings.bufferSize;
+
+    // A routed device opens one output channel per entry of its route
+    const auto numRoutedChannels = StringArray::fromTokens (deviceSettings.route, ":", "").size();
+
+    if (numRoutedChannels > 0)
+    {
+        setup.useDefaultOutputChannels = false;
+        setup.outputChannels.clear();
+        setup.outputChannels.setRange (0, jmin (numRoutedChannels, ChannelRouting::maxNumChannels), true);
+    }
+    else
+    {
+        setup.useDefaultOutputChannels = true;
+    }
+
+    const auto error = manager.setAudioDeviceSetup (setup, true);
+
+    if (error.isNotEmpty())
+        return error;
+
+    if (manager.getCurrentAudioDevice() == nullptr)
+        return "No device open";
+
+    return {};
+}
+
+ChannelRouting HeadlessPlayer::getChannelRouting() const
+{
+    // Every channel is kept while the routes are read
+    ChannelRouting routing (ChannelRouting::maxNumChannels);
+    int numSourceChannels = 0;
+
+    for (int device = 0; device <= settings.linkedDevices.size(); ++device)
+    {
+        const auto& route = device == 0 ? settings.mainDevice.route
+                                        : settings.linkedDevices.getReference (device - 1).route;
+
+        if (route.isEmpty())
+        {
+            // Default outputs play the first two channels
+            routing.setFromString (device, "1:2");
+            numSourceChannels = jmax (numSourceChannels, 2);
+            continue;
+        }
+
+        const auto numOutputChannels = routing.setFromString (device, route);
+
+        for (int outputChannel = 0; outputChannel < numOutputChannels; ++outputChannel)
+            numSourceChannels = jmax (numSourceChannels,
+                                      routing.getSourceChannel (device, outputChannel) + 1);
+    }
+
+    routing.setNumSourceChannels (numSourceChannels);
+    return routing;
+}
+
+String HeadlessPlayer::describeDevice (AudioDeviceManager& manager)
+{
+    auto* device = manager.getCurrentAudioDevice();
+
+    if (device == nullptr)
+        return "closed";
+
+    String description;
+
+    description << device->getName() << " (" << device->getTypeName() << "), "
+                << device->getCurrentSampleRate() << " Hz, "
+                << device->getCurrentBufferSizeSamples() << " samples, "
+                << device->getActiveOutputChannels().countNumberOfSetBits() << " outputs";
+
+    return description;
+}
+
+//==============================================================================
+void HeadlessPlayer::timerCallback()
+{
+    if (isWaitingForPreload && filePlayer.isReadyToPlay())
+    {
+        isWaitingForPreload = false;
+        startPlayback();
+    }
+
+    if (isWaitingForScheduledStart && ! filePlayer.isStartScheduled())
+    {
+        isWaitingForScheduledStart = false;
+
+        if (const auto lateness = filePlayer.getLastStartLateness(); lateness > 0.0)
+            std::cout << "Started " << roundToInt (1000.0 * lateness) << " ms late" << std::endl;
+        else
+            std::cout << "Started on time" << std::endl;
+    }
+
+    const double time = 0.001 * Time::getMillisecondCounterHiRes();
+
+    if (time - lastStatusTime >= settings.statusIntervalInSeconds)
+    {
+        lastStatusTime = time;
+        printStatus();
+    }
+}
+
+void HeadlessPlayer::printStatus()
+{
+    String status;
+    status << String (filePlayer.getCurrentPosition(), 1) << " s";
+
+    if (filePlayer.hasPreloadFailed())
+        status << ", decoding failed";
+    else if (filePlayer.getPreloadProgress() < 1.0)
+        status << ", decoded " << roundToInt (100.0 * filePlayer.getPreloadProgress()) << "%";
+
+    const auto mainStatistics = audioOutput.getMainStatistics();
+
+    status << " | Main: load " << roundToInt (100.0 * mainStatistics.load) << "%"
+           << ", overflows " << mainStatistics.numOverflows
+           << ", xruns " << mainStatistics.numXRuns;
+
+    if (audioOutput.getRenderAheadTime() > 0.0)
+        status << ", render-ahead underruns " << audioOutput.getRenderAheadUnderruns();
+
+    status << ", depth " << audioOutput.getSharedBufferDepth();
+
+    for (int i = 0; i < audioOutput.getNumLinkedDevices(); ++i)
+    {
+        const auto statistics = audioOutput.getLinkedStatistics (i);
+        const int bufferSize = jmax (1, audioOutput.getSharedBufferSize());
+
+        status << " | Linked " << (i + 1) << ": load " << roundToInt (100.0 * statistics.load) << "%"
+               << ", fill " << roundToInt (100.0 * statistics.occupancy / bufferSize) << "%"
+               << ", underruns " << statistics.numUnderruns
+               << ", xruns " << statistics.numXRuns
+               << ", drift " << String (audioOutput.getEstimatedDriftInPpm (i), 1) << " ppm"
+               << ", alignment " << String (audioOutput.getAlignmentErrorInSamples (i), 2) << " samples";
+    }
+
+    std::cout << status << std::endl;
+}
@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    HeadlessPlayer.h
+    Created: 17 Oct 2026 10:08:52pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AudioFilePlayer.h"
+#include "MultiDevicePlayer.h"
+#include "TelemetryRecorder.h"
+
+/**
+    Plays a file on the Main and Linked devices without any user interface,
+    configured from the command line, and prints the playback status to
+    the standard output.
+
+    Used by the app in --headless mode, so that the player can run on
+    machines without a display, with no Component tree and no repaints
+    on the message thread.
+*/
+class HeadlessPlayer  : public AudioSource,
+                        private Timer
+{
+public:
+    /** Settings of one output device. Empty or zero values keep the defaults
+        of the device.
+    */
+    struct DeviceSettings
+    {
+        String typeName;
+        String deviceName;
+        double sampleRate = 0.0;
+        int bufferSize = 0;
+        float gain = defaultGain;
+        float latencyInMs = 0.0f;   // Linked devices only
+
+        // 1-based source channel of each output channel, such as "1:2:0",
+        //  empty for the default outputs playing channels 1 and 2
+        String route;
+    };
+
+    struct Settings
+    {
+        // Played in order, each one spliced to the end of the previous one
+        Array<File> files;
+        bool preload = false;       // first file only
+        bool loop = false;
+        double crossfadeInSeconds = 0.0;
+
+        // Scheduled start, at a wall clock time or after a delay from when
+        //  the devices are open. Playback starts straight away if neither is set.
+        Time startTime;
+        double startDelayInSeconds = -1.0;
+
+        DeviceSettings mainDevice;
+        Array<DeviceSettings> linkedDevices;
+
+        // Renders the file this far ahead of the Main device, zero renders
+        //  it in the Main device callback
+        double renderAheadInMs = 0.0;
+
+        // Sends the low frequencies to the Linked devices if positive
+        float crossoverFrequencyInHz = 0.0f;
+
+        // Adapts the shared buffer depth to the jitter of the devices, keeping
+        //  the underruns per minute below this if positive
+        double maxUnderrunRate = 0.0;
+
+        double statusIntervalInSeconds = 1.0;
+        File telemetryFile;
+    };
+
+    /** Reads the settings from the command line options listed by getHelpText(). */
+    static Settings getSettings (const ArgumentList& args);
+
+    /** Lists the command line options of the headless mode. */
+    static String getHelpText();
+
+    /** Lists the output devices of every available device type. */
+    static String getDeviceList();
+
+    //==========================================================================
+    explicit HeadlessPlayer (const Settings& settingsToUse);
+    ~HeadlessPlayer() override;
+
+    /** Opens the devices, loads the file and starts playback.
+
+        @returns    an error message, or an empty string on success.
+    */
+    String start();
+
+    /** Called on the message thread when the last file has played to the end. */
+    std::function<void()> onPlaybackFinished;
+
+    //==========================================================================
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
+    void releaseResources() override;
+
+private:
+    const Settings settings;
+
+    //==========================================================================
+    // Audio Processing
+    AudioFormatManager formatManager;
+    AudioFilePlayer filePlayer;
+    MultiDevicePlayer audioOutput;
+    TelemetryRecorder telemetry { audioOutput };
+
+    bool isWaitingForPreload = false;
+    bool isWaitingForScheduledStart = false;
+
+    /** Starts playback now or at the scheduled time */
+    void startPlayback();
+
+    // Index of the file after the one that plays, queued in the background
+    int nextFileIndex = 1;
+    void queueNextFile();
+
+    /** Applies the device settings to a device manager.
+
+        @returns    an error message, or an empty string on success.
+    */
+    static String setUpDevice (AudioDeviceManager& manager, const DeviceSettings& deviceSettings);
+
+    /** Makes the channel routing of the devices from their routes. */
+    ChannelRouting getChannelRouting() const;
+
+    static String describeDevice (AudioDeviceManager& manager);
+
+    //==========================================================================
+    /** Starts a preloaded file once it can play, and prints the status */
+    void timerCallback() override;
+
+    void printStatus();
+    double lastStatusTime = 0.0;    // [s]
+
+    //==========================================================================
+    // Audio parameters, same as the app
+    inline static constexpr double maxLatencyInMs = 250.0 /*ms*/;
+    inline static constexpr float defaultGain = 0.25f;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HeadlessPlayer)
+};
@@ -0,0 +1,548 @@
+/*
+  ==============================================================================
+
+    LatencyCalibrator.cpp
+    Created: 17 Oct 2026 6:34:51pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "LatencyCalibrator.h"
+
+LatencyCalibrator::LatencyCalibrator (MultiDevicePlayer& mdp, double maxLatencyInMs)
+    : Thread ("Latency calibration"),
+      player (mdp),
+      maxLatency (static_cast<float> (maxLatencyInMs))
+{
+}
+
+LatencyCalibrator::~LatencyCalibrator()
+{
+    cancel();
+    cancelPendingUpdate();
+
+    inputDeviceManager.removeAudioCallback (this);
+    inputDeviceManager.closeAudioDevice();
+}
+
+//==============================================================================
+void LatencyCalibrator::initialiseInput()
+{
+    // An empty setup only sets the channels the input needs, and opens
+    //  no device
+    const XmlElement noDevice ("DEVICESETUP");
+    inputDeviceManager.initialise (numInputChannels, 0, &noDevice, false);
+}
+
+void LatencyCalibrator::openInput()
+{
+    // A device picked in the input selector is already open. Otherwise the
+    //  last device chosen is opened again, or the default input
+    if (inputDeviceManager.getCurrentAudioDevice() == nullptr)
+    {
+        const auto lastSetup = inputDeviceManager.createStateXml();
+        const bool hasChosenDevice = lastSetup != nullptr
+                                  && lastSetup->getStringAttribute ("audioInputDeviceName").isNotEmpty();
+
+        inputDeviceManager.initialise (numInputChannels, 0,
+                                       hasChosenDevice ? lastSetup.get() : nullptr, true);
+    }
+
+    inputDeviceManager.addAudioCallback (this);
+}
+
+void LatencyCalibrator::closeInput()
+{
+    inputDeviceManager.removeAudioCallback (this);
+    inputDeviceManager.closeAudioDevice();
+}
+
+//==============================================================================
+bool LatencyCalibrator::start()
+{
+    if (isThreadRunning() || closePending.load())
+        return false;
+
+    {
+        const ScopedLock sl (resultLock);
+        results.clear();
+        errorMessage.clear();
+    }
+
+    progress.store (0.0);
+    state.store (State::measuring);
+
+    openInput();
+    startThread();
+
+    return true;
+}
+
+bool LatencyCalibrator::serviceInput()
+{
+    handleUpdateNowIfNeeded();
+    return ! isThreadRunning() && ! closePending.load();
+}
+
+void LatencyCalibrator::handleAsyncUpdate()
+{
+    closeInput();
+    closePending.store (false);
+}
+
+void LatencyCalibrator::cancel()
+{
+    stopThread (2000);
+
+    const auto currentState = state.load();
+
+    if (currentState == State::measuring || currentState == State::analysing)
+        state.store (State::idle);
+}
+
+LatencyCalibrator::Result LatencyCalibrator::getResult (int linkedDeviceIndex) const
+{
+    const ScopedLock sl (resultLock);
+    return results[linkedDeviceIndex];
+}
+
+String LatencyCalibrator::getErrorMessage() const
+{
+    const ScopedLock sl (resultLock);
+    return errorMessage;
+}
+
+//==============================================================================
+void LatencyCalibrator::prepareToPlay (int /*samplesPerBlockExpected*/, double sampleRate)
+{
+    renderSweep (sweep, sampleRate);
+    slotLength = roundToInt (slotLengthInSeconds * sampleRate);
+    sweepOffset = roundToInt (sweepOffsetInSeconds * sampleRate);
+
+    outputSampleRate.store (sampleRate);
+}
+
+void LatencyCalibrator::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    bufferToFill.clearActiveBufferRegion();
+
+    if (! isPlaying.load() || slotLength <= 0)
+        return;
+
+    const int64 start = signalPosition.load();
+    const int64 end = start + bufferToFill.numSamples;
+    const int64 numSlots = 1 + player.getNumLinkedDevices();
+
+    // Copy the parts of the sweeps that fall into the block
+    for (int64 slot = start / slotLength; slot <= (end - 1) / slotLength && slot < numSlots; ++slot)
+    {
+        const int64 sweepStart = slot * slotLength + sweepOffset;
+        const int64 from = jmax (start, sweepStart);
+        const int64 to = jmin (end, sweepStart + sweep.getNumSamples());
+
+        if (from >= to)
+            continue;
+
+        for (int ch = 0; ch < bufferToFill.buffer->getNumChannels(); ++ch)
+        {
+            bufferToFill.buffer->copyFrom (ch, bufferToFill.startSample + static_cast<int> (from - start),
+                                           sweep, 0, static_cast<int> (from - sweepStart),
+                                           static_cast<int> (to - from));
+        }
+    }
+
+    signalPosition.store (end);
+}
+
+void LatencyCalibrator::releaseResources()
+{
+    outputSampleRate.store (0.0);
+}
+
+//==============================================================================
+void LatencyCalibrator::audioDeviceIOCallbackWithContext (const float* const* inputChannelData,
+                                                          int numInputChannels,
+                                                          float* const* outputChannelData,
+                                                          int numOutputChannels,
+                                                          int numSamples,
+                                                          const AudioIODeviceCallbackContext&)
+{
+    for (int ch = 0; ch < numOutputChannels; ++ch)
+        if (outputChannelData[ch] != nullptr)
+            FloatVectorOperations::clear (outputChannelData[ch], numSamples);
+
+    if (! isCapturing.load())
+        return;
+
+    const int position = capturePosition.load();
+    const int numToCapture = jmin (numSamples, capture.getNumSamples() - position);
+
+    if (numToCapture <= 0)
+        return;
+
+    // Mix all input channels down to mono
+    auto* destination = capture.getWritePointer (0, position);
+    int numMixedChannels = 0;
+
+    for (int ch = 0; ch < numInputChannels; ++ch)
+    {
+        if (inputChannelData[ch] == nullptr)
+            continue;
+
+        FloatVectorOperations::add (destination, inputChannelData[ch], numToCapture);
+        ++numMixedChannels;
+    }
+
+    if (numMixedChannels > 1)
+        FloatVectorOperations::multiply (destination, 1.0f / numMixedChannels, numToCapture);
+
+    capturePosition.store (position + numToCapture);
+}
+
+void LatencyCalibrator::audioDeviceAboutToStart (AudioIODevice* device)
+{
+    inputSampleRate.store (device->getCurrentSampleRate());
+}
+
+void LatencyCalibrator::audioDeviceStopped()
+{
+    inputSampleRate.store (0.0);
+}
+
+//==============================================================================
+void LatencyCalibrator::run()
+{
+    calibrate();
+
+    // The input is only needed for the measurement, and keeping it open
+    //  would hold the device and run its callbacks for nothing. The input
+    //  selector and start() use the device manager on the message thread,
+    //  so it's closed there
+    closePending.store (true);
+    triggerAsyncUpdate();
+}
+
+void LatencyCalibrator::calibrate()
+{
+    const int numSlots = 1 + player.getNumLinkedDevices();
+    const double captureSampleRate = inputSampleRate.load();
+
+    if (captureSampleRate <= 0.0)
+    {
+        fail ("No input device is running");
+        return;
+    }
+
+    const auto measureError = measure (numSlots, captureSampleRate);
+
+    if (threadShouldExit())
+        return;
+
+    if (measureError.isNotEmpty())
+    {
+        fail (measureError);
+        return;
+    }
+
+    state.store (State::analysing);
+
+    const auto analyseError = analyse (numSlots, captureSampleRate);
+
+    if (analyseError.isNotEmpty())
+    {
+        fail (analyseError);
+        return;
+    }
+
+    state.store (State::finished);
+}
+
+String LatencyCalibrator::measure (int numSlots, double captureSampleRate)
+{
+    const double sampleRate = outputSampleRate.load();
+
+    if (sampleRate <= 0.0)
+        return "The Main device is not running";
+
+    const int64 signalLength = numSlots * static_cast<int64> (slotLength);
+    const int captureLength = static_cast<int> (std::ceil ((numSlots * slotLengthInSeconds
+                                                            + captureTailInSeconds)
+                                                           * captureSampleRate));
+
+    // The capture buffer is only used by the input callback while capturing
+    capture.setSize (1, captureLength);
+    capture.clear();
+
+    //==========================================================================
+    // Start with only the Main device audible
+    const float mainGain = player.getMainGain();
+    Array<float> linkedGains;
+
+    for (int i = 0; i < numSlots - 1; ++i)
+        linkedGains.add (player.getLinkedGain (i));
+
+    int audibleDevice = 0;
+    setAudibleDevice (audibleDevice, mainGain, linkedGains);
+
+    capturePosition.store (0);
+    isCapturing.store (true);
+
+    signalPosition.store (0);
+    isPlaying.store (true);
+
+    //==========================================================================
+    // Unmute the devices in turn, following the test signal position
+    String error;
+
+    int64 lastSignalPosition = -1;
+    int lastCapturePosition = -1;
+    auto lastSignalTime = Time::getMillisecondCounter();
+    auto lastCaptureTime = lastSignalTime;
+
+    while (! threadShouldExit())
+    {
+        const auto position = signalPosition.load();
+        const auto captured = capturePosition.load();
+        const auto now = Time::getMillisecondCounter();
+
+        if (outputSampleRate.load() != sampleRate || inputSampleRate.load() != captureSampleRate)
+        {
+            error = "A device was restarted during the calibration";
+            break;
+        }
+
+        if (position != lastSignalPosition)
+        {
+            lastSignalPosition = position;
+            lastSignalTime = now;
+        }
+        else if (position < signalLength && now - lastSignalTime > stallTimeoutInMs)
+        {
+            error = "The Main device stopped playing";
+            break;
+        }
+
+        if (captured != lastCapturePosition)
+        {
+            lastCapturePosition = captured;
+            lastCaptureTime = now;
+        }
+        else if (captured < captureLength && now - lastCaptureTime > stallTimeoutInMs)
+        {
+            error = "The input device stopped capturing";
+            break;
+        }
+
+        const int slot = static_cast<int> (position / slotLength);
+
+        if (slot != audibleDevice && slot < numSlots)
+        {
+            audibleDevice = slot;
+            setAudibleDevice (audibleDevice, mainGain, linkedGains);
+        }
+
+        progress.store (static_cast<double> (captured) / captureLength);
+
+        if (captured >= captureLength && position >= signalLength)
+            break;
+
+        wait (10);
+    }
+
+    isPlaying.store (false);
+    isCapturing.store (false);
+
+    //==========================================================================
+    // Restore the gains
+    player.setMainGain (mainGain);
+
+    for (int i = 0; i < linkedGains.size(); ++i)
+        player.setLinkedGain (i, linkedGains[i]);
+
+    return error;
+}
+
+String LatencyCalibrator::analyse (int numSlots, double captureSampleRate)
+{
+    const double slotLengthInCaptureSamples = slotLength / outputSampleRate.load()
+                                            * captureSampleRate;
+
+    AudioBuffer<float> reference;
+    renderSweep (reference, captureSampleRate);
+
+    const int numCaptured = capturePosition.load();
+    const int referenceLength = reference.getNumSamples();
+    const int numLags = numCaptured - referenceLength + 1;
+
+    if (numLags <= 0)
+        return "The input capture is too short";
+
+    //==========================================================================
+    // Cross-correlate the capture with the sweep. The transform is long
+    //  enough for the correlation not to wrap around.
+    int order = 1;
+
+    while ((1 << order) < numCaptured + referenceLength)
+        ++order;
+
+    const int fftSize = 1 << order;
+    const dsp::FFT fft (order);
+
+    HeapBlock<float> correlation (2 * fftSize, true);
+    HeapBlock<float> referenceSpectrum (2 * fftSize, true);
+
+    FloatVectorOperations::copy (correlation, capture.getReadPointer (0), numCaptured);
+    FloatVectorOperations::copy (referenceSpectrum, reference.getReadPointer (0), referenceLength);
+
+    fft.performRealOnlyForwardTransform (correlation);
+    fft.performRealOnlyForwardTransform (referenceSpectrum);
+
+    auto* captureBins = reinterpret_cast<std::complex<float>*> (correlation.get());
+    const auto* referenceBins = reinterpret_cast<const std::complex<float>*> (referenceSpectrum.get());
+
+    for (int i = 0; i < fftSize; ++i)
+        captureBins[i] *= std::conj (referenceBins[i]);
+
+    fft.performRealOnlyInverseTransform (correlation);
+
+    // Speakers can invert the polarity, so the peaks are found in the magnitude
+    FloatVectorOperations::abs (correlation, correlation, numLags);
+
+    //==========================================================================
+    // Finds the largest peak within a range of lags with sub-sample precision
+    auto findPeak = [&] (double rangeStart, double rangeEnd, float& peakToRmsRatio)
+    {
+        const int from = jlimit (0, numLags, roundToInt (rangeStart));
+        const int to = jlimit (0, numLags, roundToInt (rangeEnd));
+
+        peakToRmsRatio = 0.0f;
+
+        if (to - from < 3)
+            return 0.0;
+
+        int peak = from;
+        double sumOfSquares = 0.0;
+
+        for (int i = from; i < to; ++i)
+        {
+            sumOfSquares += static_cast<double> (correlation[i]) * correlation[i];
+
+            if (correlation[i] > correlation[peak])
+                peak = i;
+        }
+
+        const double rms = std::sqrt (sumOfSquares / (to - from));
+        peakToRmsRatio = rms > 0.0 ? static_cast<float> (correlation[peak] / rms) : 0.0f;
+
+        if (peak == from || peak == to - 1)
+            return static_cast<double> (peak);
+
+        // Parabolic interpolation around the peak
+        const double before = correlation[peak - 1];
+        const double at = correlation[peak];
+        const double after = correlation[peak + 1];
+        const double curvature = before - 2.0 * at + after;
+
+        return peak + (curvature < 0.0 ? 0.5 * (before - after) / curvature : 0.0);
+    };
+
+    //==========================================================================
+    // The Main device sweep arrives within the first slot. The sweep of every
+    //  Linked device is searched for within half a slot of where it would
+    //  arrive with a perfect latency compensation.
+    float mainPeakToRmsRatio = 0.0f;
+    const double mainArrival = findPeak (0.0, slotLengthInCaptureSamples, mainPeakToRmsRatio);
+
+    if (mainPeakToRmsRatio < minPeakToRmsRatio)
+        return "The Main device sweep wasn't detected. Check the input device and the volume";
+
+    Array<Result> newResults;
+    bool anyDetected = false;
+
+    for (int i = 0; i < numSlots - 1; ++i)
+    {
+        Result result;
+
+        const double expectedArrival = mainArrival + (i + 1) * slotLengthInCaptureSamples;
+        const double arrival = findPeak (expectedArrival - 0.5 * slotLengthInCaptureSamples,
+                                         expectedArrival + 0.5 * slotLengthInCaptureSamples,
+                                         result.peakToRmsRatio);
+
+        if (result.peakToRmsRatio >= minPeakToRmsRatio)
+        {
+            result.isValid = true;
+            result.measuredOffsetInMs = static_cast<float> ((arrival - expectedArrival)
+                                                            / captureSampleRate * 1000.0);
+
+            // A late Linked device needs the Main device to be delayed more
+            result.newLatencyInMs = jlimit (-maxLatency, maxLatency,
+                                            player.getLatency (i) + result.measuredOffsetInMs);
+            player.setLatency (i, result.newLatencyInMs);
+
+            anyDetected = true;
+        }
+
+        newResults.add (result);
+    }
+
+    {
+        const ScopedLock sl (resultLock);
+        results = newResults;
+    }
+
+    if (! anyDetected)
+        return "No Linked device sweep was detected. Check the input device and the volume";
+
+    return {};
+}
+
+//==============================================================================
+void LatencyCalibrator::setAudibleDevice (int deviceIndex, float mainGain,
+                                          const Array<float>& linkedGains)
+{
+    player.setMainGain (deviceIndex == 0 ? mainGain : 0.0f);
+
+    for (int i = 0; i < linkedGains.size(); ++i)
+        player.setLinkedGain (i, deviceIndex == i + 1 ? linkedGains[i] : 0.0f);
+}
+
+void LatencyCalibrator::fail (const String& message)
+{
+    {
+        const ScopedLock sl (resultLock);
+        errorMessage = message;
+    }
+
+    state.store (State::failed);
+}
+
+void LatencyCalibrator::renderSweep (AudioBuffer<float>& buffer, double sampleRate)
+{
+    const int length = roundToInt (sweepLengthInSeconds * sampleRate);
+    const int fadeLength = roundToInt (0.005 * sampleRate);
+
+    buffer.setSize (1, length);
+
+    // Exponential sweep, whose correlation peak is sharp at all frequencies
+    const double rate = std::log (sweepEndFrequency / sweepStartFrequency);
+    const double phaseScale = MathConstants<double>::twoPi * sweepStartFrequency
+                            * sweepLengthInSeconds / rate;
+
+    auto* data = buffer.getWritePointer (0);
+
+    for (int i = 0; i < length; ++i)
+    {
+        const double t = i / sampleRate;
+        const double phase = phaseScale * (std::exp (t / sweepLengthInSeconds * rate) - 1.0);
+
+        // Short raised cosine fades avoid clicks at the edges
+        double gain = 1.0;
+        const int distanceToEdge = jmin (i, length - 1 - i);
+
+        if (distanceToEdge < fadeLength)
+            gain = 0.5 - 0.5 * std::cos (MathConstants<double>::pi * distanceToEdge / fadeLength);
+
+        data[i] = static_cast<float> (sweepLevel * gain * std::sin (phase));
+    }
+}
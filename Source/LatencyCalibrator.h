@@ -0,0 +1,242 @@
+/*
+  ==============================================================================
+
+    LatencyCalibrator.h
+    Created: 17 Oct 2026 6:34:51pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MultiDevicePlayer.h"
+
+/**
+    Measures the latency of every Linked device relative to the Main device
+    through an input device that hears all of them, such as a microphone or
+    a loopback input.
+
+    The calibrator is the audio source of the Main device while it plays a
+    test signal: a logarithmic sweep in one time slot per device, with all
+    other devices muted. The input is captured meanwhile. The arrival time of
+    every sweep is then found by an FFT cross-correlation on a background
+    thread, and the difference between the arrival times and the slot times
+    is added to the latency of each Linked device.
+
+    Every device plays the same stream, so only the time between the sweeps
+    matters, and the clocks of the input and output devices don't need to be
+    related.
+*/
+class LatencyCalibrator  : public AudioSource,
+                           private AudioIODeviceCallback,
+                           private AsyncUpdater,
+                           private Thread
+{
+public:
+    LatencyCalibrator (MultiDevicePlayer& mdp, double maxLatencyInMs);
+    ~LatencyCalibrator() override;
+
+    //==========================================================================
+    /** [Non-realtime] [Non-thread-safe]
+        Sets up the input device manager for an input selector, without
+        opening a device. The calibrator only opens the input while a
+        calibration runs. A device picked in an input selector is opened by
+        the selector, and stays open until the next calibration has finished.
+    */
+    void initialiseInput();
+
+    /** Returns the device manager of the input that hears the outputs. */
+    AudioDeviceManager& getInputDeviceManager() { return inputDeviceManager; }
+
+    //==========================================================================
+    enum class State
+    {
+        idle,
+        measuring,      // playing the test signal and capturing the input
+        analysing,
+        finished,
+        failed
+    };
+
+    /** [Non-realtime] [Message thread only]
+        Opens the input device chosen in the input device manager, or the
+        default input, and starts a calibration on a background thread.
+        The input is closed again on the message thread once the
+        calibration has finished. Device types, such as simulated loopback
+        inputs, must be added to the input device manager first.
+
+        @returns    false if a calibration is already running, or the input
+                    of the last one isn't closed yet.
+    */
+    bool start();
+
+    /** [Non-realtime] [Message thread only]
+        Closes the input of a finished calibration. The calibration thread
+        triggers it on the message thread. An app that doesn't run the
+        message loop must call it itself.
+
+        @returns    true once no calibration holds the input.
+    */
+    bool serviceInput();
+
+    /** [Non-realtime] [Thread-safe]
+        Stops a running calibration. The latencies are left unchanged.
+    */
+    void cancel();
+
+    /** [Realtime] [Thread-safe] */
+    State getState() const { return state.load(); }
+
+    /** [Realtime] [Thread-safe]
+        Returns the progress of the measurement, between 0 and 1.
+    */
+    double getProgress() const { return progress.load(); }
+
+    /** [Realtime] [Thread-safe]
+        Returns true while the test signal is playing. The calibrator must be
+        rendered instead of the other sources of the Main device meanwhile.
+    */
+    bool isPlayingTestSignal() const { return isPlaying.load(); }
+
+    //==========================================================================
+    struct Result
+    {
+        bool isValid = false;
+
+        // Arrival of the device sweep after the Main device sweep [ms]
+        float measuredOffsetInMs = 0.0f;
+
+        // Latency that has been set for the device [ms]
+        float newLatencyInMs = 0.0f;
+
+        // Correlation peak relative to the correlation RMS level
+        float peakToRmsRatio = 0.0f;
+    };
+
+    /** [Non-realtime] [Thread-safe]
+        Returns the result of the last calibration for a Linked device.
+    */
+    Result getResult (int linkedDeviceIndex) const;
+
+    /** [Non-realtime] [Thread-safe]
+        Returns the reason the last calibration failed.
+    */
+    String getErrorMessage() const;
+
+    //==========================================================================
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
+    void releaseResources() override;
+
+private:
+    MultiDevicePlayer& player;
+    const float maxLatency;
+
+    std::atomic<State> state { State::idle };
+    std::atomic<double> progress { 0.0 };
+
+    //==========================================================================
+    // Test signal, rendered by the Main device
+    std::atomic<bool> isPlaying { false };
+    std::atomic<int64> signalPosition { 0 };
+
+    AudioBuffer<float> sweep;           // at the Main device sample rate
+    std::atomic<double> outputSampleRate { 0.0 };
+    int slotLength = 0;                 // [samples]
+    int sweepOffset = 0;                // [samples]
+
+    //==========================================================================
+    // Input capture
+    AudioDeviceManager inputDeviceManager;
+
+    AudioBuffer<float> capture;
+    std::atomic<bool> isCapturing { false };
+    std::atomic<int> capturePosition { 0 };
+    std::atomic<double> inputSampleRate { 0.0 };
+
+    // Set by the calibration thread until the message thread closes the input
+    std::atomic<bool> closePending { false };
+
+    void audioDeviceIOCallbackWithContext (const float* const* inputChannelData,
+                                           int numInputChannels,
+                                           float* const* outputChannelData,
+                                           int numOutputChannels,
+                                           int numSamples,
+                                           const AudioIODeviceCallbackContext& context) override;
+    void audioDeviceAboutToStart (AudioIODevice* device) override;
+    void audioDeviceStopped() override;
+
+    //==========================================================================
+    // Results
+    mutable CriticalSection resultLock;
+    Array<Result> results;
+    String errorMessage;
+
+    //==========================================================================
+    /** [Calibration thread] */
+    void run() override;
+
+    /** [Calibration thread]
+        Plays the test signal and captures the input.
+
+        @returns    an error message, or an empty string on success.
+    */
+    String measure (int numSlots, double captureSampleRate);
+
+    /** [Calibration thread]
+        Finds the arrival times of the sweeps and sets the latencies.
+
+        @returns    an error message, or an empty string on success.
+    */
+    String analyse (int numSlots, double captureSampleRate);
+
+    /** [Calibration thread]
+        Unmutes one device and mutes the others. Device 0 is the Main device.
+    */
+    void setAudibleDevice (int deviceIndex, float mainGain, const Array<float>& linkedGains);
+
+    void fail (const String& message);
+
+    /** Opens the input and starts capturing callbacks. */
+    void openInput();
+
+    /** [Message thread only] Closes the input, so it's only held while
+        calibrating.
+    */
+    void closeInput();
+
+    void handleAsyncUpdate() override;
+
+    /** [Calibration thread] Measures and analyses, see run(). */
+    void calibrate();
+
+    /** Renders the logarithmic sweep at a given sample rate. */
+    static void renderSweep (AudioBuffer<float>& buffer, double sampleRate);
+
+    //==========================================================================
+    // Test signal layout. Every device gets a slot with a sweep, followed by
+    //  silence that lets it fade before the next device is unmuted.
+    inline static constexpr double slotLengthInSeconds = 2.0;
+    inline static constexpr double sweepOffsetInSeconds = 0.5;
+    inline static constexpr double sweepLengthInSeconds = 0.5;
+    inline static constexpr double sweepStartFrequency = 200.0;
+    inline static constexpr double sweepEndFrequency = 10000.0;
+    inline static constexpr float sweepLevel = 0.5f;
+
+    // Input captured after the last slot, which bounds the measurable latency
+    inline static constexpr double captureTailInSeconds = 1.0;
+
+    // Channels captured from the input device
+    inline static constexpr int numInputChannels = 2;
+
+    // Weaker correlation peaks are treated as a missing sweep
+    inline static constexpr float minPeakToRmsRatio = 10.0f;
+
+    // The calibration fails if the test signal or the input stops advancing
+    inline static constexpr int stallTimeoutInMs = 3000;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LatencyCalibrator)
+};
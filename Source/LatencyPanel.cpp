@@ -1,91 +1,202 @@
-/*
-  ==============================================================================
-
-    LatencyPanel.cpp
-    Created: 18 Sep 2022 7:27:42pm
-    Author:  Anthony Alfimov
-
-  ==============================================================================
-*/
-
-#include <JuceHeader.h>
-#include "LatencyPanel.h"
-
-//==============================================================================
-LatencyPanel::LatencyPanel (AudioFilePlayer& player, double maxLatencyInMs,
-                            std::function<void (float)> setLatency)
-    : syncPlayer (player)
-{
-    // Latency panel label:
-    addAndMakeVisible (latencyPanelLabel);
-    latencyPanelLabel.setFont (headingFont);
-    const auto headingColour
-    = getLookAndFeel().findColour (AppLookAndFeel::headingColourId);
-    latencyPanelLabel.setColour (Label::textColourId, headingColour);
-    latencyPanelLabel.setText("Latency Compensation", dontSendNotification);
-
-    // Sync track button:
-    addAndMakeVisible (syncTrackButton);
-    syncTrackButton.setToggleable (true);
-    syncTrackButton.setToggleState (false, dontSendNotification);
-    syncTrackButton.setButtonText ("Play Sync Track");
-
-    syncPlayer.onTransportStarted = [this]
-    {
-        syncTrackButton.setButtonText ("Stop Sync Track");
-        syncTrackButton.setToggleState (true, dontSendNotification);
-    };
-
-    syncPlayer.onTransportStopped = [this]
-    {
-        syncTrackButton.setButtonText ("Play Sync Track");
-        syncTrackButton.setToggleState (false, dontSendNotification);
-    };
-
-    syncTrackButton.onClick = [this]
-    {
-        if (! syncTrackButton.getToggleState())
-            syncPlayer.playPause();
-        else
-            syncPlayer.stop();
-    };
-
-    // Latency slider
-    addAndMakeVisible (latencySlider);
-    addAndMakeVisible (latencySliderLabel);
-    latencySlider.setTextBoxStyle (Slider::TextBoxRight, false,
-                                   buttonWidth, buttonHeight);
-    latencySlider.setDoubleClickReturnValue (true, 0.0);
-    latencySlider.setScrollWheelEnabled (false);
-    latencySlider.setRange ({ -maxLatencyInMs, maxLatencyInMs }, 1.0);
-    latencySlider.setTextValueSuffix (" ms");
-    latencySliderLabel.setText ("Latency", dontSendNotification);
-
-    latencySlider.onValueChange = [this, setLatency]
-    {
-        setLatency (static_cast<float> (latencySlider.getValue()));
-    };
-}
-
-void LatencyPanel::resized()
-{
-    // Manage panel hight
-    int requiredHeight = 3 * (buttonHeight + padding) + padding;
-    setSize (getWidth(), requiredHeight);
-
-    auto bounds = getLocalBounds().reduced (padding);   // get usable bounds
-
-    // Section label:
-    latencyPanelLabel.setBounds (bounds.removeFromTop (buttonHeight));
-
-    // Sync Track button:
-    bounds.removeFromTop (padding);     // add spacing
-    syncTrackButton.setBounds (bounds.removeFromTop (buttonHeight)
-                                     .withWidth (2 * buttonWidth + padding));
-
-    // Latency slider:
-    bounds.removeFromTop (padding);     // add spacing
-    setSliderBounds (latencySlider,
-                     latencySliderLabel,
-                     bounds.removeFromTop (buttonHeight));
-}
+/*
+  ==============================================================================
+
+    LatencyPanel.cpp
+    Created: 18 Sep 2022 7:27:42pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "LatencyPanel.h"
+
+//==============================================================================
+LatencyPanel::LatencyPanel (AudioFilePlayer& player, LatencyCalibrator& calibrator,
+                            double maxLatencyInMs, int numLinkedDevices,
+                            std::function<void (int, float)> setLatency)
+    : syncPlayer (player),
+      latencyCalibrator (calibrator),
+      inputSelector (calibrator.getInputDeviceManager(), 1, 2, 0, 0, false, false, false, false)
+{
+    // Latency panel label:
+    addAndMakeVisible (latencyPanelLabel);
+    latencyPanelLabel.setFont (headingFont);
+    const auto headingColour
+    = getLookAndFeel().findColour (AppLookAndFeel::headingColourId);
+    latencyPanelLabel.setColour (Label::textColourId, headingColour);
+    latencyPanelLabel.setText("Latency Compensation", dontSendNotification);
+
+    // Sync track button:
+    addAndMakeVisible (syncTrackButton);
+    syncTrackButton.setToggleable (true);
+    syncTrackButton.setToggleState (false, dontSendNotification);
+    syncTrackButton.setButtonText ("Play Sync Track");
+
+    syncPlayer.onTransportStarted = [this]
+    {
+        syncTrackButton.setButtonText ("Stop Sync Track");
+        syncTrackButton.setToggleState (true, dontSendNotification);
+    };
+
+    syncPlayer.onTransportStopped = [this]
+    {
+        syncTrackButton.setButtonText ("Play Sync Track");
+        syncTrackButton.setToggleState (false, dontSendNotification);
+    };
+
+    syncTrackButton.onClick = [this]
+    {
+        if (! syncTrackButton.getToggleState())
+            syncPlayer.playPause();
+        else
+            syncPlayer.stop();
+    };
+
+    // Calibration through an input device that hears all outputs:
+    addAndMakeVisible (inputSelector);
+
+    addAndMakeVisible (calibrateButton);
+    calibrateButton.setButtonText ("Calibrate");
+    calibrateButton.onClick = [this] { calibrateButtonClicked(); };
+
+    addAndMakeVisible (calibrationStatusLabel);
+
+    // Latency sliders, one per Linked device
+    for (int i = 0; i < numLinkedDevices; ++i)
+    {
+        auto* latencySlider = latencySliders.add (std::make_unique<Slider>());
+        auto* latencySliderLabel = latencySliderLabels.add (std::make_unique<Label>());
+
+        addAndMakeVisible (latencySlider);
+        addAndMakeVisible (latencySliderLabel);
+        latencySlider->setTextBoxStyle (Slider::TextBoxRight, false,
+                                        buttonWidth, buttonHeight);
+        latencySlider->setDoubleClickReturnValue (true, 0.0);
+        latencySlider->setScrollWheelEnabled (false);
+        latencySlider->setRange ({ -maxLatencyInMs, maxLatencyInMs }, 1.0);
+        latencySlider->setTextValueSuffix (" ms");
+        latencySliderLabel->setText (numLinkedDevices > 1 ? "Latency " + String (i + 1)
+                                                          : "Latency",
+                                     dontSendNotification);
+
+        latencySlider->onValueChange = [latencySlider, i, setLatency]
+        {
+            setLatency (i, static_cast<float> (latencySlider->getValue()));
+        };
+    }
+}
+
+void LatencyPanel::resized()
+{
+    // Manage panel hight
+    int requiredHeight = (3 + latencySliders.size()) * (buttonHeight + padding) + padding
+                       + inputSelector.getHeight() + padding;
+    setSize (getWidth(), requiredHeight);
+
+    auto bounds = getLocalBounds().reduced (padding);   // get usable bounds
+
+    // Section label:
+    latencyPanelLabel.setBounds (bounds.removeFromTop (buttonHeight));
+
+    // Sync Track button:
+    bounds.removeFromTop (padding);     // add spacing
+    syncTrackButton.setBounds (bounds.removeFromTop (buttonHeight)
+                                     .withWidth (2 * buttonWidth + padding));
+
+    // Calibration:
+    bounds.removeFromTop (padding);     // add spacing
+    inputSelector.setBounds (bounds.removeFromTop (inputSelector.getHeight()));
+
+    bounds.removeFromTop (padding);     // add spacing
+    auto calibrationBounds = bounds.removeFromTop (buttonHeight);
+    calibrateButton.setBounds (calibrationBounds.removeFromLeft (2 * buttonWidth + padding));
+    calibrationBounds.removeFromLeft (padding);     // add spacing
+    calibrationStatusLabel.setBounds (calibrationBounds);
+
+    // Latency sliders:
+    for (int i = 0; i < latencySliders.size(); ++i)
+    {
+        bounds.removeFromTop (padding);     // add spacing
+        setSliderBounds (*latencySliders[i],
+                         *latencySliderLabels[i],
+                         bounds.removeFromTop (buttonHeight));
+    }
+}
+
+void LatencyPanel::calibrateButtonClicked()
+{
+    const auto state = latencyCalibrator.getState();
+
+    if (state == LatencyCalibrator::State::measuring
+        || state == LatencyCalibrator::State::analysing)
+    {
+        latencyCalibrator.cancel();
+        stopTimer();
+        calibrateButton.setButtonText ("Calibrate");
+        calibrationStatusLabel.setText ("Cancelled", dontSendNotification);
+        return;
+    }
+
+    // The test signal replaces the sync track
+    syncPlayer.stop();
+
+    if (latencyCalibrator.start())
+    {
+        calibrateButton.setButtonText ("Cancel");
+        startTimer (100);
+    }
+}
+
+void LatencyPanel::timerCallback()
+{
+    switch (latencyCalibrator.getState())
+    {
+        case LatencyCalibrator::State::measuring:
+            calibrationStatusLabel.setText ("Measuring... "
+                                            + String (roundToInt (100.0 * latencyCalibrator.getProgress()))
+                                            + "%", dontSendNotification);
+            return;
+
+        case LatencyCalibrator::State::analysing:
+            calibrationStatusLabel.setText ("Analysing...", dontSendNotification);
+            return;
+
+        case LatencyCalibrator::State::finished:
+        {
+            // The calibrator has set the latencies, so only the sliders follow
+            StringArray offsets;
+
+            for (int i = 0; i < latencySliders.size(); ++i)
+            {
+                const auto result = latencyCalibrator.getResult (i);
+
+                if (result.isValid)
+                {
+                    latencySliders[i]->setValue (result.newLatencyInMs, dontSendNotification);
+                    offsets.add (String (result.measuredOffsetInMs, 2) + " ms");
+                }
+                else
+                {
+                    offsets.add ("not detected");
+                }
+            }
+
+            calibrationStatusLabel.setText ("Corrected by " + offsets.joinIntoString (", "),
+                                            dontSendNotification);
+            break;
+        }
+
+        case LatencyCalibrator::State::failed:
+            calibrationStatusLabel.setText (latencyCalibrator.getErrorMessage(),
+                                            dontSendNotification);
+            break;
+
+        case LatencyCalibrator::State::idle:
+        default:
+            break;
+    }
+
+    stopTimer();
+    calibrateButton.setButtonText ("Calibrate");
+}
@@ -1,39 +1,54 @@
-/*
-  ==============================================================================
-
-    LatencyPanel.h
-    Created: 18 Sep 2022 7:27:42pm
-    Author:  Anthony Alfimov
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-#include "InterfacePanel.h"
-#include "AudioFilePlayer.h"
-
-//==============================================================================
-class LatencyPanel  : public InterfacePanel
-{
-public:
-    LatencyPanel (AudioFilePlayer& player, double maxLatencyInMs,
-                  std::function<void (float)> latencySetter);
-
-    //==========================================================================
-    void resized() override;
-
-private:
-    AudioFilePlayer& syncPlayer;
-
-    //==========================================================================
-    // UI Components
-    Label latencyPanelLabel;
-    TextButton syncTrackButton;
-    Slider latencySlider;
-    Label latencySliderLabel;
-
-    //==========================================================================
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LatencyPanel)
-};
+/*
+  ==============================================================================
+
+    LatencyPanel.h
+    Created: 18 Sep 2022 7:27:42pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "InterfacePanel.h"
+#include "AudioFilePlayer.h"
+#include "LatencyCalibrator.h"
+
+//==============================================================================
+class LatencyPanel  : public InterfacePanel,
+                      private Timer
+{
+public:
+    LatencyPanel (AudioFilePlayer& player, LatencyCalibrator& calibrator,
+                  double maxLatencyInMs, int numLinkedDevices,
+                  std::function<void (int, float)> latencySetter);
+
+    //==========================================================================
+    void resized() override;
+
+private:
+    AudioFilePlayer& syncPlayer;
+    LatencyCalibrator& latencyCalibrator;
+
+    //==========================================================================
+    // UI Components
+    Label latencyPanelLabel;
+    TextButton syncTrackButton;
+    OwnedArray<Slider> latencySliders;
+    OwnedArray<Label> latencySliderLabels;     // one per Linked device
+
+    //==========================================================================
+    // Automatic calibration
+    AudioDeviceSelectorComponent inputSelector;
+    TextButton calibrateButton;
+    Label calibrationStatusLabel;
+
+    void calibrateButtonClicked();
+
+    /** Follows the calibration progress and shows its results */
+    void timerCallback() override;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LatencyPanel)
+};
@@ -1,120 +1,187 @@
-/*
-  ==============================================================================
-
-     Multi-Device Player - A simple cross-platform aggregate device player
-     Copyright (C) 2022  Anthony Alfimov
-
-     This program is free software: you can redistribute it and/or modify
-     it under the terms of the GNU General Public License as published by
-     the Free Software Foundation, either version 3 of the License, or
-     (at your option) any later version.
-
-     This program is distributed in the hope that it will be useful,
-     but WITHOUT ANY WARRANTY; without even the implied warranty of
-     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-     GNU General Public License for more details.
-
-     You should have received a copy of the GNU General Public License
-     along with this program.  If not, see <https://www.gnu.org/licenses/>.
-
-  ==============================================================================
-*/
-
-#include <JuceHeader.h>
-#include "MainComponent.h"
-
-//==============================================================================
-class MutliDevicePlayerApplication  : public JUCEApplication
-{
-public:
-    //==============================================================================
-    MutliDevicePlayerApplication() {}
-
-    const String getApplicationName() override { return ProjectInfo::projectName; }
-    const String getApplicationVersion() override { return ProjectInfo::versionString; }
-    bool moreThanOneInstanceAllowed() override { return false; }
-
-    //==============================================================================
-    void initialise (const String& commandLine) override
-    {
-        // This method is where you should put your application's initialisation code..
-
-        mainWindow.reset (new MainWindow (getApplicationName()));
-    }
-
-    void shutdown() override
-    {
-        // Add your application's shutdown code here..
-
-        mainWindow = nullptr; // (deletes our window)
-    }
-
-    //==============================================================================
-    void systemRequestedQuit() override
-    {
-        // This is called when the app is being asked to quit: you can ignore this
-        // request and let the app carry on running, or call quit() to allow the app to close.
-        quit();
-    }
-
-    void anotherInstanceStarted (const String& commandLine) override
-    {
-        // When another instance of the app is launched while this one is running,
-        // this method is invoked, and the commandLine parameter tells you what
-        // the other instance's command-line arguments were.
-    }
-
-    //==============================================================================
-    /*
-        This class implements the desktop window that contains an instance of
-        our MainComponent class.
-    */
-    class MainWindow    : public DocumentWindow
-    {
-    public:
-        MainWindow (String name)
-            : DocumentWindow (name,
-                              Desktop::getInstance().getDefaultLookAndFeel()
-                                    .findColour (ResizableWindow::backgroundColourId),
-                              DocumentWindow::allButtons)
-        {
-            setUsingNativeTitleBar (true);
-            setContentOwned (new MainComponent(), true);
-
-           #if JUCE_IOS || JUCE_ANDROID
-            setFullScreen (true);
-           #else
-            setResizable (true, true);
-            setResizeLimits (600, 400, 3840, 2160);
-            centreWithSize (getWidth(), getHeight());
-           #endif
-
-            setVisible (true);
-        }
-
-        void closeButtonPressed() override
-        {
-            // This is called when the user tries to close this window. Here, we'll just
-            // ask the app to quit when this happens, but you can change this to do
-            // whatever you need.
-            JUCEApplication::getInstance()->systemRequestedQuit();
-        }
-
-        /* Note: Be careful if you override any DocumentWindow methods - the base
-           class uses a lot of them, so by overriding you might break its functionality.
-           It's best to do all your work in your content component instead, but if
-           you really have to override any DocumentWindow methods, make sure your
-           subclass also calls the superclass's method.
-        */
-
-    private:
-        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainWindow)
-    };
-
-private:
-    std::unique_ptr<MainWindow> mainWindow;
-};
-
-//==============================================================================
-// This macro generates the main() routine that launches the app.
-START_JUCE_APPLICATION (MutliDevicePlayerApplication)
+/*
+  ==============================================================================
+
+     Multi-Device Player - A simple cross-platform aggregate device player
+     Copyright (C) 2022  Anthony Alfimov
+
+     This program is free software: you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published by
+     the Free Software Foundation, either version 3 of the License, or
+     (at your option) any later version.
+
+     This program is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+     GNU General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "MainComponent.h"
+#include "HeadlessPlayer.h"
+
+//==============================================================================
+class MutliDevicePlayerApplication  : public JUCEApplication
+{
+public:
+    //==============================================================================
+    MutliDevicePlayerApplication() {}
+
+    const String getApplicationName() override { return ProjectInfo::projectName; }
+    const String getApplicationVersion() override { return ProjectInfo::versionString; }
+    bool moreThanOneInstanceAllowed() override { return false; }
+
+    //==============================================================================
+    void initialise (const String& commandLine) override
+    {
+        // This method is where you should put your application's initialisation code..
+
+        const ArgumentList args (getApplicationName(), commandLine);
+
+        // Without a display, the player runs with --headless and no windows
+        if (args.containsOption ("--headless"))
+        {
+            initialiseHeadless (args);
+            return;
+        }
+
+        // Number of Linked devices can be set with --linked-devices=N
+        int numLinkedDevices = 1;
+
+        if (args.containsOption ("--linked-devices"))
+            numLinkedDevices = jlimit (1, MultiDevicePlayer::maxNumLinkedDevices,
+                                       args.getValueForOption ("--linked-devices")
+                                           .getIntValue());
+
+        // Callback trace for the simulator can be recorded with --record-trace=<file>
+        File traceFile;
+
+        if (args.containsOption ("--record-trace"))
+            traceFile = File::getCurrentWorkingDirectory()
+                            .getChildFile (args.getValueForOption ("--record-trace"));
+
+        // Telemetry can be logged from the start with --log-telemetry=<file>
+        File telemetryFile;
+
+        if (args.containsOption ("--log-telemetry"))
+            telemetryFile = File::getCurrentWorkingDirectory()
+                                .getChildFile (args.getValueForOption ("--log-telemetry"));
+
+        mainWindow.reset (new MainWindow (getApplicationName(), numLinkedDevices,
+                                          traceFile, telemetryFile));
+    }
+
+    void shutdown() override
+    {
+        // Add your application's shutdown code here..
+
+        mainWindow = nullptr; // (deletes our window)
+        headlessPlayer = nullptr;
+    }
+
+    //==============================================================================
+    void systemRequestedQuit() override
+    {
+        // This is called when the app is being asked to quit: you can ignore this
+        // request and let the app carry on running, or call quit() to allow the app to close.
+        quit();
+    }
+
+    void anotherInstanceStarted (const String& commandLine) override
+    {
+        // When another instance of the app is launched while this one is running,
+        // this method is invoked, and the commandLine parameter tells you what
+        // the other instance's command-line arguments were.
+    }
+
+    //==============================================================================
+    /*
+        This class implements the desktop window that contains an instance of
+        our MainComponent class.
+    */
+    class MainWindow    : public DocumentWindow
+    {
+    public:
+        MainWindow (String name, int numLinkedDevices, const File& traceFile,
+                    const File& telemetryFile)
+            : DocumentWindow (name,
+                              Desktop::getInstance().getDefaultLookAndFeel()
+                                    .findColour (ResizableWindow::backgroundColourId),
+                              DocumentWindow::allButtons)
+        {
+            setUsingNativeTitleBar (true);
+            setContentOwned (new MainComponent (numLinkedDevices, traceFile, telemetryFile),
+                             true);
+
+           #if JUCE_IOS || JUCE_ANDROID
+            setFullScreen (true);
+           #else
+            setResizable (true, true);
+            setResizeLimits (600, 400, 3840, 2160);
+            centreWithSize (getWidth(), getHeight());
+           #endif
+
+            setVisible (true);
+        }
+
+        void closeButtonPressed() override
+        {
+            // This is called when the user tries to close this window. Here, we'll just
+            // ask the app to quit when this happens, but you can change this to do
+            // whatever you need.
+            JUCEApplication::getInstance()->systemRequestedQuit();
+        }
+
+        /* Note: Be careful if you override any DocumentWindow methods - the base
+           class uses a lot of them, so by overriding you might break its functionality.
+           It's best to do all your work in your content component instead, but if
+           you really have to override any DocumentWindow methods, make sure your
+           subclass also calls the superclass's method.
+        */
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainWindow)
+    };
+
+private:
+    std::unique_ptr<MainWindow> mainWindow;
+    std::unique_ptr<HeadlessPlayer> headlessPlayer;
+
+    //==============================================================================
+    void initialiseHeadless (const ArgumentList& args)
+    {
+        if (args.containsOption ("--help|-h"))
+        {
+            std::cout << HeadlessPlayer::getHelpText();
+            quit();
+            return;
+        }
+
+        if (args.containsOption ("--list-devices"))
+        {
+            std::cout << HeadlessPlayer::getDeviceList();
+            quit();
+            return;
+        }
+
+        headlessPlayer = std::make_unique<HeadlessPlayer> (HeadlessPlayer::getSettings (args));
+        headlessPlayer->onPlaybackFinished = [] { quit(); };
+
+        const auto error = headlessPlayer->start();
+
+        if (error.isNotEmpty())
+        {
+            std::cerr << error << std::endl;
+            setApplicationReturnValue (1);
+            quit();
+        }
+    }
+};
+
+//==============================================================================
+// This macro generates the main() routine that launches the app.
+START_JUCE_APPLICATION (MutliDevicePlayerApplication)
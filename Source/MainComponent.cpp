@@ -1,227 +1,204 @@
-/*
-  ==============================================================================
-
-     Multi-Device Player - A simple cross-platform aggregate device player
-     Copyright (C) 2022  Anthony Alfimov
-
-     This program is free software: you can redistribute it and/or modify
-     it under the terms of the GNU General Public License as published by
-     the Free Software Foundation, either version 3 of the License, or
-     (at your option) any later version.
-
-     This program is distributed in the hope that it will be useful,
-     but WITHOUT ANY WARRANTY; without even the implied warranty of
-     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-     GNU General Public License for more details.
-
-     You should have received a copy of the GNU General Public License
-     along with this program.  If not, see <https://www.gnu.org/licenses/>.
-
-  ==============================================================================
- */
-
-#include "MainComponent.h"
-#include "InterfacePanel.h"
-
-//==============================================================================
-MainComponent::MainComponent() : audioOutput (maxLatencyInMs)
-{
-    //==========================================================================
-    // Update Look And Feel
-    LookAndFeel::setDefaultLookAndFeel (&lookAndFeel);
-    setLookAndFeel (&lookAndFeel);
-
-    //==========================================================================
-    // Set up audio playback
-    audioOutput.initialiseAudio (this, 2);
-
-    //==========================================================================
-    // Set up file player
-    filePlayerPanel = std::make_unique<FilePlayerPanel> (filePlayer, formatManager);
-    addAndMakeVisible (filePlayerPanel.get());
-
-    //==========================================================================
-    // Set up device panel
-    devicePanel = std::make_unique<DevicePanel> (audioOutput, syncPlayer, maxLatencyInMs);
-    addAndMakeVisible (devicePanel.get());
-
-    //==========================================================================
-    // Set initial component size
-    setSize (600, 600);
-    resized();
-
-    //==========================================================================
-    // Set up transport management facilities
-    formatManager.registerBasicFormats();
-
-    filePlayer.addChangeListener (&deviceSelectorUpdater);
-    syncPlayer.addChangeListener (&deviceSelectorUpdater);
-
-    //==========================================================================
-    // Set up sync track
-    syncPlayer.setAudioFormatReader (formatManager.createReaderFor
-        (std::make_unique<MemoryInputStream> (BinaryData::SyncTrack_wav,
-                                              BinaryData::SyncTrack_wavSize,
-                                              false)));
-    syncPlayer.setLooping (true);
-}
-
-MainComponent::~MainComponent()
-{
-    //==========================================================================
-    // Shutdown audio
-    audioOutput.shutdownAudio();
-
-    //==========================================================================
-    // Release Look And Feel
-    LookAndFeel::setDefaultLookAndFeel (nullptr);
-    setLookAndFeel (nullptr);
-}
-
-//==============================================================================
-void MainComponent::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
-{
-    syncPlayer.prepareToPlay (samplesPerBlockExpected, sampleRate);
-    filePlayer.prepareToPlay (samplesPerBlockExpected, sampleRate);
-
-    const auto numChannels = audioOutput.mainDeviceManager
-        .getCurrentAudioDevice()->getActiveOutputChannels().countNumberOfSetBits();
-
-    crossfadeBuffer.setSize (numChannels, samplesPerBlockExpected, false, true);
-}
-
-void MainComponent::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
-{
-    /* Denormals are temporarily disabled when this object is created at the
-       beginning of the process block and re-enabled when it's destroyed at the
-       end of the process block. Therefore, anything that happens within the
-       process block doesn't need to disable denormals - they won't be
-       re-enabled until the end of the process block.
-    */
-    ScopedNoDenormals noDenormals;
-
-    if (syncPlayer.isPlaying())
-    {
-        shouldFadeFromSync = true;
-        syncPlayer.getNextAudioBlock (bufferToFill);
-
-        if (shouldFadeToSync)
-        {
-            fadeAudioSource (bufferToFill, filePlayer, false);
-            shouldFadeToSync = false;
-        }
-    }
-    else
-    {
-        shouldFadeToSync = true;
-
-        if (shouldFadeFromSync)
-        {
-            syncPlayer.getNextAudioBlock (bufferToFill);
-            fadeAudioSource (bufferToFill, filePlayer, true);
-            shouldFadeFromSync = false;
-        }
-        else
-        {
-            filePlayer.getNextAudioBlock (bufferToFill);
-        }
-    }
-}
-
-void MainComponent::releaseResources()
-{
-    syncPlayer.releaseResources();
-    filePlayer.releaseResources();
-}
-
-//==============================================================================
-void MainComponent::paint (Graphics& g)
-{
-    // Fill background
-    const auto bgColour = getLookAndFeel()
-                                .findColour (ResizableWindow::backgroundColourId);
-    g.fillAll (bgColour);
-
-    // Paint File Player Panel background
-    g.setColour (bgColour.darker (0.2f));
-    const auto filePlayerPanelBounds = filePlayerPanel->getBounds().toFloat();
-    g.drawRoundedRectangle (filePlayerPanelBounds,
-                            InterfacePanel::corner,
-                            InterfacePanel::line);
-
-    // Paint Device Panel background
-    g.setColour (bgColour.darker (0.2f));
-    const auto devicePanelBounds = devicePanel->getBounds().toFloat();
-    g.fillRoundedRectangle (devicePanelBounds,
-                            InterfacePanel::corner);
-    g.drawRoundedRectangle (devicePanelBounds,
-                            InterfacePanel::corner,
-                            InterfacePanel::line);
-}
-
-void MainComponent::resized()
-{
-    auto bounds = getLocalBounds().reduced (InterfacePanel::padding);
-
-    //==========================================================================
-    // File Player Panel:
-    filePlayerPanel->setBounds (bounds.removeFromTop (filePlayerPanel->getHeight()));
-    bounds.removeFromTop (InterfacePanel::padding);     // add spacing
-
-    //==========================================================================
-    // Device Panel:
-    devicePanel->setBounds (bounds);
-}
-
-//==============================================================================
-void MainComponent::fadeAudioSource (const AudioSourceChannelInfo& bufferToFill,
-                                     AudioSource& sourceToFade,
-                                     bool shouldFadeIn)
-{
-    AudioSourceChannelInfo crossfadeInfo (&crossfadeBuffer,
-                                          bufferToFill.startSample,
-                                          bufferToFill.numSamples);
-    sourceToFade.getNextAudioBlock (crossfadeInfo);
-
-    const int fadeLength = jmin (256, bufferToFill.numSamples);
-
-    if (shouldFadeIn)
-    {
-        // Fade buffer in
-        crossfadeBuffer.applyGainRamp (bufferToFill.startSample, fadeLength, 0.0f, 1.0f);
-    }
-    else
-    {
-        // Fade buffer out
-        crossfadeBuffer.applyGainRamp (bufferToFill.startSample, fadeLength, 1.0f, 0.0f);
-
-        if (bufferToFill.numSamples > 256)
-        {
-            crossfadeBuffer.clear (bufferToFill.startSample + 256,
-                                   bufferToFill.numSamples - 256);
-        }
-    }
-
-    const int numChannels = jmin (crossfadeBuffer.getNumChannels(),
-                                  bufferToFill.buffer->getNumChannels());
-
-    for (int ch = 0; ch < numChannels; ++ch)
-    {
-        bufferToFill.buffer->addFrom (ch,
-                                      bufferToFill.startSample,
-                                      crossfadeBuffer,
-                                      ch,
-                                      bufferToFill.startSample,
-                                      bufferToFill.numSamples);
-    }
-}
-
-//==============================================================================
-void MainComponent::DeviceSelectorUpdater::
-        changeListenerCallback (ChangeBroadcaster* source)
-{
-    if (owner->filePlayer.isPlaying() || owner->syncPlayer.isPlaying())
-        owner->devicePanel->setDeviceSelectorEnabled (false);
-    else
-        owner->devicePanel->setDeviceSelectorEnabled (true);
-}
+/*
+  ==============================================================================
+
+     Multi-Device Player - A simple cross-platform aggregate device player
+     Copyright (C) 2022  Anthony Alfimov
+
+     This program is free software: you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published by
+     the Free Software Foundation, either version 3 of the License, or
+     (at your option) any later version.
+
+     This program is distributed in the hope that it will be useful,
+     but WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+     GNU General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+ */
+
+#include "MainComponent.h"
+#include "InterfacePanel.h"
+
+//==============================================================================
+MainComponent::MainComponent (int numLinkedDevices, const File& fileToSaveTraceTo,
+                              const File& fileToLogTelemetryTo)
+    : audioOutput (maxLatencyInMs, numLinkedDevices),
+      traceFile (fileToSaveTraceTo)
+{
+    //==========================================================================
+    // Update Look And Feel
+    LookAndFeel::setDefaultLookAndFeel (&lookAndFeel);
+    setLookAndFeel (&lookAndFeel);
+
+    //==========================================================================
+    // Set up audio playback. The voices are added before the mixer is prepared
+    fileVoice = mixer.addVoice (&filePlayer, 1.0f);
+    syncVoice = mixer.addVoice (&syncPlayer);
+    mixer.setProfiler (&audioOutput.getMainProfiler());
+
+    if (traceFile != File())
+        audioOutput.startTraceRecording();
+
+    audioOutput.initialiseAudio (this, 2);
+
+    // The calibration input is only opened while calibrating
+    latencyCalibrator.initialiseInput();
+
+    if (fileToLogTelemetryTo != File())
+        telemetry.startLogging (fileToLogTelemetryTo);
+
+    telemetry.start();
+
+    //==========================================================================
+    // Set up file player
+    filePlayerPanel = std::make_unique<FilePlayerPanel> (filePlayer, formatManager, audioCache);
+    addAndMakeVisible (filePlayerPanel.get());
+
+    //==========================================================================
+    // Set up device panel
+    devicePanel = std::make_unique<DevicePanel> (audioOutput, syncPlayer, latencyCalibrator,
+                                                 telemetry, maxLatencyInMs);
+    addAndMakeVisible (devicePanel.get());
+
+    //==========================================================================
+    // Set initial component size
+    setSize (600, 600);
+    resized();
+
+    //==========================================================================
+    // Set up transport management facilities
+    formatManager.registerBasicFormats();
+
+    filePlayer.addChangeListener (&deviceSelectorUpdater);
+    syncPlayer.addChangeListener (&deviceSelectorUpdater);
+
+    //==========================================================================
+    // Set up sync track
+    syncPlayer.setAudioFormatReader (formatManager.createReaderFor
+        (std::make_unique<MemoryInputStream> (BinaryData::SyncTrack_wav,
+                                              BinaryData::SyncTrack_wavSize,
+                                              false)));
+    syncPlayer.setLooping (true);
+}
+
+MainComponent::~MainComponent()
+{
+    //==========================================================================
+    // Shutdown audio
+    latencyCalibrator.cancel();
+    telemetry.stop();
+    audioOutput.shutdownAudio();
+
+    // The format manager is deleted before the players
+    filePlayer.waitForQueuedFiles();
+
+    if (traceFile != File())
+        audioOutput.saveTrace (traceFile);
+
+    //==========================================================================
+    // Release Look And Feel
+    LookAndFeel::setDefaultLookAndFeel (nullptr);
+    setLookAndFeel (nullptr);
+}
+
+//==============================================================================
+void MainComponent::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    // The source renders the routed source channels, not the device outputs
+    mixer.setNumChannels (audioOutput.getNumSourceChannels());
+    mixer.prepareToPlay (samplesPerBlockExpected, sampleRate);
+    latencyCalibrator.prepareToPlay (samplesPerBlockExpected, sampleRate);
+}
+
+void MainComponent::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    /* Denormals are temporarily disabled when this object is created at the
+       beginning of the process block and re-enabled when it's destroyed at the
+       end of the process block. Therefore, anything that happens within the
+       process block doesn't need to disable denormals - they won't be
+       re-enabled until the end of the process block.
+    */
+    ScopedNoDenormals noDenormals;
+
+    // Scheduled starts are placed against the time the block leaves the devices
+    const auto blockOutputTime = audioOutput.getMainBlockOutputTime();
+    syncPlayer.setNextBlockOutputTime (blockOutputTime);
+    filePlayer.setNextBlockOutputTime (blockOutputTime);
+
+    // The calibration test signal replaces the players while it's playing
+    if (latencyCalibrator.isPlayingTestSignal())
+    {
+        latencyCalibrator.getNextAudioBlock (bufferToFill);
+        return;
+    }
+
+    // The sync track replaces the file player while it's playing
+    const int activeVoice = syncPlayer.isPlaying() ? syncVoice : fileVoice;
+
+    if (mixer.getTargetGain (activeVoice) != 1.0f)
+        mixer.crossfadeTo (activeVoice, crossfadeLengthInSamples);
+
+    mixer.getNextAudioBlock (bufferToFill);
+}
+
+void MainComponent::releaseResources()
+{
+    mixer.releaseResources();
+    latencyCalibrator.releaseResources();
+}
+
+//==============================================================================
+void MainComponent::paint (Graphics& g)
+{
+    // Fill background
+    const auto bgColour = getLookAndFeel()
+                                .findColour (ResizableWindow::backgroundColourId);
+    g.fillAll (bgColour);
+
+    // Paint File Player Panel background
+    g.setColour (bgColour.darker (0.2f));
+    const auto filePlayerPanelBounds = filePlayerPanel->getBounds().toFloat();
+    g.drawRoundedRectangle (filePlayerPanelBounds,
+                            InterfacePanel::corner,
+                            InterfacePanel::line);
+
+    // Paint Device Panel background
+    g.setColour (bgColour.darker (0.2f));
+    const auto devicePanelBounds = devicePanel->getBounds().toFloat();
+    g.fillRoundedRectangle (devicePanelBounds,
+                            InterfacePanel::corner);
+    g.drawRoundedRectangle (devicePanelBounds,
+                            InterfacePanel::corner,
+                            InterfacePanel::line);
+}
+
+void MainComponent::resized()
+{
+    auto bounds = getLocalBounds().reduced (InterfacePanel::padding);
+
+    //==========================================================================
+    // File Player Panel:
+    filePlayerPanel->setBounds (bounds.removeFromTop (filePlayerPanel->getHeight()));
+    bounds.removeFromTop (InterfacePanel::padding);     // add spacing
+
+    //==========================================================================
+    // Device Panel:
+    devicePanel->setBounds (bounds);
+}
+
+//==============================================================================
+void MainComponent::DeviceSelectorUpdater::
+        changeListenerCallback (ChangeBroadcaster* source)
+{
+    // A Linked device is prepared before its first callback and fades in
+    //  from the shared buffer, so it can be swapped during playback. The Main
+    //  device feeds everything, so it's only changed while stopped
+    if (owner->filePlayer.isPlaying() || owner->syncPlayer.isPlaying())
+        owner->devicePanel->setMainDeviceSelectorEnabled (false);
+    else
+        owner->devicePanel->setMainDeviceSelectorEnabled (true);
+}
@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    MappedReaderPrefetcher.cpp
+    Created: 17 Oct 2026 3:37:52pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "MappedReaderPrefetcher.h"
+
+MappedReaderPrefetcher::MappedReaderPrefetcher (MemoryMappedAudioFormatReader& mappedReader,
+                                                const PositionableAudioSource& playbackSource,
+                                                TimeSliceThread& prefetchThread,
+                                                double prefetchInSeconds)
+    : reader (mappedReader),
+      source (playbackSource),
+      thread (prefetchThread),
+      windowSize (jmax (int64 { 1 },
+                        static_cast<int64> (prefetchInSeconds * mappedReader.sampleRate))),
+      samplesPerPage (jmax (int64 { 1 },
+                            pageSize / jmax (1, static_cast<int> (mappedReader.numChannels
+                                                                  * mappedReader.bitsPerSample
+                                                                  / 8))))
+{
+    jassert (reader.getMappedSection().getLength() == reader.lengthInSamples);
+
+    thread.addTimeSliceClient (this);
+}
+
+MappedReaderPrefetcher::~MappedReaderPrefetcher()
+{
+    thread.removeTimeSliceClient (this);
+}
+
+//==============================================================================
+MemoryMappedAudioFormatReader*
+    MappedReaderPrefetcher::createMappedReader (AudioFormatManager& formatManager,
+                                                const File& file)
+{
+    auto* format = formatManager.findFormatForFileExtension (file.getFileExtension());
+
+    if (format == nullptr)
+        return nullptr;
+
+    // Formats that can't be mapped, like compressed ones, return nullptr
+    std::unique_ptr<MemoryMappedAudioFormatReader> reader (format->createMemoryMappedReader (file));
+
+    if (reader == nullptr || reader->lengthInSamples <= 0 || ! reader->mapEntireFile())
+        return nullptr;
+
+    // Mapping fails when the address space is too small for the file
+    if (reader->getMappedSection().getLength() != reader->lengthInSamples)
+        return nullptr;
+
+    return reader.release();
+}
+
+//==============================================================================
+int MappedReaderPrefetcher::useTimeSlice()
+{
+    const auto length = reader.lengthInSamples;
+
+    if (length <= 0)
+        return idleWaitTime;
+
+    const auto position = jlimit (int64 { 0 }, length, source.getNextReadPosition());
+
+    // Start over from the play head after a seek or a jump back to the loop start
+    if (position < prefetchStart || position > prefetchEnd)
+        prefetchEnd = position;
+
+    prefetchStart = position;
+
+    const auto windowEnd = source.isLooping() ? position + windowSize
+                                              : jmin (length, position + windowSize);
+
+    if (prefetchEnd >= windowEnd)
+        return idleWaitTime;
+
+    const auto sliceEnd = jmin (windowEnd, prefetchEnd + maxPagesPerSlice * samplesPerPage);
+
+    // Reading a single sample faults in its whole page
+    for (auto sample = prefetchEnd; sample < sliceEnd; sample += samplesPerPage)
+        reader.touchSample (sample % length);
+
+    prefetchEnd = sliceEnd;
+
+    return 1;
+}
@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    MappedReaderPrefetcher.h
+    Created: 17 Oct 2026 3:37:52pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Keeps the pages of a memory-mapped audio file resident ahead of
+    the playback position.
+
+    Reading from a mapped file never makes a system call, but the first access
+    to every page faults it in from disk. The prefetcher touches the pages
+    ahead of the play head on its own thread, so that the thread that decodes
+    the file finds them already in memory. Seeking only moves the prefetch
+    window, so it is nearly instant even in very large files.
+*/
+class MappedReaderPrefetcher  : private TimeSliceClient
+{
+public:
+    /** Creates a prefetcher and registers it with the thread.
+
+        @param mappedReader         reader of the mapped file. The entire file
+                                    must be mapped
+        @param playbackSource       source that reports the playback position
+                                    in samples of the file
+        @param prefetchThread       thread that touches the pages. It must be
+                                    started by the caller
+        @param prefetchInSeconds    size of the window ahead of the play head
+    */
+    MappedReaderPrefetcher (MemoryMappedAudioFormatReader& mappedReader,
+                            const PositionableAudioSource& playbackSource,
+                            TimeSliceThread& prefetchThread,
+                            double prefetchInSeconds);
+
+    ~MappedReaderPrefetcher() override;
+
+    //==========================================================================
+    /** [Non-realtime] [Thread-safe]
+        Opens an uncompressed file with a memory-mapped reader, if its format
+        supports it.
+
+        @returns    nullptr if the file can't be mapped, for example if it's
+                    compressed. The caller takes ownership of the reader.
+    */
+    static MemoryMappedAudioFormatReader* createMappedReader (AudioFormatManager& formatManager,
+                                                              const File& file);
+
+private:
+    MemoryMappedAudioFormatReader& reader;
+    const PositionableAudioSource& source;
+    TimeSliceThread& thread;
+
+    const int64 windowSize;
+    const int64 samplesPerPage;
+
+    // Touched range of the file, on the continuous timeline of a looping file
+    int64 prefetchStart = 0;
+    int64 prefetchEnd = 0;
+
+    //==========================================================================
+    int useTimeSlice() override;
+
+    //==========================================================================
+    inline static constexpr int64 pageSize = 4096 /*bytes*/;
+
+    // Largest number of pages touched at a time
+    inline static constexpr int64 maxPagesPerSlice = 256;
+
+    // Time waited when the window is resident [ms]
+    inline static constexpr int idleWaitTime = 20;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MappedReaderPrefetcher)
+};
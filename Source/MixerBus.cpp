@@ -0,0 +1,230 @@
+/*
+  ==============================================================================
+
+    MixerBus.cpp
+    Created: 18 Oct 2026 3:18:26am
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "MixerBus.h"
+
+int MixerBus::addVoice (AudioSource* sourceToPlay, float initialGain)
+{
+    jassert (sourceToPlay != nullptr);
+
+    if (numVoices == maxNumVoices)
+        return -1;
+
+    auto& voice = voices[static_cast<size_t> (numVoices)];
+    voice.source = sourceToPlay;
+    voice.gain = voice.targetGain = initialGain;
+    voice.rampDelay = voice.rampRemaining = 0;
+
+    return numVoices++;
+}
+
+//==============================================================================
+void MixerBus::setVoiceGain (int voiceIndex, float targetGain, int rampLength, int startOffset)
+{
+    jassert (isPositiveAndBelow (voiceIndex, numVoices));
+
+    auto& voice = voices[static_cast<size_t> (voiceIndex)];
+
+    // The ramp starts from whatever gain the voice has reached by then
+    voice.targetGain = targetGain;
+    voice.rampDelay = jmax (0, startOffset);
+    voice.rampRemaining = jmax (1, rampLength);
+}
+
+void MixerBus::crossfadeTo (int voiceIndex, int rampLength, int startOffset)
+{
+    for (int i = 0; i < numVoices; ++i)
+    {
+        const float targetGain = i == voiceIndex ? 1.0f : 0.0f;
+
+        if (voices[static_cast<size_t> (i)].targetGain != targetGain)
+            setVoiceGain (i, targetGain, rampLength, startOffset);
+    }
+}
+
+//==============================================================================
+void MixerBus::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    maxBlockSize = jmax (1, samplesPerBlockExpected);
+
+    scratchBuffer.setSize (numChannels, maxBlockSize, false, true);
+    rampGains.calloc (static_cast<size_t> (maxBlockSize));
+
+    for (int i = 0; i < numVoices; ++i)
+        voices[static_cast<size_t> (i)].source->prepareToPlay (samplesPerBlockExpected, sampleRate);
+}
+
+void MixerBus::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    // Split blocks larger than the prepared size, so they fit the scratch buffer
+    for (int done = 0; done < bufferToFill.numSamples; done += maxBlockSize)
+    {
+        processBlock (AudioSourceChannelInfo (bufferToFill.buffer,
+                                              bufferToFill.startSample + done,
+                                              jmin (maxBlockSize, bufferToFill.numSamples - done)));
+    }
+}
+
+void MixerBus::releaseResources()
+{
+    for (int i = 0; i < numVoices; ++i)
+        voices[static_cast<size_t> (i)].source->releaseResources();
+
+    scratchBuffer.setSize (numChannels, 0);
+    rampGains.free();
+}
+
+//==============================================================================
+void MixerBus::Voice::advance (int numSamples)
+{
+    if (rampRemaining == 0)
+        return;
+
+    if (rampDelay >= numSamples)
+    {
+        rampDelay -= numSamples;
+        return;
+    }
+
+    const int numRamped = jmin (rampRemaining, numSamples - rampDelay);
+
+    gain += (targetGain - gain) * static_cast<float> (numRamped) / static_cast<float> (rampRemaining);
+    rampRemaining -= numRamped;
+    rampDelay = 0;
+
+    if (rampRemaining == 0)
+        gain = targetGain;
+}
+
+void MixerBus::processBlock (const AudioSourceChannelInfo& info)
+{
+    // A steady voice at unity gain renders straight into the output, and
+    //  the others are added to it
+    Voice* directVoice = nullptr;
+
+    for (int i = 0; i < numVoices && directVoice == nullptr; ++i)
+    {
+        auto& voice = voices[static_cast<size_t> (i)];
+
+        if (voice.gain == 1.0f && voice.isSteady (info.numSamples))
+            directVoice = &voice;
+    }
+
+    if (directVoice != nullptr)
+    {
+        if (profiler != nullptr)
+        {
+            const StageProfiler::ScopedTimer decodeTimer (*profiler, StageProfiler::decode);
+            directVoice->source->getNextAudioBlock (info);
+        }
+        else
+        {
+            directVoice->source->getNextAudioBlock (info);
+        }
+    }
+    else
+    {
+        info.clearActiveBufferRegion();
+    }
+
+    for (int i = 0; i < numVoices; ++i)
+    {
+        auto& voice = voices[static_cast<size_t> (i)];
+
+        if (&voice != directVoice)
+        {
+            if (profiler != nullptr)
+            {
+                const StageProfiler::ScopedTimer mixTimer (*profiler,
+                    voice.isSteady (info.numSamples) ? StageProfiler::decode
+                                                     : StageProfiler::crossfade);
+                mixVoice (voice, info);
+            }
+            else
+            {
+                mixVoice (voice, info);
+            }
+        }
+
+        voice.advance (info.numSamples);
+    }
+}
+
+void MixerBus::mixVoice (Voice& voice, const AudioSourceChannelInfo& info)
+{
+    const int numSamples = info.numSamples;
+
+    // Samples of the block where the gain ramps
+    const bool isRamping = ! voice.isSteady (numSamples);
+    const int rampStart = isRamping ? voice.rampDelay : numSamples;
+    const int rampEnd = isRamping ? jmin (numSamples, voice.rampDelay + voice.rampRemaining)
+                                  : numSamples;
+    const bool rampEnds = isRamping && voice.rampDelay + voice.rampRemaining <= numSamples;
+
+    // The voice is only rendered where it's audible
+    const int audibleStart = voice.gain == 0.0f ? rampStart : 0;
+    const int audibleEnd = rampEnds && voice.targetGain == 0.0f ? rampEnd : numSamples;
+
+    if (audibleStart >= audibleEnd)
+        return;
+
+    voice.source->getNextAudioBlock (AudioSourceChannelInfo (&scratchBuffer, audibleStart,
+                                                             audibleEnd - audibleStart));
+
+    // Before the ramp
+    addScratch (info, audibleStart, jmin (rampStart, audibleEnd), voice.gain);
+
+    // The ramp, with the gains computed once for all channels
+    const int rampMixStart = jmax (rampStart, audibleStart);
+    const int rampMixEnd = jmin (rampEnd, audibleEnd);
+
+    if (rampMixStart < rampMixEnd)
+    {
+        const float step = (voice.targetGain - voice.gain) / static_cast<float> (voice.rampRemaining);
+
+        for (int i = rampMixStart; i < rampMixEnd; ++i)
+            rampGains[i] = voice.gain + step * static_cast<float> (i - rampStart + 1);
+
+        const int numChannelsToMix = jmin (scratchBuffer.getNumChannels(),
+                                           info.buffer->getNumChannels());
+
+        for (int ch = 0; ch < numChannelsToMix; ++ch)
+        {
+            FloatVectorOperations::addWithMultiply (info.buffer->getWritePointer (ch, info.startSample + rampMixStart),
+                                                    scratchBuffer.getReadPointer (ch, rampMixStart),
+                                                    rampGains + rampMixStart,
+                                                    rampMixEnd - rampMixStart);
+        }
+    }
+
+    // After the ramp
+    if (rampEnds)
+        addScratch (info, jmax (rampEnd, audibleStart), audibleEnd, voice.targetGain);
+}
+
+void MixerBus::addScratch (const AudioSourceChannelInfo& info, int start, int end, float gain)
+{
+    if (start >= end || gain == 0.0f)
+        return;
+
+    const int numChannelsToMix = jmin (scratchBuffer.getNumChannels(),
+                                       info.buffer->getNumChannels());
+
+    for (int ch = 0; ch < numChannelsToMix; ++ch)
+    {
+        auto* output = info.buffer->getWritePointer (ch, info.startSample + start);
+        const auto* scratch = scratchBuffer.getReadPointer (ch, start);
+
+        if (gain == 1.0f)
+            FloatVectorOperations::add (output, scratch, end - start);
+        else
+            FloatVectorOperations::addWithMultiply (output, scratch, gain, end - start);
+    }
+}
@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    MixerBus.h
+    Created: 18 Oct 2026 3:18:26am
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "StageProfiler.h"
+
+/**
+    Mixes a fixed set of sources, each through a voice with its own gain.
+
+    The voices are added before the bus is prepared, and nothing is allocated
+    while it plays. A gain change is a linear ramp that can start at any
+    sample of the next block, so crossfades between voices are
+    sample-accurate.
+
+    Every voice only costs what it contributes. A silent voice isn't rendered
+    at all, a voice that fades out is only rendered up to the end of its ramp,
+    and a voice that fades in from silence only from the start of its ramp.
+    A voice at unity gain renders straight into the output. The others are
+    rendered into a scratch buffer and added to it with vector operations.
+*/
+class MixerBus  : public AudioSource
+{
+public:
+    MixerBus() = default;
+
+    //==========================================================================
+    /** [Non-realtime] [Non-thread-safe]
+        Adds a voice that plays a source. Must not be called while the bus
+        is prepared.
+
+        @param sourceToPlay     source of the voice. It's not owned, and it's
+                                prepared and released by the bus
+        @param initialGain      gain of the voice until it's changed
+        @returns                index of the voice, or -1 if every voice
+                                slot is taken
+    */
+    int addVoice (AudioSource* sourceToPlay, float initialGain = 0.0f);
+
+    /** [Non-realtime] [Non-thread-safe]
+        Sets the number of channels the voices render. Applies from the next
+        prepareToPlay() call.
+    */
+    void setNumChannels (int newNumChannels) { numChannels = jmax (1, newNumChannels); }
+
+    /** [Non-realtime] [Non-thread-safe]
+        Times the voices into the decode stage of a profiler, and the voices
+        that are ramping into the crossfade stage. Pass nullptr to stop timing.
+    */
+    void setProfiler (StageProfiler* profilerToUse) { profiler = profilerToUse; }
+
+    //==========================================================================
+    /** [Realtime] [Audio thread only]
+        Ramps the gain of a voice linearly from its gain at the start of the
+        ramp to a new gain. Replaces a ramp that hasn't finished.
+
+        @param voiceIndex       index returned by addVoice()
+        @param targetGain       gain at the end of the ramp
+        @param rampLength       length of the ramp, in samples
+        @param startOffset      samples into the next block at which
+                                the ramp starts
+    */
+    void setVoiceGain (int voiceIndex, float targetGain, int rampLength, int startOffset = 0);
+
+    /** [Realtime] [Audio thread only]
+        Fades a voice in to unity gain, and every other voice out, over the
+        same samples.
+    */
+    void crossfadeTo (int voiceIndex, int rampLength, int startOffset = 0);
+
+    /** [Realtime] [Audio thread only]
+        Returns the gain a voice ends up at once its ramp has finished.
+    */
+    float getTargetGain (int voiceIndex) const { return voices[static_cast<size_t> (voiceIndex)].targetGain; }
+
+    //==========================================================================
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
+    void releaseResources() override;
+
+    //==========================================================================
+    inline static constexpr int maxNumVoices = 8;
+
+private:
+    /** Gain state of a voice. The pending ramp starts `rampDelay` samples
+        into the next block, and has `rampRemaining` samples to go.
+    */
+    struct Voice
+    {
+        AudioSource* source = nullptr;
+        float gain = 0.0f;
+        float targetGain = 0.0f;
+        int rampDelay = 0;
+        int rampRemaining = 0;
+
+        /** Returns true if the gain doesn't change within a block. */
+        bool isSteady (int numSamples) const { return rampRemaining == 0 || rampDelay >= numSamples; }
+
+        /** Moves the ramp forward by a block. */
+        void advance (int numSamples);
+    };
+
+    std::array<Voice, maxNumVoices> voices;
+    int numVoices = 0;
+
+    //==========================================================================
+    int numChannels = 2;
+    int maxBlockSize = 0;
+
+    // Output of the voices that don't render straight into the output
+    AudioBuffer<float> scratchBuffer;
+
+    // Gains of the ramping samples of a voice, shared by its channels
+    HeapBlock<float> rampGains;
+
+    StageProfiler* profiler = nullptr;
+
+    //==========================================================================
+    /** Mixes a block that is not larger than maxBlockSize. */
+    void processBlock (const AudioSourceChannelInfo& info);
+
+    /** Renders a voice into the scratch buffer where it's audible, and adds
+        it to the output with its gains.
+    */
+    void mixVoice (Voice& voice, const AudioSourceChannelInfo& info);
+
+    /** Adds samples of the scratch buffer to the output at a constant gain. */
+    void addScratch (const AudioSourceChannelInfo& info, int start, int end, float gain);
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MixerBus)
+};
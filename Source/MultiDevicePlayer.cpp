@@ -1,364 +1,1115 @@
-/*
-  ==============================================================================
-
-    MultiDevicePlayer.cpp
-    Created: 19 Sep 2022 7:51:03pm
-    Author:  Anthony Alfimov
-
-  ==============================================================================
-*/
-
-#include "MultiDevicePlayer.h"
-
-MultiDevicePlayer::MultiDevicePlayer (double maxLatencyInMs)
-    : mainSource (*this, maxLatencyInMs), linkedSource (*this, maxLatencyInMs)
-{
-    // Start checking if audio devices need to be reset:
-    startTimerHz (10);
-
-    //==========================================================================
-    // Check that atomic float is lock-free
-    static_assert (std::atomic<float>::is_always_lock_free,
-                   "std::atomic for type float must be always lock free");
-}
-
-//==============================================================================
-void MultiDevicePlayer::initialiseAudio (AudioSource* src, int numOutputChannels)
-{
-    mainSource.setSource (src);
-
-    mainDeviceManager.initialiseWithDefaultDevices (0, numOutputChannels);
-    linkedDeviceManager.initialiseWithDefaultDevices (0, numOutputChannels);
-
-    mainDeviceManager.addAudioCallback (&mainSourcePlayer);
-    linkedDeviceManager.addAudioCallback (&linkedSourcePlayer);
-
-    mainSourcePlayer.setSource (&mainSource);
-    linkedSourcePlayer.setSource (&linkedSource);
-}
-
-void MultiDevicePlayer::shutdownAudio()
-{
-    mainSourcePlayer.setSource (nullptr);
-    linkedSourcePlayer.setSource (nullptr);
-
-    mainDeviceManager.removeAudioCallback (&mainSourcePlayer);
-    linkedDeviceManager.removeAudioCallback (&linkedSourcePlayer);
-
-    mainDeviceManager.closeAudioDevice();
-    linkedDeviceManager.closeAudioDevice();
-
-    mainSource.setSource (nullptr);
-}
-
-//==============================================================================
-void MultiDevicePlayer::resizeSharedBuffer (int numChannels)
-{
-    const int bufferSize = 6 * jmax (mainSource.getPushBlockSize(),
-                                     linkedSource.getPopBlockSize());
-
-    mainSource.prepareLatencyCompensation (bufferSize);
-
-    if (numChannels < 0)
-        numChannels = sharedBuffer.getNumChannels();
-
-    if (sharedBuffer.getTotalSize() == bufferSize
-        && sharedBuffer.getNumChannels() == numChannels)
-        return;
-
-    sharedBuffer.setSize (numChannels, bufferSize);
-
-    // Linked device should start popping from the shared buffer only after
-    //  it has been sufficiently filled
-    linkedSource.haltUntilBufferIsHalfFilled();
-}
-
-//==============================================================================
-void MultiDevicePlayer::resetAudioDevice (AudioDeviceManager& manager)
-{
-    auto setup = manager.getAudioDeviceSetup();
-    setup.sampleRate = manager.getCurrentAudioDevice()->getCurrentSampleRate();
-    manager.setAudioDeviceSetup (setup, true);
-}
-
-void MultiDevicePlayer::timerCallback()
-{
-    if (mainSource.needsAudioDeviceReset.load())
-        resetAudioDevice (mainDeviceManager);
-
-    if (linkedSource.needsAudioDeviceReset.load())
-        resetAudioDevice (linkedDeviceManager);
-}
-
-//==============================================================================
-MultiDevicePlayer::PushAudioSource::
-    PushAudioSource (MultiDevicePlayer& mdp, double maxLatencyInMs)
-        : owner (mdp), maxLatencyDelayInMs (maxLatencyInMs)
-{
-    //==========================================================================
-    // Check that atomic float is lock-free
-    static_assert (std::atomic<bool>::is_always_lock_free,
-                   "std::atomic for type bool must be always lock free");
-}
-
-void MultiDevicePlayer::PushAudioSource::
-        prepareToPlay (int samplesPerBlockExpected, double sampleRate)
-{
-    needsAudioDeviceReset.store (false);
-
-    if (source != nullptr)
-        source->prepareToPlay (samplesPerBlockExpected, sampleRate);
-
-    {
-        SpinLock::ScopedLockType popLock (owner.popMutex);
-        SpinLock::ScopedLockType resizeLock (owner.resizeMutex);
-
-        numChannels = owner.mainDeviceManager
-            .getCurrentAudioDevice()->getActiveOutputChannels().countNumberOfSetBits();
-        nominalSampleRate = sampleRate;
-        blockSize = samplesPerBlockExpected;
-
-        // NB! Always update the resampling ratio before resizing the shared
-        //     buffer because pop block size depends on the ratio.
-        owner.linkedSource.updateResamplingRatio();
-        owner.resizeSharedBuffer (numChannels);
-    }
-}
-
-void MultiDevicePlayer::PushAudioSource::
-        getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
-{
-    // Check that device sample rate hasn't been externally changed
-    if (owner.mainDeviceManager.getCurrentAudioDevice()->getCurrentSampleRate()
-        != nominalSampleRate)
-    {
-        bufferToFill.clearActiveBufferRegion();
-        needsAudioDeviceReset.store (true);
-        return;
-    }
-
-    // Process audio and push it to the shared buffer
-    if (source != nullptr)
-        source->getNextAudioBlock (bufferToFill);
-    else
-        bufferToFill.clearActiveBufferRegion();
-
-    // Push audio to the shared buffer
-    {
-        SpinLock::ScopedTryLockType pushLock (owner.pushMutex);
-
-        if (pushLock.isLocked())
-        {
-            const int freeSpace = owner.sharedBuffer.getFreeSpace();
-            const int sharedBufferSize = owner.sharedBuffer.getTotalSize();
-            const int minFreeSpace = static_cast<int> (1.2f * blockSize);
-
-            if (waitForBufferSpace)
-            {
-                if (freeSpace >= sharedBufferSize / 2)
-                {
-                    // Push and fade in
-                    owner.sharedBuffer.pushWithRamp (bufferToFill, 0.0f, 1.0f);
-                    waitForBufferSpace = false;
-                }
-            }
-            else
-            {
-                if (freeSpace >= minFreeSpace)
-                {
-                    // Push
-                    owner.sharedBuffer.push (bufferToFill);
-                }
-                else
-                {
-                    // Push and fade out
-                    owner.sharedBuffer.pushWithRamp (bufferToFill, 1.0f, 0.0f);
-                    waitForBufferSpace = true;
-                }
-            }
-        }
-    }
-
-    // Delay audio for latency compensation
-    const float latencyValue = owner.latency.load();
-
-    if (latencyValue > 0.0)
-        delay.setDelay (roundToInt (nominalSampleRate * 0.001 * latencyValue)
-                        + fixedDelay);
-    else
-        delay.setDelay (fixedDelay);
-
-    delay.getNextAudioBlock (bufferToFill);
-}
-
-void MultiDevicePlayer::PushAudioSource::releaseResources()
-{
-    if (source != nullptr)
-        source->releaseResources();
-
-    delay.releaseResources();
-}
-
-void MultiDevicePlayer::PushAudioSource::
-        prepareLatencyCompensation (int sharedBufferSize)
-{
-    fixedDelay = sharedBufferSize / 2;
-
-    const int maxDelayInSamples
-    = roundToInt (nominalSampleRate * 0.001 * maxLatencyDelayInMs) + fixedDelay;
-    delay.setDelayBufferSize (numChannels, maxDelayInSamples);
-    delay.prepareToPlay (blockSize, nominalSampleRate);
-}
-
-//==============================================================================
-MultiDevicePlayer::PopAudioSource::
-    PopAudioSource (MultiDevicePlayer& mdp, double maxLatencyInMs)
-        : owner (mdp), maxLatencyDelayInMs (maxLatencyInMs)
-{
-    //==========================================================================
-    // Check that atomic float is lock-free
-    static_assert (std::atomic<bool>::is_always_lock_free,
-                   "std::atomic for type bool must be always lock free");
-}
-
-void MultiDevicePlayer::PopAudioSource::
-        prepareToPlay (int samplesPerBlockExpected, double sampleRate)
-{
-    needsAudioDeviceReset.store (false);
-
-    const int numChannels = owner.linkedDeviceManager
-        .getCurrentAudioDevice()->getActiveOutputChannels().countNumberOfSetBits();
-
-    delay.setDelayBufferSize (numChannels,
-                              roundToInt (sampleRate * 0.001 * maxLatencyDelayInMs));
-    delay.prepareToPlay (samplesPerBlockExpected, sampleRate);
-
-    {
-        SpinLock::ScopedLockType pushLock (owner.pushMutex);
-        SpinLock::ScopedLockType resizeLock (owner.resizeMutex);
-
-        nominalSampleRate = sampleRate;
-        blockSize = samplesPerBlockExpected;
-
-        resampler = std::make_unique<ResamplingAudioSource> (&sharedBufferSource,
-                                                             false,
-                                                             numChannels);
-
-        // NB! Always update the resampling ratio before resizing the shared
-        //     buffer because pop block size depends on the ratio.
-        initialiseResampling();
-        owner.resizeSharedBuffer();
-    }
-}
-
-void MultiDevicePlayer::PopAudioSource::
-        getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
-{
-    // Check that device sample rate hasn't been externally changed
-    if (owner.linkedDeviceManager.getCurrentAudioDevice()->getCurrentSampleRate()
-        != nominalSampleRate)
-    {
-        bufferToFill.clearActiveBufferRegion();
-        needsAudioDeviceReset.store (true);
-        return;
-    }
-
-    // Pop audio from the shared buffer
-    {
-        SpinLock::ScopedTryLockType popLock (owner.popMutex);
-
-        if (popLock.isLocked())
-        {
-            const int numReady = owner.sharedBuffer.getNumReady();
-            const int sharedBufferSize = owner.sharedBuffer.getTotalSize();
-            const int minNumReady = static_cast<int> (1.2f * popBlockSize);
-
-            if (waitForBufferToFill)
-            {
-                if (numReady >= sharedBufferSize / 2)
-                {
-                    // Pop and fade in
-                    sharedBufferSource.setGainRamp (0.0f, 1.0f);
-                    resampler->getNextAudioBlock (bufferToFill);
-                    waitForBufferToFill = false;
-                }
-                else
-                {
-                    // Clear buffer
-                    bufferToFill.clearActiveBufferRegion();
-                }
-            }
-            else
-            {
-                if (numReady >= minNumReady)
-                {
-                    // Pop
-                    sharedBufferSource.setGainRamp (1.0f, 1.0f);
-                    resampler->getNextAudioBlock (bufferToFill);
-                }
-                else
-                {
-                    // Pop and fade out
-                    sharedBufferSource.setGainRamp (1.0f, 0.0f);
-                    resampler->getNextAudioBlock (bufferToFill);
-                    waitForBufferToFill = true;
-                }
-            }
-        }
-        else
-        {
-            // Clear buffer
-            bufferToFill.clearActiveBufferRegion();
-        }
-    }
-
-    // Delay audio for latency compensation
-    const float latencyValue = owner.latency.load();
-
-    if (latencyValue < 0.0)
-        delay.setDelay (roundToInt (nominalSampleRate * 0.001 * -latencyValue));
-    else
-        delay.setDelay (0);
-
-    delay.getNextAudioBlock (bufferToFill);
-}
-
-void MultiDevicePlayer::PopAudioSource::releaseResources()
-{
-    delay.releaseResources();
-
-    {
-        SpinLock::ScopedLockType resizeLock (owner.resizeMutex);
-
-        if (resampler != nullptr)
-        {
-            resampler->releaseResources();
-            resampler.reset();
-        }
-    }
-}
-
-void MultiDevicePlayer::PopAudioSource::updateResamplingRatio()
-{
-    if (resampler == nullptr)
-        return;
-
-    resampler->releaseResources();
-    initialiseResampling();
-}
-
-void MultiDevicePlayer::PopAudioSource::initialiseResampling()
-{
-    double resamplingRatio = owner.mainSource.getSampleRate() / nominalSampleRate;
-
-    // Max block size that can be requested by ResamplingAudioSource:
-    popBlockSize = roundToInt (blockSize * resamplingRatio) + 3;
-
-    // TODO: ResamplingAudioSource can reallocate during processing
-    // 1. Set resamplingRatio that would allocate buffer with excess
-    // 2. Call prepareToPlay to trigger buffer allocation
-    // 3. Set resamplingRatio to the actual value
-    
-    resampler->setResamplingRatio (resamplingRatio);
-    resampler->prepareToPlay (blockSize, nominalSampleRate);
-}
+/*
+  ==============================================================================
+
+    MultiDevicePlayer.cpp
+    Created: 19 Sep 2022 7:51:03pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "MultiDevicePlayer.h"
+
+MultiDevicePlayer::MultiDevicePlayer (double maxLatencyInMs, int numLinkedDevices)
+    : Thread ("Audio device service"),
+      trace (1 + numLinkedDevices, maxNumTracedCallbacks),
+      mainSource (*this, maxLatencyInMs)
+{
+    jassert (isPositiveAndNotGreaterThan (numLinkedDevices, maxNumLinkedDevices));
+
+    for (int i = 0; i < numLinkedDevices; ++i)
+        linkedDevices.add (std::make_unique<LinkedDevice> (*this, i, maxLatencyInMs));
+
+    //==========================================================================
+    // Check that atomic float and double are lock-free
+    static_assert (std::atomic<float>::is_always_lock_free,
+                   "std::atomic for type float must be always lock free");
+    static_assert (std::atomic<double>::is_always_lock_free,
+                   "std::atomic for type double must be always lock free");
+}
+
+MultiDevicePlayer::~MultiDevicePlayer()
+{
+    stopServiceThread();
+}
+
+//==============================================================================
+void MultiDevicePlayer::initialiseAudio (AudioSource* src, int numOutputChannels)
+{
+    mainSource.setSource (src);
+
+    // The Linked devices are opened first, so the Main device derives the
+    //  depth of the shared buffer from all of their blocks when it's prepared
+    for (auto* linked : linkedDevices)
+    {
+        linked->deviceManager.initialiseWithDefaultDevices (0, numOutputChannels);
+        linked->deviceManager.addAudioCallback (&linked->sourcePlayer);
+        linked->deviceManager.addChangeListener (this);
+        linked->sourcePlayer.setSource (&linked->source);
+    }
+
+    mainDeviceManager.initialiseWithDefaultDevices (0, numOutputChannels);
+    mainDeviceManager.addAudioCallback (&mainSourcePlayer);
+    mainDeviceManager.addChangeListener (this);
+    mainSourcePlayer.setSource (&mainSource);
+
+    startThread();
+}
+
+void MultiDevicePlayer::shutdownAudio()
+{
+    stopServiceThread();
+
+    mainDeviceManager.removeChangeListener (this);
+    mainSourcePlayer.setSource (nullptr);
+    mainDeviceManager.removeAudioCallback (&mainSourcePlayer);
+    mainDeviceManager.closeAudioDevice();
+
+    for (auto* linked : linkedDevices)
+    {
+        linked->deviceManager.removeChangeListener (this);
+        linked->sourcePlayer.setSource (nullptr);
+        linked->deviceManager.removeAudioCallback (&linked->sourcePlayer);
+        linked->deviceManager.closeAudioDevice();
+    }
+
+    mainSource.setSource (nullptr);
+}
+
+//==============================================================================
+void MultiDevicePlayer::resizeSharedBuffer (int numChannels, bool canShrink)
+{
+    // The buffer must fit blocks of the Main device and of every Linked device
+    int maxBlockSize = mainSource.getPushBlockSize();
+
+    for (auto* linked : linkedDevices)
+        maxBlockSize = jmax (maxBlockSize, linked->source.getPopBlockSize());
+
+    // The Linked devices keep the buffer half-filled by default, or at the
+    //  depth set by the adaptive sizing, which leaves room for the Main device
+    //  to push on top of it
+    const int defaultDepth = sharedBufferSizeInBlocks / 2 * maxBlockSize;
+    const int depth = adaptiveBufferDepth.load() > 0 ? adaptiveBufferDepth.load() : defaultDepth;
+
+    // The Linked devices follow a new depth while they play, so there must
+    //  be room for the largest depth without resizing
+    const int maxDepth = jmax (depth, mainSource.getMaxFixedDelay());
+
+    int bufferSize = jmax (sharedBufferSizeInBlocks * maxBlockSize, maxDepth + defaultDepth);
+
+    if (! canShrink)
+        bufferSize = jmax (bufferSize, sharedBuffer.getTotalSize());
+
+    if (! mainSource.setFixedDelay (depth))
+        mainSource.requestAudioDeviceReset();
+
+    if (numChannels < 0)
+        numChannels = sharedBuffer.getNumChannels();
+
+    if (sharedBuffer.getTotalSize() == bufferSize
+        && sharedBuffer.getNumChannels() == numChannels)
+        return;
+
+    sharedBuffer.setSize (numChannels, bufferSize);
+
+    // Linked devices should start popping from the shared buffer only after
+    //  it has been sufficiently filled
+    for (auto* linked : linkedDevices)
+        linked->source.haltUntilAligned();
+}
+
+//==============================================================================
+void MultiDevicePlayer::setAdaptiveBufferSizingEnabled (bool shouldBeEnabled)
+{
+    if (shouldBeEnabled == isTimerRunning())
+        return;
+
+    if (shouldBeEnabled)
+    {
+        bufferSizer.reset();
+        startTimer (bufferSizingIntervalInMs);
+    }
+    else
+    {
+        stopTimer();
+        setSharedBufferDepth (0);
+    }
+}
+
+void MultiDevicePlayer::updateAdaptiveBufferSizing()
+{
+    if (bufferSizerNeedsReset.exchange (false))
+        bufferSizer.reset();
+
+    if (mainDeviceManager.getCurrentAudioDevice() == nullptr)
+        return;
+
+    // Linked devices underrun if the jitter of both sides adds up
+    int64 numUnderruns = 0;
+    double maxLinkedJitter = 0.0;
+
+    for (auto* linked : linkedDevices)
+    {
+        numUnderruns += linked->source.statistics.getSnapshot().numUnderruns;
+        maxLinkedJitter = jmax (maxLinkedJitter, linked->source.getPeakJitterInSeconds());
+    }
+
+    const double jitterInSamples = mainSource.getSampleRate()
+                                 * (mainSource.getPeakJitterInSeconds() + maxLinkedJitter);
+    const double timeInSeconds = Time::getMillisecondCounterHiRes() * 0.001;
+    int newDepth = 0;
+    {
+        const ScopedLock resizeLock (resizeMutex);
+
+        // Underruns while the Main device delay moves to the last depth
+        //  don't tell anything about the new depth yet
+        if (mainSource.getAppliedFixedDelay() != mainSource.getFixedDelay())
+        {
+            bufferSizer.hold (timeInSeconds, numUnderruns);
+            return;
+        }
+
+        int maxPopBlockSize = 0;
+
+        for (auto* linked : linkedDevices)
+            maxPopBlockSize = jmax (maxPopBlockSize, linked->source.getPopBlockSize());
+
+        const int maxBlockSize = jmax (mainSource.getPushBlockSize(), maxPopBlockSize);
+
+        if (maxBlockSize <= 0)
+            return;
+
+        newDepth = bufferSizer.update (timeInSeconds, numUnderruns,
+                                       SharedBufferSizer::getRequiredDepth (maxPopBlockSize,
+                                                                            jitterInSamples),
+                                       sharedBufferSizeInBlocks / 2 * maxBlockSize, maxBlockSize);
+
+        // A deeper buffer would need the Main device to be prepared again
+        newDepth = jmin (newDepth, mainSource.getMaxFixedDelay());
+    }
+
+    if (newDepth != mainSource.getFixedDelay())
+        setSharedBufferDepth (newDepth);
+}
+
+void MultiDevicePlayer::setSharedBufferDepth (int newDepth)
+{
+    const ScopedLock resizeLock (resizeMutex);
+
+    adaptiveBufferDepth.store (newDepth);
+    resizeSharedBuffer (-1, false);
+
+    // The drift correction moves the lag of the Linked devices along with
+    //  the Main device delay. Without it, they are realigned to the new depth
+    if (! driftCorrectionEnabled.load())
+    {
+        mainSource.skipFixedDelayRamp();
+
+        for (auto* linked : linkedDevices)
+            linked->source.haltUntilAligned();
+    }
+}
+
+//==============================================================================
+void MultiDevicePlayer::resetAudioDevice (AudioDeviceManager& manager,
+                                          AudioSourcePlayer& player)
+{
+    auto* device = manager.getCurrentAudioDevice();
+
+    if (device == nullptr)
+        return;
+
+    // The device keeps running, also at a sample rate changed underneath it.
+    //  Adding the callback again prepares the audio source at the current
+    //  sample rate and block size of the device. Writing the new rate to the
+    //  setup would reopen the device, but the manager already copied it from
+    //  the device when it was notified of the change
+    manager.removeAudioCallback (&player);
+    manager.addAudioCallback (&player);
+}
+
+bool MultiDevicePlayer::isAudioDeviceResetPending() const
+{
+    if (mainSource.needsAudioDeviceReset.load())
+        return true;
+
+    for (auto* linked : linkedDevices)
+        if (linked->source.needsAudioDeviceReset.load())
+            return true;
+
+    return false;
+}
+
+void MultiDevicePlayer::serviceDeviceResets()
+{
+    if (mainSource.needsAudioDeviceReset.load())
+        resetAudioDevice (mainDeviceManager, mainSourcePlayer);
+
+    for (auto* linked : linkedDevices)
+    {
+        if (linked->source.needsAudioDeviceReset.load())
+            resetAudioDevice (linked->deviceManager, linked->sourcePlayer);
+    }
+}
+
+void MultiDevicePlayer::run()
+{
+    while (! threadShouldExit())
+    {
+        // The reset itself changes the device managers, so it runs on the
+        //  message thread
+        if (isAudioDeviceResetPending())
+            triggerAsyncUpdate();
+
+        // A request that arrives before the wait still wakes it
+        wait (-1);
+    }
+}
+
+void MultiDevicePlayer::stopServiceThread()
+{
+    signalThreadShouldExit();
+    notify();
+    stopThread (serviceThreadTimeoutInMs);
+}
+
+void MultiDevicePlayer::changeListenerCallback (ChangeBroadcaster* source)
+{
+    if (source == &mainDeviceManager && ! mainSourcePlayer.isRunningAtPreparedRate())
+        mainSource.requestAudioDeviceReset();
+
+    for (auto* linked : linkedDevices)
+    {
+        if (source == &linked->deviceManager && ! linked->sourcePlayer.isRunningAtPreparedRate())
+            linked->source.requestAudioDeviceReset();
+    }
+
+    serviceDeviceResets();
+}
+
+//==============================================================================
+MultiDevicePlayer::Statistics MultiDevicePlayer::getMainStatistics() const
+{
+    auto statistics = mainSource.statistics.getSnapshot();
+    statistics.numXRuns = mainSourcePlayer.getXRunCount();
+    return statistics;
+}
+
+MultiDevicePlayer::Statistics MultiDevicePlayer::getLinkedStatistics (int linkedDeviceIndex) const
+{
+    const auto* linked = linkedDevices[linkedDeviceIndex];
+
+    auto statistics = linked->source.statistics.getSnapshot();
+    statistics.numXRuns = linked->sourcePlayer.getXRunCount();
+    return statistics;
+}
+
+//==============================================================================
+int MultiDevicePlayer::DeviceSourcePlayer::getXRunCount() const
+{
+    const ScopedLock sl (deviceLock);
+    return device != nullptr ? device->getXRunCount() : 0;
+}
+
+bool MultiDevicePlayer::DeviceSourcePlayer::isRunningAtPreparedRate() const
+{
+    const ScopedLock sl (deviceLock);
+    return device == nullptr || device->getCurrentSampleRate() == preparedSampleRate;
+}
+
+void MultiDevicePlayer::DeviceSourcePlayer::audioDeviceAboutToStart (AudioIODevice* newDevice)
+{
+    // The source is prepared under the lock, so the rate check never
+    //  compares the device with a source that is being prepared
+    const ScopedLock sl (deviceLock);
+
+    device = newDevice;
+    preparedSampleRate = newDevice->getCurrentSampleRate();
+
+    AudioSourcePlayer::audioDeviceAboutToStart (newDevice);
+}
+
+void MultiDevicePlayer::DeviceSourcePlayer::audioDeviceStopped()
+{
+    {
+        const ScopedLock sl (deviceLock);
+        device = nullptr;
+    }
+
+    AudioSourcePlayer::audioDeviceStopped();
+}
+
+void MultiDevicePlayer::DeviceSourcePlayer::
+        audioDeviceIOCallbackWithContext (const float* const* inputChannelData,
+                                          int numInputChannels,
+                                          float* const* outputChannelData,
+                                          int numOutputChannels,
+                                          int numSamples,
+                                          const AudioIODeviceCallbackContext& context)
+{
+    // The time is taken before the source renders, like on entry
+    if (owner.deviceHostTimeEnabled.load() && context.hostTimeNs != nullptr)
+        callbackTime = Time::secondsToHighResolutionTicks (static_cast<double> (*context.hostTimeNs) * 1.0e-9);
+    else
+        callbackTime = Time::getHighResolutionTicks();
+
+    AudioSourcePlayer::audioDeviceIOCallbackWithContext (inputChannelData, numInputChannels,
+                                                         outputChannelData, numOutputChannels,
+                                                         numSamples, context);
+}
+
+//==============================================================================
+void MultiDevicePlayer::StatisticsCounters::reset (double sampleRate, int blockSize)
+{
+    numTransfers.store (0);
+    numOverflows.store (0);
+    numUnderruns.store (0);
+    numFadeIns.store (0);
+    numFadeOuts.store (0);
+    numWaits.store (0);
+
+    occupancySum.store (0);
+    minOccupancy.store (std::numeric_limits<int>::max());
+    maxOccupancy.store (0);
+    lastOccupancy.store (0);
+
+    loadMeasurer.reset (sampleRate, blockSize);
+}
+
+void MultiDevicePlayer::StatisticsCounters::addTransfer (int occupancy)
+{
+    increment (numTransfers);
+
+    occupancySum.store (occupancySum.load (std::memory_order_relaxed) + occupancy,
+                        std::memory_order_relaxed);
+
+    if (occupancy < minOccupancy.load (std::memory_order_relaxed))
+        minOccupancy.store (occupancy, std::memory_order_relaxed);
+
+    if (occupancy > maxOccupancy.load (std::memory_order_relaxed))
+        maxOccupancy.store (occupancy, std::memory_order_relaxed);
+
+    lastOccupancy.store (occupancy, std::memory_order_relaxed);
+}
+
+void MultiDevicePlayer::StatisticsCounters::addWait (int occupancy)
+{
+    increment (numWaits);
+    lastOccupancy.store (occupancy, std::memory_order_relaxed);
+}
+
+MultiDevicePlayer::Statistics MultiDevicePlayer::StatisticsCounters::getSnapshot() const
+{
+    Statistics snapshot;
+
+    snapshot.numTransfers = numTransfers.load (std::memory_order_relaxed);
+    snapshot.numOverflows = numOverflows.load (std::memory_order_relaxed);
+    snapshot.numUnderruns = numUnderruns.load (std::memory_order_relaxed);
+    snapshot.numFadeIns = numFadeIns.load (std::memory_order_relaxed);
+    snapshot.numFadeOuts = numFadeOuts.load (std::memory_order_relaxed);
+    snapshot.numWaits = numWaits.load (std::memory_order_relaxed);
+    snapshot.occupancy = lastOccupancy.load (std::memory_order_relaxed);
+    snapshot.load = loadMeasurer.getLoadAsProportion();
+
+    if (snapshot.numTransfers > 0)
+    {
+        snapshot.minOccupancy = minOccupancy.load (std::memory_order_relaxed);
+        snapshot.maxOccupancy = maxOccupancy.load (std::memory_order_relaxed);
+        snapshot.meanOccupancy = static_cast<double> (occupancySum.load (std::memory_order_relaxed))
+                               / static_cast<double> (snapshot.numTransfers);
+    }
+
+    return snapshot;
+}
+
+//==============================================================================
+bool MultiDevicePlayer::areLinkedDevicesStreaming() const
+{
+    for (auto* linked : linkedDevices)
+        if (! linked->source.isStreaming() && ! linked->source.isRejected())
+            return false;
+
+    return true;
+}
+
+//==============================================================================
+void MultiDevicePlayer::setChannelRouting (const ChannelRouting& newRouting)
+{
+    {
+        const ScopedLock routingScopedLock (routingLock);
+        routing = newRouting;
+    }
+
+    // Every device maps its channels when it's prepared
+    mainSource.requestAudioDeviceReset();
+
+    for (auto* linked : linkedDevices)
+        linked->source.requestAudioDeviceReset();
+}
+
+ChannelRouting MultiDevicePlayer::getChannelRouting() const
+{
+    const ScopedLock routingScopedLock (routingLock);
+    return routing;
+}
+
+int MultiDevicePlayer::getNumSourceChannels() const
+{
+    const ScopedLock routingScopedLock (routingLock);
+    return routing.getNumSourceChannels();
+}
+
+Array<int> MultiDevicePlayer::getSharedChannels() const
+{
+    auto sharedChannels = routing.getLinkedSourceChannels (linkedDevices.size());
+
+    // The Linked devices keep streaming even if they play nothing
+    if (sharedChannels.isEmpty())
+        sharedChannels.add (0);
+
+    return sharedChannels;
+}
+
+//==============================================================================
+void MultiDevicePlayer::applyCrossover (CrossoverFilter& filter, bool& wasEnabled,
+                                        StageProfiler& profiler,
+                                        const AudioSourceChannelInfo& info) const
+{
+    const bool isEnabled = crossoverEnabled.load();
+
+    if (isEnabled != wasEnabled)
+    {
+        filter.reset();
+        wasEnabled = isEnabled;
+    }
+
+    if (! isEnabled)
+        return;
+
+    const StageProfiler::ScopedTimer crossoverTimer (profiler, StageProfiler::crossover);
+    filter.process (info, crossoverFrequency.load());
+}
+
+//==============================================================================
+float MultiDevicePlayer::getMainDelayInMs() const
+{
+    float mainDelay = 0.0f;
+
+    for (auto* linked : linkedDevices)
+        mainDelay = jmax (mainDelay, linked->source.getLatency());
+
+    return mainDelay;
+}
+
+//==============================================================================
+MultiDevicePlayer::PushAudioSource::
+    PushAudioSource (MultiDevicePlayer& mdp, double maxLatencyInMs)
+        : owner (mdp), maxLatencyDelayInMs (maxLatencyInMs)
+{
+    //==========================================================================
+    // Check that atomic float is lock-free
+    static_assert (std::atomic<bool>::is_always_lock_free,
+                   "std::atomic for type bool must be always lock free");
+}
+
+void MultiDevicePlayer::PushAudioSource::
+        prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    // The device was running if it's prepared again for a reset, so the
+    //  source is faded in rather than cut in
+    fadeInNextBlock = needsAudioDeviceReset.exchange (false);
+
+    statistics.reset (sampleRate, samplesPerBlockExpected);
+    profiler.reset (sampleRate, samplesPerBlockExpected);
+    clock.reset (sampleRate);
+    nextPushTime.store (0);
+
+    auto* device = owner.mainSourcePlayer.getDevice();
+    const int numOutputChannels = device->getActiveOutputChannels().countNumberOfSetBits();
+    deviceOutputLatency = device->getOutputLatencyInSamples();
+
+    // The source renders all of its channels, straight into the outputs that
+    //  play them where possible
+    {
+        const ScopedLock routingScopedLock (owner.routingLock);
+
+        Array<int> sourceChannels;
+
+        for (int channel = 0; channel < owner.routing.getNumSourceChannels(); ++channel)
+            sourceChannels.add (channel);
+
+        outputMap.prepare (owner.routing, 0, sourceChannels, samplesPerBlockExpected);
+        sharedChannels = owner.getSharedChannels();
+    }
+
+    renderAheadEnabled = renderAheadTime.load() > 0.0;
+
+    if (renderAheadEnabled)
+    {
+        // The producer thread renders the source, and the callback only
+        //  copies it, so the source stage is timed on the producer thread
+        renderAhead.setSource (source);
+        renderAhead.setNumChannels (outputMap.getNumRenderedChannels());
+        renderAhead.setRenderAheadTime (renderAheadTime.load());
+        renderAhead.setProfiler (&profiler, StageProfiler::source);
+        renderAhead.prepareToPlay (samplesPerBlockExpected, sampleRate);
+    }
+    else if (source != nullptr)
+    {
+        source->prepareToPlay (samplesPerBlockExpected, sampleRate);
+    }
+
+    {
+        const ScopedLock resizeLock (owner.resizeMutex);
+
+        numChannels = numOutputChannels;
+        nominalSampleRate.store (sampleRate);
+        blockSize = samplesPerBlockExpected;
+
+        prepareLatencyCompensation();
+        crossover.prepare (numChannels, sampleRate);
+
+        // The adaptive sizing measures the jitter of the new configuration
+        //  again, starting from the default depth
+        owner.adaptiveBufferDepth.store (0);
+        owner.bufferSizerNeedsReset.store (true);
+
+        // NB! Linked device picks up the new sample rate on its own, but pop
+        //     block size depends on it, so the sample rate must be stored
+        //     before resizing the shared buffer.
+        owner.resizeSharedBuffer (sharedChannels.size());
+
+        // The Main device restarts at the new depth, and the Linked devices
+        //  realign to it. Rejected devices are prepared again, since the
+        //  depth now fits their blocks
+        skipFixedDelayRamp();
+        prepared = true;
+
+        for (auto* linked : owner.linkedDevices)
+        {
+            linked->source.haltUntilAligned();
+
+            if (linked->source.isRejected())
+                linked->source.requestAudioDeviceReset();
+        }
+    }
+}
+
+void MultiDevicePlayer::PushAudioSource::
+        getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    const auto callbackTime = owner.mainSourcePlayer.getCallbackTime();
+
+    AudioProcessLoadMeasurer::ScopedTimer loadTimer (statistics.loadMeasurer,
+                                                     bufferToFill.numSamples);
+    const StageProfiler::ScopedTimer callbackTimer (profiler, StageProfiler::callback);
+
+    // The device was prepared at this rate. A rate changed underneath the
+    //  running device is caught when its manager broadcasts the change
+    owner.trace.record (0, callbackTime, bufferToFill.numSamples, getSampleRate());
+
+    // Move the applied delay towards a new depth, by little enough that the
+    //  Linked devices follow it with their drift correction
+    auto currentFixedDelay = static_cast<double> (fixedDelay.load());
+    const double appliedDelay = appliedFixedDelay.load();
+    const double maxStep = fixedDelaySlewRate * bufferToFill.numSamples;
+
+    if (owner.driftCorrectionEnabled.load() && std::abs (currentFixedDelay - appliedDelay) > maxStep)
+        currentFixedDelay = appliedDelay + (currentFixedDelay > appliedDelay ? maxStep : -maxStep);
+
+    appliedFixedDelay.store (currentFixedDelay);
+
+    // The rendered block leaves the device after the latency compensation
+    //  delay and the output latency of the device
+    const int delayInSamples = roundToInt (getSampleRate() * 0.001 * owner.getMainDelayInMs())
+                             + roundToInt (currentFixedDelay);
+    const int outputLatencyInSamples = delayInSamples + deviceOutputLatency;
+
+    const auto blockTime = clock.update (callbackTime, bufferToFill.numSamples);
+
+    blockOutputTime.store (blockTime + clock.samplesToTicks (outputLatencyInSamples),
+                           std::memory_order_relaxed);
+
+    // Process audio and push it to the shared buffer
+    auto& sourceBuffer = outputMap.mapOutputs (bufferToFill);
+    const AudioSourceChannelInfo sourceInfo (&sourceBuffer, 0, bufferToFill.numSamples);
+
+    if (renderAheadEnabled)
+    {
+        // Samples rendered ahead are also delayed by the time they spend
+        //  in the render-ahead buffer
+        outputLatency.store ((outputLatencyInSamples + renderAhead.getLatencyInSamples())
+                             / getSampleRate());
+
+        const StageProfiler::ScopedTimer popTimer (profiler, StageProfiler::pop);
+
+        renderAhead.setNextBlockOutputTime (blockOutputTime.load (std::memory_order_relaxed));
+        renderAhead.getNextAudioBlock (sourceInfo);
+    }
+    else
+    {
+        outputLatency.store (outputLatencyInSamples / getSampleRate());
+
+        const StageProfiler::ScopedTimer sourceTimer (profiler, StageProfiler::source);
+
+        if (source != nullptr)
+            source->getNextAudioBlock (sourceInfo);
+        else
+            sourceInfo.clearActiveBufferRegion();
+    }
+
+    if (fadeInNextBlock)
+    {
+        // Fades both the Main device outputs and the shared buffer
+        sourceBuffer.applyGainRamp (0, bufferToFill.numSamples, 0.0f, 1.0f);
+        fadeInNextBlock = false;
+    }
+
+    // Only the channels that the Linked devices play go to the shared buffer
+    for (int i = 0; i < sharedChannels.size(); ++i)
+        sharedChannelData[static_cast<size_t> (i)] = sourceBuffer.getWritePointer (sharedChannels.getUnchecked (i));
+
+    sharedView.setDataToReferTo (sharedChannelData.data(), sharedChannels.size(),
+                                 bufferToFill.numSamples);
+    const AudioSourceChannelInfo sharedInfo (&sharedView, 0, bufferToFill.numSamples);
+
+    // Push audio to the shared buffer. The Linked devices read the push
+    //  timing together with the fill level, so it's marked as in progress
+    {
+        const StageProfiler::ScopedTimer pushTimer (profiler, StageProfiler::push);
+
+        const auto sequence = pushTimingSequence.load (std::memory_order_relaxed);
+        pushTimingSequence.store (sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
+
+        int numPushed = 0;
+        const int freeSpace = owner.sharedBuffer.getFreeSpace();
+        const int sharedBufferSize = owner.sharedBuffer.getTotalSize();
+        const int minFreeSpace = static_cast<int> (1.2f * blockSize);
+
+        if (waitForBufferSpace)
+        {
+            if (freeSpace >= sharedBufferSize / 2)
+            {
+                // Push and fade in
+                statistics.addTransfer (sharedBufferSize - freeSpace);
+                statistics.addFadeIn();
+                numPushed = owner.sharedBuffer.pushWithRamp (sharedInfo, 0.0f, 1.0f);
+                waitForBufferSpace = false;
+            }
+            else
+            {
+                // Drop the block
+                statistics.addWait (sharedBufferSize - freeSpace);
+            }
+        }
+        else
+        {
+            statistics.addTransfer (sharedBufferSize - freeSpace);
+
+            if (freeSpace >= minFreeSpace)
+            {
+                // Push
+                numPushed = owner.sharedBuffer.push (sharedInfo);
+            }
+            else
+            {
+                // Push and fade out
+                statistics.addOverflow();
+                statistics.addFadeOut();
+                numPushed = owner.sharedBuffer.pushWithRamp (sharedInfo, 1.0f, 0.0f);
+                waitForBufferSpace = true;
+            }
+        }
+
+        // The next pushed sample is processed one block later
+        nextPushTime.store (numPushed > 0 ? blockTime + clock.samplesToTicks (numPushed) : 0,
+                            std::memory_order_relaxed);
+        pushTimingSequence.store (sequence + 2, std::memory_order_release);
+    }
+
+    // Play the source channels on the Main device outputs
+    outputMap.fillOutputs (bufferToFill);
+
+    // The shared buffer gets the full range signal, and the Main device
+    //  keeps the high-passed side of the crossover
+    owner.applyCrossover (crossover, crossoverWasEnabled, profiler, bufferToFill);
+
+    // Delay audio for latency compensation
+    const StageProfiler::ScopedTimer delayTimer (profiler, StageProfiler::delay);
+
+    delay.setDelay (delayInSamples);
+    delay.getNextAudioBlock (bufferToFill);
+}
+
+void MultiDevicePlayer::PushAudioSource::releaseResources()
+{
+    {
+        const ScopedLock resizeLock (owner.resizeMutex);
+        prepared = false;
+    }
+
+    if (renderAheadEnabled)
+        renderAhead.releaseResources();
+    else if (source != nullptr)
+        source->releaseResources();
+
+    delay.releaseResources();
+}
+
+void MultiDevicePlayer::PushAudioSource::prepareLatencyCompensation()
+{
+    // Leave room for the largest shared buffer the Linked device can request
+    maxFixedDelay = jmax (sharedBufferSizeInBlocks / 2 * jmax (blockSize,
+                                                                maxExpectedPopBlockSize),
+                          fixedDelay.load());
+
+    const double sampleRate = getSampleRate();
+    const int maxDelayInSamples
+    = roundToInt (sampleRate * 0.001 * maxLatencyDelayInMs) + maxFixedDelay;
+    delay.setDelayBufferSize (numChannels, maxDelayInSamples);
+    delay.prepareToPlay (blockSize, sampleRate);
+}
+
+bool MultiDevicePlayer::PushAudioSource::setFixedDelay (int newFixedDelay)
+{
+    fixedDelay.store (newFixedDelay);
+    return newFixedDelay <= maxFixedDelay;
+}
+
+void MultiDevicePlayer::PushAudioSource::requestAudioDeviceReset()
+{
+    needsAudioDeviceReset.store (true);
+    owner.notify();
+}
+
+void MultiDevicePlayer::PushAudioSource::setRenderAheadTime (double renderAheadInMs)
+{
+    const auto newRenderAheadTime = jmax (0.0, renderAheadInMs);
+
+    if (renderAheadTime.exchange (newRenderAheadTime) != newRenderAheadTime)
+        requestAudioDeviceReset();
+}
+
+//==============================================================================
+MultiDevicePlayer::PopAudioSource::
+    PopAudioSource (MultiDevicePlayer& mdp, const DeviceSourcePlayer& player,
+                    int sharedBufferReader, double maxLatencyInMs)
+        : owner (mdp), sourcePlayer (player), reader (sharedBufferReader),
+          maxLatencyDelayInMs (maxLatencyInMs),
+          sharedBufferSource (mdp.sharedBuffer, sharedBufferReader)
+{
+    //==========================================================================
+    // Check that atomic float is lock-free
+    static_assert (std::atomic<bool>::is_always_lock_free,
+                   "std::atomic for type bool must be always lock free");
+}
+
+void MultiDevicePlayer::PopAudioSource::
+        prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    needsAudioDeviceReset.store (false);
+    statistics.reset (sampleRate, samplesPerBlockExpected);
+    profiler.reset (sampleRate, samplesPerBlockExpected);
+
+    // Fade in from the shared buffer, also when the device was prepared
+    //  again while it was running
+    waitForBufferToFill = true;
+    streaming.store (false);
+    alignmentError.store (0.0f);
+    clock.reset (sampleRate);
+
+    const int numChannels = sourcePlayer.getDevice()->getActiveOutputChannels().countNumberOfSetBits();
+
+    // Another Linked device can delay the Main device by the max latency, while
+    //  this one is ahead of the Main device by the max latency
+    delay.setDelayBufferSize (numChannels,
+                              roundToInt (sampleRate * 0.001 * 2.0 * maxLatencyDelayInMs));
+    delay.prepareToPlay (samplesPerBlockExpected, sampleRate);
+    crossover.prepare (numChannels, sampleRate);
+
+    // The shared buffer only carries the source channels the Linked devices play
+    {
+        const ScopedLock routingScopedLock (owner.routingLock);
+        outputMap.prepare (owner.routing, reader + 1, owner.getSharedChannels(),
+                           samplesPerBlockExpected);
+    }
+
+    {
+        const ScopedLock resizeLock (owner.resizeMutex);
+
+        nominalSampleRate = sampleRate;
+        blockSize = samplesPerBlockExpected;
+
+        resampler = std::make_unique<PolyphaseResamplingAudioSource> (&sharedBufferSource,
+                                                                      outputMap.getNumRenderedChannels());
+        resampler->setQuality (owner.resamplingQuality.load());
+
+        // NB! Always update the resampling ratio before resizing the shared
+        //     buffer because pop block size depends on the ratio.
+        initialiseResampling();
+
+        // A device swapped in while the Main device plays keeps the depth
+        //  and the storage of the shared buffer, so the Main device and the
+        //  other Linked devices play on undisturbed. It's rejected if the
+        //  depth doesn't cover its pop block
+        if (owner.mainSource.isPrepared())
+        {
+            const int depth = jmin (owner.mainSource.getFixedDelay(),
+                                    roundToInt (owner.mainSource.getAppliedFixedDelay()));
+
+            rejected.store (SharedBufferSizer::getRequiredDepth (popBlockSize, 0.0) > depth);
+        }
+        else
+        {
+            rejected.store (false);
+            owner.resizeSharedBuffer (-1, false);
+        }
+
+        // A rejected reader must not hold back the Main device
+        if (rejected.load())
+            sharedBufferSource.releaseResources();
+    }
+}
+
+void MultiDevicePlayer::PopAudioSource::
+        getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    const auto callbackTime = sourcePlayer.getCallbackTime();
+
+    AudioProcessLoadMeasurer::ScopedTimer loadTimer (statistics.loadMeasurer,
+                                                     bufferToFill.numSamples);
+    const StageProfiler::ScopedTimer callbackTimer (profiler, StageProfiler::callback);
+
+    // The device rate is checked when its manager changes, see the Main device
+    owner.trace.record (reader + 1, callbackTime, bufferToFill.numSamples, nominalSampleRate);
+
+    if (rejected.load())
+    {
+        bufferToFill.clearActiveBufferRegion();
+        return;
+    }
+
+    // Check that the resampler can follow the current Main device sample rate
+    if (! updateInputSampleRate())
+    {
+        bufferToFill.clearActiveBufferRegion();
+
+        if (! needsAudioDeviceReset.load())
+            requestAudioDeviceReset();
+
+        return;
+    }
+
+    const bool isHalting = haltRequested.exchange (false);
+
+    const auto blockTime = clock.update (callbackTime, bufferToFill.numSamples);
+
+    // The shared buffer channels are resampled straight into the outputs
+    //  that play them where possible
+    auto& sharedChannelBuffer = outputMap.mapOutputs (bufferToFill);
+    const AudioSourceChannelInfo sharedInfo (&sharedChannelBuffer, 0, bufferToFill.numSamples);
+
+    // Pop audio from the shared buffer
+    {
+        auto& mainSource = owner.mainSource;
+
+        int numReady = 0;
+        int64 nextPushTime = 0;
+
+        const bool isTimingValid = mainSource.readPushTiming (nextPushTime, [&]
+        {
+            numReady = owner.sharedBuffer.getNumReady (reader);
+        });
+
+        const int minNumReady = static_cast<int> (1.2f * popBlockSize);
+
+        // Measure how far this device plays behind the Main device, in Main
+        //  device samples. Samples in the shared buffer and in the resampler
+        //  are still to be played, while the Main device has moved on since
+        //  it last pushed. The Main device is delayed by the fixed delay
+        //  to compensate for it, which moves gradually to a new depth
+        const double lag = numReady + resampler->getNumBufferedInputSamples()
+                         - mainSource.ticksToSamples (nextPushTime - blockTime);
+        const double targetLag = mainSource.getAppliedFixedDelay();
+
+        if (waitForBufferToFill)
+        {
+            const bool canStart = isTimingValid ? (numReady >= minNumReady && lag >= targetLag)
+                                                : numReady >= targetLag;
+
+            if (canStart)
+            {
+                // Pop and fade in, starting where the lag matches the delay
+                //  of the Main device
+                statistics.addTransfer (numReady);
+                statistics.addFadeIn();
+
+                if (isTimingValid)
+                {
+                    // Whole samples beyond the delay, such as after the Main
+                    //  device was prepared at a smaller depth, are dropped from the
+                    //  shared buffer, and the rest is skipped by the resampler
+                    const int numDiscarded = owner.sharedBuffer.discard (reader,
+                        jmin (numReady - minNumReady, static_cast<int> (lag - targetLag)));
+
+                    resampler->skipInput (lag - numDiscarded - targetLag);
+                    driftCorrector.restart (targetLag);
+                }
+                else
+                {
+                    driftCorrector.restart (numReady);
+                }
+
+                sharedBufferSource.setGainRamp (0.0f, 1.0f);
+                resampleSharedBuffer (sharedInfo);
+                waitForBufferToFill = false;
+            }
+            else
+            {
+                // Clear buffer
+                statistics.addWait (numReady);
+                sharedInfo.clearActiveBufferRegion();
+            }
+        }
+        else
+        {
+            statistics.addTransfer (numReady);
+
+            if (numReady >= minNumReady && ! isHalting)
+            {
+                // Pop
+                if (isTimingValid)
+                    correctDrift (lag, targetLag);
+                sharedBufferSource.setGainRamp (1.0f, 1.0f);
+                resampleSharedBuffer (sharedInfo);
+            }
+            else
+            {
+                // Pop and fade out, on an underrun or when asked to realign
+                if (! isHalting)
+                    statistics.addUnderrun();
+
+                statistics.addFadeOut();
+                sharedBufferSource.setGainRamp (1.0f, 0.0f);
+                resampleSharedBuffer (sharedInfo);
+                waitForBufferToFill = true;
+            }
+        }
+
+        streaming.store (! waitForBufferToFill);
+    }
+
+    // Play the shared buffer channels on the outputs of this device
+    outputMap.fillOutputs (bufferToFill);
+
+    // Low-passed side of the crossover
+    owner.applyCrossover (crossover, crossoverWasEnabled, profiler, bufferToFill);
+
+    // Delay audio for latency compensation, relative to the delayed Main device
+    const StageProfiler::ScopedTimer delayTimer (profiler, StageProfiler::delay);
+    const float delayInMs = owner.getMainDelayInMs() - latency.load();
+
+    delay.setDelay (roundToInt (nominalSampleRate * 0.001 * delayInMs));
+
+    delay.getNextAudioBlock (bufferToFill);
+}
+
+void MultiDevicePlayer::PopAudioSource::releaseResources()
+{
+    delay.releaseResources();
+
+    if (resampler != nullptr)
+    {
+        resampler->releaseResources();
+        resampler.reset();
+    }
+}
+
+void MultiDevicePlayer::PopAudioSource::requestAudioDeviceReset()
+{
+    needsAudioDeviceReset.store (true);
+    owner.notify();
+}
+
+int MultiDevicePlayer::PopAudioSource::getPopBlockSize() const
+{
+    const double maxResamplingRatio = owner.mainSource.getSampleRate() / nominalSampleRate
+                                    * (1.0 + DriftCorrector::maxCorrection);
+
+    // Max block size that can be requested by the resampler:
+    return roundToInt (blockSize * maxResamplingRatio) + 3;
+}
+
+void MultiDevicePlayer::PopAudioSource::initialiseResampling()
+{
+    inputSampleRate = owner.mainSource.getSampleRate();
+    const double resamplingRatio = inputSampleRate / nominalSampleRate;
+
+    driftCorrector.prepare (resamplingRatio, inputSampleRate,
+                            blockSize / nominalSampleRate);
+
+    maxPreparedRatio = driftCorrector.getMaxRatio();
+    popBlockSize = getPopBlockSize();
+
+    // The resampler allocates its buffers for the largest ratio that drift
+    //  correction can request, then follows the actual ratio without allocating
+    resampler->setMaxResamplingRatio (maxPreparedRatio);
+    resampler->prepareToPlay (blockSize, nominalSampleRate);
+    resampler->setResamplingRatio (resamplingRatio);
+}
+
+void MultiDevicePlayer::PopAudioSource::
+        resampleSharedBuffer (const AudioSourceChannelInfo& bufferToFill)
+{
+    const auto startTicks = Time::getHighResolutionTicks();
+
+    resampler->getNextAudioBlock (bufferToFill);
+
+    // The resampler pulls from the shared buffer, so the pop time is taken out
+    const auto popTicks = sharedBufferSource.takePopTicks();
+
+    profiler.addTime (StageProfiler::pop, popTicks);
+    profiler.addTime (StageProfiler::resample,
+                      Time::getHighResolutionTicks() - startTicks - popTicks);
+}
+
+bool MultiDevicePlayer::PopAudioSource::updateInputSampleRate()
+{
+    const double newInputSampleRate = owner.mainSource.getSampleRate();
+
+    if (newInputSampleRate == inputSampleRate)
+        return true;
+
+    const double resamplingRatio = newInputSampleRate / nominalSampleRate;
+
+    if (resamplingRatio * (1.0 + DriftCorrector::maxCorrection) > maxPreparedRatio)
+        return false;
+
+    // The new ratio fits into the resampling buffers, so no reallocation is needed
+    inputSampleRate = newInputSampleRate;
+    driftCorrector.prepare (resamplingRatio, inputSampleRate,
+                            blockSize / nominalSampleRate);
+    popBlockSize = roundToInt (blockSize * driftCorrector.getMaxRatio()) + 3;
+    resampler->setResamplingRatio (resamplingRatio);
+
+    return true;
+}
+
+void MultiDevicePlayer::PopAudioSource::
+        correctDrift (double lag, double targetLag)
+{
+    driftCorrector.addMeasurement (lag);
+    alignmentError.store (static_cast<float> (targetLag - driftCorrector.getSmoothedFillLevel()));
+
+    if (! owner.driftCorrectionEnabled.load())
+    {
+        resampler->setResamplingRatio (driftCorrector.getNominalRatio());
+        return;
+    }
+
+    // Hold the lag at the delay of the Main device
+    resampler->setResamplingRatio (driftCorrector.getNextRatio (targetLag));
+
+    estimatedDriftInPpm.store (static_cast<float> (driftCorrector.getDriftInPpm()));
+}
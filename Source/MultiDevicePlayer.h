@@ -1,214 +1,1040 @@
-/*
-  ==============================================================================
-
-    MultiDevicePlayer.h
-    Created: 19 Sep 2022 7:51:03pm
-    Author:  Anthony Alfimov
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-#include "AudioFifo.h"
-#include "AudioFifoSource.h"
-#include "DelayAudioSource.h"
-
-class MultiDevicePlayer  : private Timer
-{
-public:
-    explicit MultiDevicePlayer (double maxLatencyInMs);
-
-    //==========================================================================
-    void initialiseAudio (AudioSource* src, int numOutputChannels);
-    void shutdownAudio();
-
-    //==========================================================================
-    /** [Realtime] [Thread-safe]
-     Sets the atomic latency compensation value. Latency between Main and Linked
-     devices is defined in milliseconds.
-
-     If latency parameter is positive, the Main device will be delayed by
-     the given amount of milliseconds.
-
-     If latency parameter is negative, the Linked device will be delayed
-     by an absolute value of the given time in milliseconds.
-    */
-    void setLatency (float newLatencyInMs) { latency.store (newLatencyInMs); }
-
-    /** [Realtime] [Thread-safe]
-     Sets main device playback gain atomic value.
-    */
-    void setMainGain (float newGain) { mainSourcePlayer.setGain (newGain); }
-
-    /** [Realtime] [Thread-safe]
-     Sets linked device playback gain atomic value.
-    */
-    void setLinkedGain (float newGain) { linkedSourcePlayer.setGain (newGain); }
-
-    //==========================================================================
-    // Device managers
-    AudioDeviceManager mainDeviceManager;
-    AudioDeviceManager linkedDeviceManager;
-
-private:
-    // Latency compensation
-    std::atomic<float> latency { 0.0f };    // [ms]
-
-    //==========================================================================
-    // Shared audio buffer facilities
-    AudioFifo sharedBuffer;
-    SpinLock popMutex;
-    SpinLock pushMutex;
-    SpinLock resizeMutex;
-
-    /** [Non-realtime] [Non-thread-safe]
-        Checks whether sharedBuffer size needs to be changed and resizes it
-        if necessary.
-
-        @param numChannels  pass the new number of channels required,
-                            or -1 to keep the channel count unchanged.
-    */
-    void resizeSharedBuffer (int numChannels = -1);
-
-    //==========================================================================
-    // Audio device management
-    /** AudioDeviceManager is not always notified when the device sample rate
-        is changed. When a discrepancy like this is detected, this function
-        should be used to update AudioDeviceManager to the factual sample rate.
-    */
-    void resetAudioDevice (AudioDeviceManager& manager);
-    void timerCallback() override;
-
-    //==========================================================================
-    // Objects for streaming audio from an audio source to managed devices
-    AudioSourcePlayer mainSourcePlayer;
-    AudioSourcePlayer linkedSourcePlayer;
-
-    //==========================================================================
-    // Audio sources for managed devices
-    class PushAudioSource  : public AudioSource
-    {
-    public:
-        PushAudioSource (MultiDevicePlayer& mdp, double maxLatencyInMs);
-
-        //======================================================================
-        /** [Realtime] [Non-tread-safe]
-            ...
-        */
-        void setSource (AudioSource* src) { source = src; }
-
-        //======================================================================
-        void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
-        void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
-        void releaseResources() override;
-
-        //======================================================================
-        double getSampleRate() const { return nominalSampleRate; }
-        int getPushBlockSize() const { return blockSize; }
-
-        //======================================================================
-        /** [Non-realtime] [Non-tread-safe]
-            Initialise the internal delay buffer for latency compensation.
-
-            Make sure this method is called only after the members
-            `blockSize`, `numChannels`, and `nominalSampleRate` have been set.
-        */
-        void prepareLatencyCompensation (int sharedBufferSize);
-
-        /** Atomic flag that is set when the actual device settings do not
-            match its AudioDeviceManager settings
-        */
-        std::atomic<bool> needsAudioDeviceReset = false;
-
-    private:
-        MultiDevicePlayer& owner;
-        DelayAudioSource delay;
-        const double maxLatencyDelayInMs;
-
-        /*  Linked device will wait until half of the shared buffer is filled
-            before starting playback. Therefore, main device will be ahead of
-            the linked device by half the shared buffer size on average.
-            The `fixedDelay` value is added to compensate for this latency.
-        */
-        int fixedDelay = 0;
-
-        //======================================================================
-        AudioSource* source = nullptr;
-
-        bool waitForBufferSpace = false;
-
-        //======================================================================
-        int numChannels = 2;
-        double nominalSampleRate = 44100.0;
-        int blockSize = 32;
-
-        //======================================================================
-        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PushAudioSource)
-    };
-
-    class PopAudioSource  : public AudioSource
-    {
-    public:
-        PopAudioSource (MultiDevicePlayer& mdp, double maxLatencyInMs);
-
-        //======================================================================
-        void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
-        void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
-        void releaseResources() override;
-
-        //======================================================================
-        double getSampleRate() const { return nominalSampleRate; }
-        int getPopBlockSize() const { return popBlockSize; }
-
-        //======================================================================
-        /** [Non-realtime] [Non-tread-safe]
-            Recalculate and set the resampling ratio.
-        */
-        void updateResamplingRatio();
-
-        /** [Realtime] [Non-tread-safe]
-            Indicated that popping from the shared buffer should be halted
-            until the buffer is half-filled.
-        */
-        void haltUntilBufferIsHalfFilled() { waitForBufferToFill = true; }
-
-        /** Atomic flag that is set when the actual device settings do not
-            match its AudioDeviceManager settings
-        */
-        std::atomic<bool> needsAudioDeviceReset = false;
-
-    private:
-        MultiDevicePlayer& owner;
-        DelayAudioSource delay;
-        const double maxLatencyDelayInMs;
-
-        //======================================================================
-        bool waitForBufferToFill = true;
-
-        //======================================================================
-        double nominalSampleRate = 44100.0;
-        int blockSize = 32;
-        int popBlockSize = 32;
-
-        //======================================================================
-        AudioFifoSource sharedBufferSource { owner.sharedBuffer };
-        std::unique_ptr<ResamplingAudioSource> resampler;
-
-        void initialiseResampling();
-
-        //======================================================================
-        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PopAudioSource)
-    };
-
-    friend class PushAudioSource;
-    friend class PopAudioSource;
-
-    //==========================================================================
-    PushAudioSource mainSource;
-    PopAudioSource linkedSource;
-
-    //==========================================================================
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MultiDevicePlayer)
-};
+/*
+  ==============================================================================
+
+    MultiDevicePlayer.h
+    Created: 19 Sep 2022 7:51:03pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AudioFifo.h"
+#include "AudioFifoSource.h"
+#include "CallbackClock.h"
+#include "CallbackTrace.h"
+#include "ChannelRouting.h"
+#include "CrossoverFilter.h"
+#include "DelayAudioSource.h"
+#include "DriftCorrector.h"
+#include "PolyphaseResamplingAudioSource.h"
+#include "RenderAheadAudioSource.h"
+#include "SharedBufferSizer.h"
+#include "StageProfiler.h"
+
+/**
+    Plays one audio source on a Main device and up to `maxNumLinkedDevices`
+    Linked devices at the same time.
+
+    The Main device renders the source and pushes every block once to a shared
+    broadcast buffer. Each Linked device pops from the buffer through its own
+    read cursor and has its own resampler, drift correction, gain and latency
+    compensation, so an extra device only costs its own pop and resampling work.
+
+    Optionally, the source is rendered ahead on a producer thread instead of
+    the Main device callback, which then only copies the rendered samples.
+
+    The source can have more channels than a device. A ChannelRouting maps
+    each source channel to any output channels of any device, and the shared
+    buffer only carries the source channels that the Linked devices play.
+*/
+class MultiDevicePlayer  : private AsyncUpdater,
+                           private ChangeListener,
+                           private Timer,
+                           private Thread
+{
+public:
+    MultiDevicePlayer (double maxLatencyInMs, int numLinkedDevices = 1);
+    ~MultiDevicePlayer() override;
+
+    //==========================================================================
+    void initialiseAudio (AudioSource* src, int numOutputChannels);
+    void shutdownAudio();
+
+    //==========================================================================
+    /** Returns the number of Linked devices. */
+    int getNumLinkedDevices() const { return linkedDevices.size(); }
+
+    /** Returns the device manager of a Linked device. */
+    AudioDeviceManager& getLinkedDeviceManager (int linkedDeviceIndex)
+    {
+        return linkedDevices[linkedDeviceIndex]->deviceManager;
+    }
+
+    //==========================================================================
+    /** [Realtime] [Thread-safe]
+     Sets the atomic latency compensation value of a Linked device. Latency
+     between Main and Linked devices is defined in milliseconds.
+
+     If latency parameter is positive, the Main device will be delayed by
+     the given amount of milliseconds relative to the Linked device.
+
+     If latency parameter is negative, the Linked device will be delayed
+     by an absolute value of the given time in milliseconds relative to
+     the Main device.
+
+     With several Linked devices, the Main device is delayed by the largest
+     positive latency, and every Linked device is delayed by the remainder.
+    */
+    void setLatency (int linkedDeviceIndex, float newLatencyInMs)
+    {
+        linkedDevices[linkedDeviceIndex]->source.setLatency (newLatencyInMs);
+    }
+
+    /** [Realtime] [Thread-safe]
+     Returns the latency compensation value of a Linked device.
+    */
+    float getLatency (int linkedDeviceIndex) const
+    {
+        return linkedDevices[linkedDeviceIndex]->source.getLatency();
+    }
+
+    /** [Realtime] [Thread-safe]
+     Sets main device playback gain atomic value.
+    */
+    void setMainGain (float newGain) { mainSourcePlayer.setGain (newGain); }
+    float getMainGain() const { return mainSourcePlayer.getGain(); }
+
+    /** [Realtime] [Thread-safe]
+     Sets linked device playback gain atomic value.
+    */
+    void setLinkedGain (int linkedDeviceIndex, float newGain)
+    {
+        linkedDevices[linkedDeviceIndex]->sourcePlayer.setGain (newGain);
+    }
+
+    float getLinkedGain (int linkedDeviceIndex) const
+    {
+        return linkedDevices[linkedDeviceIndex]->sourcePlayer.getGain();
+    }
+
+    //==========================================================================
+    /** [Realtime] [Thread-safe]
+        Enables or disables the closed-loop drift correction.
+
+        When enabled, the resampling ratio of each Linked device is continuously
+        adjusted from the measured shared buffer fill level, so that the buffer
+        stays at its target occupancy despite the clock drift between devices.
+        When disabled, the ratio is fixed by the nominal sample rates.
+    */
+    void setDriftCorrectionEnabled (bool shouldBeEnabled)
+    {
+        driftCorrectionEnabled.store (shouldBeEnabled);
+    }
+
+    /** [Realtime] [Thread-safe]
+        Returns true if the closed-loop drift correction is enabled.
+    */
+    bool isDriftCorrectionEnabled() const { return driftCorrectionEnabled.load(); }
+
+    /** [Non-realtime] [Thread-safe]
+        Sets the resampler quality of the Linked devices. Longer kernels
+        attenuate aliasing better at a higher CPU cost. Applies when the
+        devices are prepared again.
+    */
+    void setResamplingQuality (PolyphaseResamplingAudioSource::Quality newQuality)
+    {
+        resamplingQuality.store (newQuality);
+    }
+
+    PolyphaseResamplingAudioSource::Quality getResamplingQuality() const
+    {
+        return resamplingQuality.load();
+    }
+
+    /** [Non-realtime] [Message thread only]
+        Enables or disables the adaptive depth of the shared buffer.
+
+        When enabled, the depth the Linked devices keep the shared buffer at,
+        and with it the delay of the Main device, follows the measured callback
+        jitter of the devices and their underruns. See SharedBufferSizer.
+        When disabled, the depth is the default of three blocks.
+
+        The Main device delay moves to a new depth gradually, and the drift
+        correction of the Linked devices follows it, so they keep playing.
+        With the drift correction disabled, a new depth applies at once and
+        the Linked devices fade out and back in at it.
+    */
+    void setAdaptiveBufferSizingEnabled (bool shouldBeEnabled);
+    bool isAdaptiveBufferSizingEnabled() const { return isTimerRunning(); }
+
+    /** [Non-realtime] [Message thread only]
+        Sets the number of Linked device underruns per minute that the
+        adaptive sizing tolerates.
+    */
+    void setMaxUnderrunRate (double underrunsPerMinute) { bufferSizer.setMaxUnderrunRate (underrunsPerMinute); }
+    double getMaxUnderrunRate() const { return bufferSizer.getMaxUnderrunRate(); }
+
+    /** [Non-realtime] [Message thread only]
+        Updates the adaptive sizing and applies a new depth. A timer calls it
+        while the adaptive sizing is enabled. An app that doesn't run the
+        message loop must call it every `bufferSizingIntervalInMs` itself.
+    */
+    void updateAdaptiveBufferSizing();
+
+    /** [Non-realtime] [Message thread only]
+        Prepares the devices that asked for it again. The service thread
+        triggers it on the message thread as soon as a device asks. An app
+        that doesn't run the message loop must call it every
+        `deviceServiceIntervalInMs` itself.
+    */
+    void serviceDeviceResets();
+
+    /** [Non-realtime] [Thread-safe]
+        Renders the source on a high priority producer thread, the given time
+        ahead of the Main device, which then only plays the rendered samples.
+        A longer time absorbs longer render time spikes of the source, at
+        the cost of as much extra output latency. Zero renders the source in
+        the Main device callback. Applies when the Main device is prepared
+        again, which happens shortly after the call.
+    */
+    void setRenderAheadTime (double renderAheadInMs)
+    {
+        mainSource.setRenderAheadTime (renderAheadInMs);
+    }
+
+    double getRenderAheadTime() const { return mainSource.getRenderAheadTime(); }
+
+    /** [Realtime] [Thread-safe]
+        Returns the number of Main device blocks that found the rendered
+        samples running short, since the device was prepared.
+    */
+    int getRenderAheadUnderruns() const { return mainSource.getRenderAheadUnderruns(); }
+
+    //==========================================================================
+    /** [Non-realtime] [Thread-safe]
+        Sets the number of source channels, and the source channel that each
+        output channel of each device plays. Applies when the devices are
+        prepared again, which happens shortly after the call.
+    */
+    void setChannelRouting (const ChannelRouting& newRouting);
+
+    /** [Non-realtime] [Thread-safe] */
+    ChannelRouting getChannelRouting() const;
+
+    /** [Non-realtime] [Thread-safe]
+        Returns the number of channels the source renders. The source is
+        prepared after the routing is read, so it can size its buffers from
+        this in prepareToPlay().
+    */
+    int getNumSourceChannels() const;
+
+    //==========================================================================
+    /** [Realtime] [Thread-safe]
+        Enables or disables the crossover. When enabled, the Main device plays
+        the high-passed signal and every Linked device plays the low-passed
+        signal, such as for a main PA and a subwoofer. The two sides are
+        4th order Linkwitz-Riley filters, so they add up to the full range
+        signal where the devices overlap.
+    */
+    void setCrossoverEnabled (bool shouldBeEnabled) { crossoverEnabled.store (shouldBeEnabled); }
+    bool isCrossoverEnabled() const { return crossoverEnabled.load(); }
+
+    /** [Realtime] [Thread-safe]
+        Sets the crossover frequency in Hz.
+    */
+    void setCrossoverFrequency (float newFrequencyInHz) { crossoverFrequency.store (newFrequencyInHz); }
+    float getCrossoverFrequency() const { return crossoverFrequency.load(); }
+
+    //==========================================================================
+    /** [Realtime] [Thread-safe]
+        Returns the estimated clock drift between the Main device and a Linked
+        device in ppm. The estimate is only updated while drift correction
+        is enabled.
+    */
+    float getEstimatedDriftInPpm (int linkedDeviceIndex) const
+    {
+        return linkedDevices[linkedDeviceIndex]->source.getEstimatedDriftInPpm();
+    }
+
+    /** [Realtime] [Thread-safe]
+        Returns how far a Linked device plays ahead of the Main device, in
+        samples of the Main device, smoothed over about a second. Excludes
+        the latency setting and the output latencies of the devices. Drift
+        correction keeps it close to zero.
+    */
+    float getAlignmentErrorInSamples (int linkedDeviceIndex) const
+    {
+        return linkedDevices[linkedDeviceIndex]->source.getAlignmentErrorInSamples();
+    }
+
+    /** [Realtime] [Thread-safe]
+        Returns true if a Linked device was swapped in during playback with
+        blocks too large for the current depth of the shared buffer. It stays
+        silent until the Main device is prepared again.
+    */
+    bool isLinkedDeviceRejected (int linkedDeviceIndex) const
+    {
+        return linkedDevices[linkedDeviceIndex]->source.isRejected();
+    }
+
+    //==========================================================================
+    /** Shared buffer statistics of one device, accumulated since the device
+        was last prepared.
+    */
+    struct Statistics
+    {
+        int64 numTransfers = 0;     // number of blocks pushed or popped
+        int64 numOverflows = 0;     // Main device ran out of space and faded out
+        int64 numUnderruns = 0;     // Linked device ran out of samples and faded out
+        int64 numFadeIns = 0;
+        int64 numFadeOuts = 0;
+        int64 numWaits = 0;         // blocks spent waiting for space or samples
+        int numXRuns = 0;           // reported by the audio device
+
+        // Shared buffer occupancy seen by the device before each transfer
+        int minOccupancy = 0;
+        int maxOccupancy = 0;
+        double meanOccupancy = 0.0;
+
+        // Gauges of the most recent callback
+        int occupancy = 0;
+        double load = 0.0;          // callback time relative to the block duration
+    };
+
+    /** [Non-realtime] [Thread-safe]
+        Returns the shared buffer statistics of the Main device. The xrun
+        count is read from the device, under a lock it shares with the
+        device start and stop.
+    */
+    Statistics getMainStatistics() const;
+
+    /** [Non-realtime] [Thread-safe]
+        Returns the shared buffer statistics of a Linked device.
+    */
+    Statistics getLinkedStatistics (int linkedDeviceIndex) const;
+
+    /** [Realtime] [Thread-safe]
+        Returns the stage timing histograms of the Main device. The source
+        of the Main device can time its own stages into them, but only from
+        the thread that renders it: the Main device callback, or the producer
+        thread when rendering ahead.
+    */
+    StageProfiler& getMainProfiler() { return mainSource.profiler; }
+    const StageProfiler& getMainProfiler() const { return mainSource.profiler; }
+
+    /** [Realtime] [Thread-safe]
+        Returns the stage timing histograms of a Linked device.
+    */
+    const StageProfiler& getLinkedProfiler (int linkedDeviceIndex) const
+    {
+        return linkedDevices[linkedDeviceIndex]->source.profiler;
+    }
+
+    /** [Realtime] [Thread-safe]
+        Returns the number of samples the shared buffer can hold.
+    */
+    int getSharedBufferSize() const { return sharedBuffer.getTotalSize(); }
+
+    /** [Realtime] [Thread-safe]
+        Returns the number of samples the Linked devices keep in the shared
+        buffer, which is also the delay of the Main device that compensates
+        for them. A new depth is reached gradually, see
+        setAdaptiveBufferSizingEnabled().
+    */
+    int getSharedBufferDepth() const { return mainSource.getFixedDelay(); }
+
+    //==========================================================================
+    /** [Realtime] [Source rendering thread only]
+        Returns the host time, in high resolution ticks, at which the first
+        sample of the block that the Main device source is rendering leaves
+        the Main device. The Linked devices play it at the same time, offset
+        by their latency compensation.
+    */
+    int64 getMainBlockOutputTime() const { return mainSource.getBlockOutputTime(); }
+
+    /** [Realtime] [Thread-safe]
+        Returns the time from a sample being rendered on the Main device to it
+        leaving the devices. A start can't be scheduled any sooner.
+    */
+    double getOutputLatencyInSeconds() const { return mainSource.getOutputLatencyInSeconds(); }
+
+    /** [Realtime] [Thread-safe]
+        Timestamps the audio callbacks with the host time that the devices
+        report with every callback, instead of the time at which the callbacks
+        are entered. Use it when every device reports its host time on the
+        same clock, such as simulated devices, so that the alignment and the
+        callback trace don't depend on how fast the callbacks actually run.
+        Callbacks without a host time are still timestamped on entry.
+
+        The block output times are then on the host clock of the devices too.
+    */
+    void setDeviceHostTimeEnabled (bool shouldBeEnabled) { deviceHostTimeEnabled.store (shouldBeEnabled); }
+    bool isDeviceHostTimeEnabled() const { return deviceHostTimeEnabled.load(); }
+
+    /** [Realtime] [Thread-safe]
+        Returns true if every Linked device is playing from the shared buffer
+        rather than waiting for it to fill, so that a start is heard on every
+        device at the same time. Rejected devices are not waited for.
+    */
+    bool areLinkedDevicesStreaming() const;
+
+    //==========================================================================
+    /** [Non-realtime] [Non-thread-safe]
+        Starts recording the timestamp, block size and prepared sample rate
+        of every audio callback. The most recent callbacks of each device
+        are kept.
+    */
+    void startTraceRecording() { trace.start(); }
+
+    /** [Realtime] [Thread-safe]
+        Stops recording the audio callbacks. The recorded trace is kept.
+    */
+    void stopTraceRecording() { trace.stop(); }
+
+    /** [Non-realtime] [Thread-safe]
+        Saves the recorded callback trace to a binary trace file.
+        Device 0 in the trace is the Main device, device i + 1 is
+        the Linked device i.
+    */
+    bool saveTrace (const File& file) const { return trace.saveToFile (file); }
+
+    //==========================================================================
+    // Main device manager
+    AudioDeviceManager mainDeviceManager;
+
+    //==========================================================================
+    // Every Linked device reads the shared buffer through its own cursor
+    inline static constexpr int maxNumLinkedDevices = AudioFifo::maxNumReaders;
+
+    // How often the adaptive sizing policy is updated [ms]
+    inline static constexpr int bufferSizingIntervalInMs = 250;
+
+    // How often an app without a message loop services the devices [ms]
+    inline static constexpr int deviceServiceIntervalInMs = 10;
+
+private:
+    // Drift correction
+    std::atomic<bool> driftCorrectionEnabled { true };
+
+    // Resampler quality of the Linked devices
+    std::atomic<PolyphaseResamplingAudioSource::Quality> resamplingQuality {
+        PolyphaseResamplingAudioSource::Quality::balanced };
+
+    // Crossover between the Main and the Linked devices
+    std::atomic<bool> crossoverEnabled { false };
+    std::atomic<float> crossoverFrequency { 80.0f };    // [Hz]
+
+    // Callbacks are timestamped with the host time of the devices
+    std::atomic<bool> deviceHostTimeEnabled { false };
+
+    //==========================================================================
+    // Channel routing, read by the devices when they are prepared. Never
+    //  taken by the audio callbacks.
+    ChannelRouting routing;
+    CriticalSection routingLock;
+
+    /** [Non-realtime] Returns the source channels that go through the shared
+        buffer. The caller must hold the routingLock.
+    */
+    Array<int> getSharedChannels() const;
+
+    /** [Realtime] [Non-thread-safe]
+        Applies one side of the crossover to a block of a device, if the
+        crossover is enabled. The filter state is cleared while it's disabled,
+        so that it starts from silence when enabled again.
+    */
+    void applyCrossover (CrossoverFilter& filter, bool& wasEnabled,
+                         StageProfiler& profiler, const AudioSourceChannelInfo& info) const;
+
+    //==========================================================================
+    // Callback trace of all devices
+    CallbackTrace trace;
+
+    //==========================================================================
+    // Shared audio buffer facilities
+    AudioFifo sharedBuffer;
+
+    /*  Serialises reconfiguration of the shared buffer when several devices
+        are being prepared at the same time. Never taken by the audio callbacks.
+    */
+    CriticalSection resizeMutex;
+
+    /** [Non-realtime] [Non-thread-safe]
+        Checks whether sharedBuffer size needs to be changed and resizes it
+        if necessary, and sets the delay of the Main device to the depth.
+        The caller must hold resizeMutex.
+
+        The buffer has room for the largest depth the Main device can be
+        delayed by, so a change of the depth alone never resizes it.
+        Resizing discards the buffer contents, so it's only called while the
+        Main device is prepared. A Linked device that is swapped in during
+        playback keeps the depth and the buffer, see PopAudioSource.
+
+        @param numChannels  pass the new number of channels required,
+                            or -1 to keep the channel count unchanged.
+        @param canShrink    pass false to keep a buffer that is larger than
+                            required.
+    */
+    void resizeSharedBuffer (int numChannels = -1, bool canShrink = true);
+
+    //==========================================================================
+    // Audio device management
+    /** Prepares the audio source of a device again, at the sample rate and
+        block size the device is running at. The device keeps running, and
+        the source fades in from silence once it's prepared.
+    */
+    void resetAudioDevice (AudioDeviceManager& manager, AudioSourcePlayer& player);
+
+    /** Returns true if a device asked to be prepared again. */
+    bool isAudioDeviceResetPending() const;
+
+    /** The audio threads only set a lock-free flag when a device needs to be
+        prepared again, and wake this thread. It sleeps until then, and posts
+        the reset to the message thread, so no message is posted from an
+        audio callback.
+    */
+    void run() override;
+
+    /** Stops the service thread, which otherwise sleeps until it's woken. */
+    void stopServiceThread();
+
+    void handleAsyncUpdate() override { serviceDeviceResets(); }
+
+    /** A device manager broadcasts a change when its device is notified of a
+        new sample rate. A device that keeps running at it is prepared again.
+    */
+    void changeListenerCallback (ChangeBroadcaster* source) override;
+
+    //==========================================================================
+    // Adaptive depth of the shared buffer. The policy runs on the message
+    //  thread, and the depth is zero while the default depth is used
+    SharedBufferSizer bufferSizer;
+    std::atomic<int> adaptiveBufferDepth { 0 };
+    std::atomic<bool> bufferSizerNeedsReset { false };
+
+    void timerCallback() override { updateAdaptiveBufferSizing(); }
+
+    /** [Non-realtime] Sets the depth of the shared buffer, or the default
+        depth if zero. The Linked devices follow it with their drift
+        correction, or are realigned to it if the correction is disabled.
+    */
+    void setSharedBufferDepth (int newDepth);
+
+    //==========================================================================
+    /** [Realtime] [Thread-safe]
+        Returns the delay applied to the Main device for latency compensation,
+        which is the largest positive latency among the Linked devices.
+    */
+    float getMainDelayInMs() const;
+
+    //==========================================================================
+    /** Lock-free statistics counters and gauges. Each instance is only
+        updated by the audio thread of its device, and can be read from
+        any thread.
+    */
+    class StatisticsCounters
+    {
+    public:
+        /** [Non-realtime] [Non-thread-safe]
+            Clears the counters. Must not be called while the device is running.
+        */
+        void reset (double sampleRate, int blockSize);
+
+        /** [Realtime] [Single writer] */
+        void addTransfer (int occupancy);
+        void addWait (int occupancy);
+        void addOverflow()  { increment (numOverflows); }
+        void addUnderrun()  { increment (numUnderruns); }
+        void addFadeIn()    { increment (numFadeIns); }
+        void addFadeOut()   { increment (numFadeOuts); }
+
+        /** [Realtime] [Thread-safe] */
+        Statistics getSnapshot() const;
+
+        /** Measures the time spent in the audio callback of the device */
+        AudioProcessLoadMeasurer loadMeasurer;
+
+    private:
+        std::atomic<int64> numTransfers { 0 };
+        std::atomic<int64> numOverflows { 0 };
+        std::atomic<int64> numUnderruns { 0 };
+        std::atomic<int64> numFadeIns { 0 };
+        std::atomic<int64> numFadeOuts { 0 };
+        std::atomic<int64> numWaits { 0 };
+
+        std::atomic<int64> occupancySum { 0 };
+        std::atomic<int> minOccupancy { std::numeric_limits<int>::max() };
+        std::atomic<int> maxOccupancy { 0 };
+        std::atomic<int> lastOccupancy { 0 };
+
+        // There is only one writer, so read-modify-write is not needed
+        static void increment (std::atomic<int64>& counter)
+        {
+            counter.store (counter.load (std::memory_order_relaxed) + 1,
+                           std::memory_order_relaxed);
+        }
+    };
+
+    //==========================================================================
+    /** Streams an audio source to a device, and keeps what the source needs
+        to know about the device, so that its callbacks never query the device
+        or its manager.
+
+        Every callback is timestamped before the source renders it. The source
+        can't see the callback context, so it reads the time from here.
+    */
+    class DeviceSourcePlayer  : public AudioSourcePlayer
+    {
+    public:
+        explicit DeviceSourcePlayer (MultiDevicePlayer& mdp) : owner (mdp) {}
+
+        /** [Realtime] [Audio thread only]
+            Returns the time of the current callback, in high resolution ticks.
+        */
+        int64 getCallbackTime() const { return callbackTime; }
+
+        /** [Realtime] [Audio thread only]
+            Returns the running device. It's set before the source is prepared.
+        */
+        AudioIODevice* getDevice() const { return device; }
+
+        /** [Non-realtime] [Thread-safe]
+            Returns the xrun count of the running device, or 0 if none runs.
+        */
+        int getXRunCount() const;
+
+        /** [Non-realtime] [Thread-safe]
+            Returns false if the running device no longer runs at the sample
+            rate the source was prepared at.
+        */
+        bool isRunningAtPreparedRate() const;
+
+        //======================================================================
+        void audioDeviceAboutToStart (AudioIODevice* newDevice) override;
+        void audioDeviceStopped() override;
+        void audioDeviceIOCallbackWithContext (const float* const* inputChannelData,
+                                               int numInputChannels,
+                                               float* const* outputChannelData,
+                                               int numOutputChannels,
+                                               int numSamples,
+                                               const AudioIODeviceCallbackContext& context) override;
+
+    private:
+        MultiDevicePlayer& owner;
+        int64 callbackTime = 0;     // [ticks]
+
+        // Only changed while the device isn't running its callbacks. The lock
+        //  keeps the device alive while another thread reads it
+        mutable CriticalSection deviceLock;
+        AudioIODevice* device = nullptr;
+        double preparedSampleRate = 0.0;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DeviceSourcePlayer)
+    };
+
+    // Object for streaming audio from an audio source to the Main device
+    DeviceSourcePlayer mainSourcePlayer { *this };
+
+    //==========================================================================
+    // Audio sources for managed devices
+    class PushAudioSource  : public AudioSource
+    {
+    public:
+        PushAudioSource (MultiDevicePlayer& mdp, double maxLatencyInMs);
+
+        //======================================================================
+        /** [Realtime] [Non-tread-safe]
+            ...
+        */
+        void setSource (AudioSource* src) { source = src; }
+
+        //======================================================================
+        void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+        void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
+        void releaseResources() override;
+
+        //======================================================================
+        /** [Realtime] [Thread-safe]
+            Returns the nominal sample rate of the Main device.
+        */
+        double getSampleRate() const { return nominalSampleRate.load(); }
+
+        /** [Non-realtime] [Non-tread-safe]
+            Returns the block size of the Main device. The caller must hold
+            the resizeMutex.
+        */
+        int getPushBlockSize() const { return blockSize; }
+
+        /** [Non-realtime] [Non-tread-safe]
+            Returns true between prepareToPlay() and releaseResources().
+            The caller must hold the resizeMutex.
+        */
+        bool isPrepared() const { return prepared; }
+
+        /** [Non-realtime] [Non-tread-safe]
+            Returns the largest fixed delay the delay buffer has room for.
+            The caller must hold the resizeMutex.
+        */
+        int getMaxFixedDelay() const { return maxFixedDelay; }
+
+        /** [Realtime] [Thread-safe]
+            Returns the recent peak wake-up jitter of the Main device.
+        */
+        double getPeakJitterInSeconds() const { return clock.getPeakJitterInSeconds(); }
+
+        /** [Realtime] [Source rendering thread only]
+            Returns the host time at which the first sample of the block
+            being rendered leaves the device.
+        */
+        int64 getBlockOutputTime() const
+        {
+            return renderAheadEnabled ? renderAhead.getRenderBlockOutputTime()
+                                      : blockOutputTime.load (std::memory_order_relaxed);
+        }
+
+        /** [Realtime] [Thread-safe] */
+        double getOutputLatencyInSeconds() const { return outputLatency.load(); }
+
+        //======================================================================
+        /** [Realtime] [Thread-safe]
+            Reads the time at which the Main device processes the next sample
+            pushed to the shared buffer, and calls `readSharedBuffer` to read
+            the shared buffer at the same instant.
+
+            @returns    false if the time is unknown, or the Main device pushed
+                        while it was read, in which case the time is unusable.
+        */
+        template <typename ReadFunction>
+        bool readPushTiming (int64& nextPushTimeInTicks, ReadFunction&& readSharedBuffer) const
+        {
+            const auto sequence = pushTimingSequence.load (std::memory_order_acquire);
+
+            nextPushTimeInTicks = nextPushTime.load (std::memory_order_relaxed);
+            readSharedBuffer();
+
+            std::atomic_thread_fence (std::memory_order_acquire);
+
+            return (sequence & 1) == 0 && nextPushTimeInTicks != 0
+                && pushTimingSequence.load (std::memory_order_relaxed) == sequence;
+        }
+
+        /** [Realtime] [Thread-safe]
+            Converts high resolution ticks to samples of the Main device.
+        */
+        double ticksToSamples (int64 numTicks) const { return clock.ticksToSamples (numTicks); }
+
+        /** [Realtime] [Thread-safe]
+            Returns the delay that compensates for the time audio spends in
+            the shared buffer, which the Linked devices keep their fill level at.
+        */
+        int getFixedDelay() const { return fixedDelay.load(); }
+
+        /** [Realtime] [Thread-safe]
+            Returns the delay the Main device currently applies, which moves
+            towards the fixed delay by `fixedDelaySlewRate`. It's the lag the
+            Linked devices hold.
+        */
+        double getAppliedFixedDelay() const { return appliedFixedDelay.load(); }
+
+        /** [Realtime] [Thread-safe]
+            Applies the fixed delay at once, without moving towards it.
+        */
+        void skipFixedDelayRamp() { appliedFixedDelay.store (fixedDelay.load()); }
+
+        //======================================================================
+        /** [Realtime] [Thread-safe]
+            Sets the delay that compensates for the time audio spends in the
+            shared buffer. It's the target of the lag the Linked devices
+            measure, and doesn't follow the measurement itself.
+
+            @returns    false if the delay exceeds the capacity of the delay
+                        buffer, in which case the device must be prepared again.
+        */
+        bool setFixedDelay (int newFixedDelay);
+
+        //======================================================================
+        /** [Non-realtime] [Thread-safe]
+            Sets the render-ahead time, and asks for the device to be prepared
+            again if it changes whether or how far the source is rendered ahead.
+        */
+        void setRenderAheadTime (double renderAheadInMs);
+        double getRenderAheadTime() const { return renderAheadTime.load(); }
+
+        /** [Realtime] [Thread-safe] */
+        int getRenderAheadUnderruns() const { return renderAhead.getNumUnderruns(); }
+
+        /** Atomic flag that is set when the device must be prepared again */
+        std::atomic<bool> needsAudioDeviceReset = false;
+
+        /** [Realtime] [Thread-safe]
+            Sets the flag and wakes the service thread, which has the device
+            reset on the message thread.
+        */
+        void requestAudioDeviceReset();
+
+        StatisticsCounters statistics;
+        StageProfiler profiler;
+
+    private:
+        MultiDevicePlayer& owner;
+        DelayAudioSource delay;
+        const double maxLatencyDelayInMs;
+
+        /*  The Main device is delayed by the depth of the shared buffer, the
+            `fixedDelay`, to compensate for the time audio spends in the shared
+            buffer. It is half the buffer size, or set by the adaptive sizing.
+            Every Linked device measures how far behind the Main device it
+            plays and steers its resampling ratio to hold it at this delay.
+
+            The shared buffer can be resized by the Linked device while the Main
+            device is running, so the delay buffer is allocated with headroom
+            for `maxFixedDelay` samples.
+
+            A new depth is applied by `fixedDelaySlewRate` samples per sample,
+            which leaves the drift correction of the Linked devices room to
+            follow it on top of the clock drift.
+        */
+        std::atomic<int> fixedDelay { 0 };
+        std::atomic<double> appliedFixedDelay { 0.0 };
+        int maxFixedDelay = 0;
+
+        inline static constexpr double fixedDelaySlewRate = 0.5 * DriftCorrector::maxCorrection;
+
+        /** [Non-realtime] [Non-tread-safe]
+            Initialise the internal delay buffer for latency compensation.
+
+            Make sure this method is called only after the members
+            `blockSize`, `numChannels`, and `nominalSampleRate` have been set.
+        */
+        void prepareLatencyCompensation();
+
+        //======================================================================
+        AudioSource* source = nullptr;
+
+        bool waitForBufferSpace = false;
+
+        // Set when the device is prepared again while it's running
+        bool fadeInNextBlock = false;
+
+        //======================================================================
+        // Source channels, rendered into the outputs that play them
+        ChannelRouting::OutputMap outputMap;
+
+        // Source channels that go through the shared buffer
+        Array<int> sharedChannels;
+        std::array<float*, ChannelRouting::maxNumChannels> sharedChannelData {};
+        AudioBuffer<float> sharedView;
+
+        //======================================================================
+        // High-pass side of the crossover
+        CrossoverFilter crossover { CrossoverFilter::Type::highPass };
+        bool crossoverWasEnabled = false;
+
+        //======================================================================
+        // Renders the source ahead on a producer thread, when enabled
+        RenderAheadAudioSource renderAhead { nullptr };
+        std::atomic<double> renderAheadTime { 0.0 };   // [ms]
+        bool renderAheadEnabled = false;
+
+        //======================================================================
+        // Host time of the callbacks, used to schedule playback
+        CallbackClock clock;
+        std::atomic<int64> blockOutputTime { 0 };   // [ticks]
+        std::atomic<double> outputLatency { 0.0 };  // [s]
+
+        // Callback time at which the next sample pushed to the shared buffer
+        //  is processed, zero if unknown. The sequence is odd while a push is
+        //  in progress
+        std::atomic<uint32> pushTimingSequence { 0 };
+        std::atomic<int64> nextPushTime { 0 };      // [ticks]
+
+        //======================================================================
+        int numChannels = 2;
+        std::atomic<double> nominalSampleRate { 44100.0 };
+        int blockSize = 32;
+        bool prepared = false;  // guarded by the resizeMutex
+
+        // Output latency of the device, read when it's prepared
+        int deviceOutputLatency = 0;    // [samples]
+
+        //======================================================================
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PushAudioSource)
+    };
+
+    class PopAudioSource  : public AudioSource
+    {
+    public:
+        PopAudioSource (MultiDevicePlayer& mdp, const DeviceSourcePlayer& player,
+                        int sharedBufferReader, double maxLatencyInMs);
+
+        //======================================================================
+        void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+        void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
+        void releaseResources() override;
+
+        //======================================================================
+        /** [Non-realtime] [Non-tread-safe]
+            Returns the largest block that can be popped from the shared buffer
+            at the current Main device sample rate. The caller must hold
+            the resizeMutex.
+        */
+        int getPopBlockSize() const;
+
+        //======================================================================
+        /** [Realtime] [Thread-safe]
+            Fades out and halts popping from the shared buffer until the lag
+            behind the Main device matches its fixed delay again.
+        */
+        void haltUntilAligned() { haltRequested.store (true); }
+
+        /** [Realtime] [Thread-safe]
+            Returns the recent peak wake-up jitter of this device.
+        */
+        double getPeakJitterInSeconds() const { return clock.getPeakJitterInSeconds(); }
+
+        //======================================================================
+        /** [Realtime] [Thread-safe]
+            Sets the latency of this device relative to the Main device.
+        */
+        void setLatency (float newLatencyInMs) { latency.store (newLatencyInMs); }
+        float getLatency() const { return latency.load(); }
+
+        /** [Realtime] [Thread-safe]
+            Returns the estimated clock drift relative to the Main device.
+        */
+        float getEstimatedDriftInPpm() const { return estimatedDriftInPpm.load(); }
+
+        /** [Realtime] [Thread-safe]
+            Returns how far this device plays ahead of the Main device, in
+            samples of the Main device.
+        */
+        float getAlignmentErrorInSamples() const { return alignmentError.load(); }
+
+        /** [Realtime] [Thread-safe]
+            Returns true if the device is playing from the shared buffer,
+            rather than waiting for it to fill.
+        */
+        bool isStreaming() const { return streaming.load(); }
+
+        /** [Realtime] [Thread-safe]
+            Returns true if the device was prepared while the Main device
+            played, and its blocks don't fit the depth of the shared buffer.
+        */
+        bool isRejected() const { return rejected.load(); }
+
+        /** Atomic flag that is set when the device must be prepared again */
+        std::atomic<bool> needsAudioDeviceReset = false;
+
+        /** [Realtime] [Thread-safe] See PushAudioSource::requestAudioDeviceReset() */
+        void requestAudioDeviceReset();
+
+        StatisticsCounters statistics;
+        StageProfiler profiler;
+
+    private:
+        MultiDevicePlayer& owner;
+        const DeviceSourcePlayer& sourcePlayer;
+        const int reader;
+        DelayAudioSource delay;
+        const double maxLatencyDelayInMs;
+
+        std::atomic<float> latency { 0.0f };    // [ms]
+        std::atomic<float> estimatedDriftInPpm { 0.0f };
+        std::atomic<float> alignmentError { 0.0f };     // [Main device samples]
+
+        // Host time of the callbacks, to measure the lag behind the Main device
+        CallbackClock clock;
+
+        //======================================================================
+        bool waitForBufferToFill = true;
+        std::atomic<bool> haltRequested { false };
+        std::atomic<bool> streaming { false };
+
+        /*  A device that is swapped in while the Main device plays must make
+            do with the depth and the storage of the shared buffer, which the
+            other devices are aligned to. If its pop block needs a deeper
+            buffer, it's rejected: it stays silent, and its reader is detached
+            so it doesn't hold back the Main device. The Main device prepares
+            it again when it's prepared itself, at a depth that fits.
+        */
+        std::atomic<bool> rejected { false };
+
+        //======================================================================
+        double nominalSampleRate = 44100.0;
+        int blockSize = 32;
+        int popBlockSize = 32;
+
+        // Main device sample rate that the resampler is currently following
+        double inputSampleRate = 44100.0;
+        double maxPreparedRatio = 1.0;
+
+        //======================================================================
+        AudioFifoSource sharedBufferSource;
+        std::unique_ptr<PolyphaseResamplingAudioSource> resampler;
+        DriftCorrector driftCorrector;
+
+        // Shared buffer channels, resampled into the outputs that play them
+        ChannelRouting::OutputMap outputMap;
+
+        // Low-pass side of the crossover
+        CrossoverFilter crossover { CrossoverFilter::Type::lowPass };
+        bool crossoverWasEnabled = false;
+
+        void initialiseResampling();
+
+        /** [Realtime] [Non-tread-safe]
+            Pops and resamples a block, and times the two stages separately.
+        */
+        void resampleSharedBuffer (const AudioSourceChannelInfo& bufferToFill);
+
+        /** [Realtime] [Non-tread-safe]
+            Follows a change of the Main device sample rate.
+
+            @returns    false if the new resampling ratio exceeds the one
+                        the resampler has been prepared for.
+        */
+        bool updateInputSampleRate();
+
+        /** [Realtime] [Non-tread-safe]
+            Measures the alignment error, and updates the resampling ratio
+            from the lag behind the Main device if drift correction is enabled.
+
+            @param lag          how far this device plays behind the Main
+                                device, in Main device samples
+            @param targetLag    delay of the Main device that compensates for it
+        */
+        void correctDrift (double lag, double targetLag);
+
+        //======================================================================
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PopAudioSource)
+    };
+
+    friend class PushAudioSource;
+    friend class PopAudioSource;
+
+    //==========================================================================
+    /** Everything that streams audio from the shared buffer to one Linked device */
+    struct LinkedDevice
+    {
+        LinkedDevice (MultiDevicePlayer& mdp, int index, double maxLatencyInMs)
+            : sourcePlayer (mdp),
+              source (mdp, sourcePlayer, index, maxLatencyInMs) {}
+
+        AudioDeviceManager deviceManager;
+        DeviceSourcePlayer sourcePlayer;
+        PopAudioSource source;
+    };
+
+    //==========================================================================
+    PushAudioSource mainSource;
+    OwnedArray<LinkedDevice> linkedDevices;
+
+    //==========================================================================
+    // Shared buffer size in multiples of the largest device block size
+    inline static constexpr int sharedBufferSizeInBlocks = 6;
+
+    // Largest pop block size the Main device delay buffer has headroom for
+    inline static constexpr int maxExpectedPopBlockSize = 4096;
+
+    // Number of most recent callbacks the trace keeps for each device
+    inline static constexpr int maxNumTracedCallbacks = 1 << 16;
+
+    // Time the service thread is given to stop [ms]
+    inline static constexpr int serviceThreadTimeoutInMs = 1000;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MultiDevicePlayer)
+};
@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    ParallelAudioDecoder.cpp
+    Created: 17 Oct 2026 5:03:44pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "ParallelAudioDecoder.h"
+
+ParallelAudioDecoder::ParallelAudioDecoder (AudioFormatManager& formatManager,
+                                            const File& fileToDecode)
+    : formats (formatManager), file (fileToDecode)
+{
+    std::unique_ptr<AudioFormatReader> reader (formats.createReaderFor (file));
+
+    if (reader == nullptr || reader->lengthInSamples <= 0
+        || reader->lengthInSamples > std::numeric_limits<int>::max())
+        return;
+
+    length = reader->lengthInSamples;
+
+    auto decodedAudio = std::make_shared<DecodedAudioCache::DecodedAudio>();
+    decodedAudio->sampleRate = reader->sampleRate;
+    decodedAudio->buffer.setSize (static_cast<int> (reader->numChannels),
+                                  static_cast<int> (length));
+    audio = std::move (decodedAudio);
+
+    //==========================================================================
+    // Split the file into segments and queue them in playback order, so that
+    //  the start of the file is ready first
+    const auto segmentLength = jmax (int64 { decodeChunkSize },
+                                     static_cast<int64> (segmentLengthInSeconds
+                                                         * reader->sampleRate));
+
+    for (int64 start = 0; start < length; start += segmentLength)
+        segments.push_back ({ start, static_cast<int> (jmin (segmentLength, length - start)) });
+
+    for (size_t i = 0; i < segments.size(); ++i)
+        decodePool.addJob ([this, i] { decodeSegment (i); });
+}
+
+ParallelAudioDecoder::~ParallelAudioDecoder()
+{
+    decodePool.removeAllJobs (true, 10000);
+}
+
+//==============================================================================
+double ParallelAudioDecoder::getProgress() const
+{
+    if (length == 0)
+        return 1.0;
+
+    return static_cast<double> (numDecodedSamples.load()) / static_cast<double> (length);
+}
+
+//==============================================================================
+void ParallelAudioDecoder::decodeSegment (size_t index)
+{
+    if (hasFailed.load())
+        return;
+
+    // Readers are not thread-safe, so every segment opens the file again
+    std::unique_ptr<AudioFormatReader> reader (formats.createReaderFor (file));
+
+    if (reader == nullptr)
+    {
+        markFailed();
+        return;
+    }
+
+    const auto& segment = segments[index];
+    const auto segmentStart = static_cast<int> (segment.start);
+
+    for (int offset = 0; offset < segment.numSamples; offset += decodeChunkSize)
+    {
+        // Give up when the decoder is being deleted
+        if (auto* job = ThreadPoolJob::getCurrentThreadPoolJob())
+            if (job->shouldExit())
+                return;
+
+        const auto numSamples = jmin (decodeChunkSize, segment.numSamples - offset);
+
+        // Segments write to separate parts of the buffer, so no locking is needed
+        if (! reader->read (&audio->buffer, segmentStart + offset, numSamples,
+                            segment.start + offset, true, true))
+        {
+            markFailed();
+            return;
+        }
+
+        numDecodedSamples.fetch_add (numSamples);
+    }
+
+    //==========================================================================
+    // Extend the ready part of the file over the segments that are complete
+    const ScopedLock sl (segmentsLock);
+
+    segments[index].isDecoded = true;
+
+    while (numReadySegments < segments.size() && segments[numReadySegments].isDecoded)
+        ++numReadySegments;
+
+    if (numReadySegments > 0)
+    {
+        const auto& lastReady = segments[numReadySegments - 1];
+        audio->numReadySamples.store (lastReady.start + lastReady.numSamples);
+    }
+}
+
+void ParallelAudioDecoder::markFailed()
+{
+    // The failed segment is never marked as decoded, so the ready part
+    //  doesn't grow past it
+    hasFailed.store (true);
+    audio->isIncomplete.store (true);
+}
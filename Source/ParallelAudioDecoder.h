@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    ParallelAudioDecoder.h
+    Created: 17 Oct 2026 5:03:44pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DecodedAudioCache.h"
+
+/**
+    Decodes a whole audio file into memory using all CPU cores.
+
+    The file is split into segments that are decoded concurrently, each with
+    its own reader, directly into one contiguous buffer. The decoded audio
+    is available straight away: its ready length grows as the segments at
+    the start of the file are completed, so playback can begin as soon as
+    the first segment is decoded.
+*/
+class ParallelAudioDecoder
+{
+public:
+    /** Starts decoding a file.
+
+        @param formatManager    formats used to decode the file. Must outlive
+                                the decoder
+        @param fileToDecode     file to decode. Its format must support
+                                seeking, which all JUCE formats do
+    */
+    ParallelAudioDecoder (AudioFormatManager& formatManager, const File& fileToDecode);
+
+    /** Cancels decoding and waits for the decoding threads to finish. */
+    ~ParallelAudioDecoder();
+
+    //==========================================================================
+    /** [Non-realtime] [Thread-safe]
+        Returns the audio that is being decoded.
+
+        @returns    nullptr if the file can't be read.
+    */
+    DecodedAudioCache::DecodedAudioPtr getDecodedAudio() const { return audio; }
+
+    /** [Realtime] [Thread-safe]
+        Returns the decoded proportion of the file, between 0 and 1.
+    */
+    double getProgress() const;
+
+    /** [Realtime] [Thread-safe]
+        Returns true if the whole file has been decoded, or if it failed.
+    */
+    bool isFinished() const { return hasFailed.load() || getProgress() >= 1.0; }
+
+    /** [Realtime] [Thread-safe]
+        Returns true if a segment couldn't be decoded. The decoded audio then
+        ends after the segments that were complete before it.
+    */
+    bool hasDecodingFailed() const { return hasFailed.load(); }
+
+private:
+    AudioFormatManager& formats;
+    const File file;
+
+    std::shared_ptr<DecodedAudioCache::DecodedAudio> audio;
+    int64 length = 0;
+
+    //==========================================================================
+    struct Segment
+    {
+        int64 start = 0;
+        int numSamples = 0;
+        bool isDecoded = false;
+    };
+
+    std::vector<Segment> segments;
+
+    // Guards the decoded flags and the ready prefix of the file
+    CriticalSection segmentsLock;
+    size_t numReadySegments = 0;
+
+    std::atomic<int64> numDecodedSamples { 0 };
+    std::atomic<bool> hasFailed { false };
+
+    ThreadPool decodePool { SystemStats::getNumCpus() };
+
+    //==========================================================================
+    /** [Decode thread]
+        Decodes one segment with a reader of its own.
+    */
+    void decodeSegment (size_t index);
+
+    /** [Decode thread]
+        Stops decoding, and ends the decoded audio at its ready part.
+    */
+    void markFailed();
+
+    //==========================================================================
+    // Segments are short, so that playback can start early
+    inline static constexpr double segmentLengthInSeconds = 30.0;
+
+    // Number of samples decoded at a time, which limits the cancellation time
+    inline static constexpr int decodeChunkSize = 65536;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParallelAudioDecoder)
+};
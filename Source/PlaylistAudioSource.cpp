@@ -0,0 +1,357 @@
+/*
+  ==============================================================================
+
+    PlaylistAudioSource.cpp
+    Created: 17 Oct 2026 10:47:31pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "PlaylistAudioSource.h"
+
+//==============================================================================
+void PlaylistAudioSource::Track::prepare (int blockSize, double outputSampleRate)
+{
+    ratio = (sampleRate > 0.0 && outputSampleRate > 0.0) ? sampleRate / outputSampleRate : 1.0;
+
+    if (ratio != 1.0)
+    {
+        if (resampler == nullptr)
+            resampler = std::make_unique<PolyphaseResamplingAudioSource> (source.get(), numChannels);
+
+        resampler->setMaxResamplingRatio (ratio);
+        resampler->prepareToPlay (blockSize, outputSampleRate);
+        resampler->setResamplingRatio (ratio);
+        numBufferedInputSamples.store (0.0);
+    }
+    else
+    {
+        resampler.reset();
+        source->prepareToPlay (blockSize, outputSampleRate);
+    }
+}
+
+void PlaylistAudioSource::Track::release()
+{
+    if (resampler != nullptr)
+        resampler->releaseResources();
+    else
+        source->releaseResources();
+}
+
+void PlaylistAudioSource::Track::render (const AudioSourceChannelInfo& info)
+{
+    if (resampler == nullptr)
+    {
+        source->getNextAudioBlock (info);
+        return;
+    }
+
+    if (shouldResetResampler.exchange (false))
+        resampler->reset();
+
+    resampler->getNextAudioBlock (info);
+    numBufferedInputSamples.store (resampler->getNumBufferedInputSamples());
+}
+
+// The resampler pulls the source ahead of what it has played, so the input
+//  it holds is still to be played
+int64 PlaylistAudioSource::Track::getOutputPosition() const
+{
+    const auto inputPosition = static_cast<double> (source->getNextReadPosition())
+                             - numBufferedInputSamples.load();
+
+    return static_cast<int64> (jmax (0.0, inputPosition) / ratio);
+}
+
+int64 PlaylistAudioSource::Track::getOutputLength() const
+{
+    return static_cast<int64> (static_cast<double> (source->getTotalLength()) / ratio);
+}
+
+void PlaylistAudioSource::Track::setOutputPosition (int64 position)
+{
+    source->setNextReadPosition (static_cast<int64> (static_cast<double> (position) * ratio));
+    numBufferedInputSamples.store (0.0);
+    shouldResetResampler.store (true);
+}
+
+//==============================================================================
+PlaylistAudioSource::PlaylistAudioSource (std::unique_ptr<Track> firstTrack)
+{
+    jassert (firstTrack != nullptr);
+    currentTrack.store (firstTrack.release());
+
+    startTimerHz (10);
+
+    //==========================================================================
+    // Check that atomic pointer is lock-free
+    static_assert (std::atomic<Track*>::is_always_lock_free,
+                   "std::atomic for type Track* must be always lock free");
+}
+
+PlaylistAudioSource::~PlaylistAudioSource()
+{
+    stopTimer();
+    deleteRetiredTracks();
+
+    delete incomingTrack;
+    delete nextTrack.exchange (nullptr);
+    delete currentTrack.exchange (nullptr);
+}
+
+//==============================================================================
+void PlaylistAudioSource::queueTrack (std::unique_ptr<Track> track)
+{
+    jassert (track != nullptr);
+
+    const ScopedLock sl (prepareLock);
+
+    // Preparing a read-ahead source starts filling its buffer, so the
+    //  track is buffered long before it starts
+    if (isPrepared)
+        track->prepare (blockSize, outputSampleRate);
+
+    // The audio thread takes the next track with an exchange too, so only
+    //  a track that it hasn't taken is deleted here
+    delete nextTrack.exchange (track.release());
+}
+
+bool PlaylistAudioSource::waitForNextAudioBlockReady (int timeoutInMs) const
+{
+    auto* track = currentTrack.load();
+
+    if (track == nullptr || track->readAheadSource == nullptr)
+        return true;
+
+    return track->readAheadSource->waitForNextAudioBlockReady (timeoutInMs);
+}
+
+int PlaylistAudioSource::getNumReadAheadUnderruns() const
+{
+    auto* track = currentTrack.load();
+
+    int numUnderruns = numRetiredUnderruns.load();
+
+    if (track != nullptr && track->readAheadSource != nullptr)
+        numUnderruns += track->readAheadSource->getNumUnderruns();
+
+    return numUnderruns;
+}
+
+//==============================================================================
+void PlaylistAudioSource::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    const ScopedLock sl (prepareLock);
+
+    blockSize = samplesPerBlockExpected;
+    outputSampleRate = sampleRate;
+    fadeBuffer.setSize (maxNumChannels, jmax (1, samplesPerBlockExpected));
+
+    for (auto* track : { currentTrack.load(), nextTrack.load(), incomingTrack })
+        if (track != nullptr)
+            track->prepare (samplesPerBlockExpected, sampleRate);
+
+    isPrepared = true;
+}
+
+void PlaylistAudioSource::releaseResources()
+{
+    const ScopedLock sl (prepareLock);
+
+    for (auto* track : { currentTrack.load(), nextTrack.load(), incomingTrack })
+        if (track != nullptr)
+            track->release();
+
+    isPrepared = false;
+}
+
+void PlaylistAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info)
+{
+    // The current track was moved, so its end no longer lines up with
+    //  the fade-in of the next one
+    if (isSeekPending.exchange (false) && incomingTrack != nullptr)
+        startIncomingTrack();
+
+    auto* track = currentTrack.load();
+
+    if (track == nullptr)
+    {
+        info.clearActiveBufferRegion();
+        return;
+    }
+
+    const bool shouldLoop = looping.load() && incomingTrack == nullptr && nextTrack.load() == nullptr;
+    track->source->setLooping (shouldLoop);
+
+    const auto remaining = jmax (int64 { 0 }, track->getOutputLength() - track->getOutputPosition());
+
+    //==========================================================================
+    // Take the next track once it has to start within this block
+    if (! shouldLoop && incomingTrack == nullptr && nextTrack.load() != nullptr)
+    {
+        const auto crossfadeLength = jmin (remaining,
+                                           static_cast<int64> (crossfadeTime.load() * outputSampleRate));
+
+        if (remaining - crossfadeLength < info.numSamples)
+        {
+            incomingTrack = nextTrack.exchange (nullptr);
+            fadeLength = crossfadeLength;
+            fadePosition = 0;
+        }
+    }
+
+    if (incomingTrack == nullptr)
+    {
+        // Past its end the track keeps moving, so that the transport stops
+        track->render (info);
+        return;
+    }
+
+    //==========================================================================
+    // The current track plays up to its end, fading out over the last
+    //  `fadeLength` samples while the incoming track fades in
+    const auto startInBlock = static_cast<int> (jmax (int64 { 0 }, remaining - (fadeLength - fadePosition)));
+    const auto numFromCurrent = static_cast<int> (jmin (remaining, static_cast<int64> (info.numSamples)));
+
+    if (numFromCurrent > 0)
+        track->render (AudioSourceChannelInfo (info.buffer, info.startSample, numFromCurrent));
+
+    if (numFromCurrent < info.numSamples)
+        info.buffer->clear (info.startSample + numFromCurrent, info.numSamples - numFromCurrent);
+
+    const auto numFading = numFromCurrent - startInBlock;
+
+    if (numFading > 0)
+    {
+        const auto startGain = static_cast<float> (fadePosition) / static_cast<float> (fadeLength);
+        const auto endGain = static_cast<float> (fadePosition + numFading) / static_cast<float> (fadeLength);
+
+        info.buffer->applyGainRamp (info.startSample + startInBlock, numFading,
+                                    1.0f - startGain, 1.0f - endGain);
+        addIncomingTrack (info, startInBlock, numFading, startGain, endGain);
+
+        fadePosition += numFading;
+    }
+
+    if (numFromCurrent < info.numSamples)
+        addIncomingTrack (info, numFromCurrent, info.numSamples - numFromCurrent, 1.0f, 1.0f);
+
+    if (remaining <= info.numSamples)
+        startIncomingTrack();
+}
+
+//==============================================================================
+void PlaylistAudioSource::setNextReadPosition (int64 newPosition)
+{
+    if (auto* track = currentTrack.load())
+        track->setOutputPosition (newPosition);
+
+    isSeekPending.store (true);
+}
+
+int64 PlaylistAudioSource::getNextReadPosition() const
+{
+    auto* track = currentTrack.load();
+    return track != nullptr ? track->getOutputPosition() : 0;
+}
+
+int64 PlaylistAudioSource::getTotalLength() const
+{
+    auto* track = currentTrack.load();
+    return track != nullptr ? track->getOutputLength() : 0;
+}
+
+//==============================================================================
+void PlaylistAudioSource::startIncomingTrack()
+{
+    auto* finishedTrack = currentTrack.exchange (incomingTrack);
+
+    incomingTrack = nullptr;
+    fadeLength = 0;
+    fadePosition = 0;
+
+    retireTrack (finishedTrack);
+
+    // There is only one writer, so read-modify-write is not needed
+    numTrackChanges.store (numTrackChanges.load (std::memory_order_relaxed) + 1);
+}
+
+void PlaylistAudioSource::retireTrack (Track* track)
+{
+    if (track == nullptr)
+        return;
+
+    if (track->readAheadSource != nullptr)
+        numRetiredUnderruns.store (numRetiredUnderruns.load (std::memory_order_relaxed)
+                                   + track->readAheadSource->getNumUnderruns());
+
+    int start1, size1, start2, size2;
+    retiredFifo.prepareToWrite (1, start1, size1, start2, size2);
+
+    // If the message thread has fallen this far behind, the track is leaked
+    //  rather than deleted on the audio thread
+    jassert (size1 + size2 == 1);
+
+    if (size1 == 1)
+        retiredTracks[static_cast<size_t> (start1)] = track;
+    else if (size2 == 1)
+        retiredTracks[static_cast<size_t> (start2)] = track;
+
+    retiredFifo.finishedWrite (size1 + size2);
+}
+
+void PlaylistAudioSource::addIncomingTrack (const AudioSourceChannelInfo& info, int startInBlock,
+                                            int numSamples, float startGain, float endGain)
+{
+    const auto numChannelsToAdd = jmin (maxNumChannels, info.buffer->getNumChannels());
+
+    for (int numDone = 0; numDone < numSamples;)
+    {
+        const auto numToRender = jmin (numSamples - numDone, fadeBuffer.getNumSamples());
+
+        incomingTrack->render (AudioSourceChannelInfo (&fadeBuffer, 0, numToRender));
+
+        const auto gainStep = (endGain - startGain) / static_cast<float> (numSamples);
+        const auto chunkStartGain = startGain + gainStep * static_cast<float> (numDone);
+        const auto chunkEndGain = startGain + gainStep * static_cast<float> (numDone + numToRender);
+
+        for (int channel = 0; channel < numChannelsToAdd; ++channel)
+            info.buffer->addFromWithRamp (channel, info.startSample + startInBlock + numDone,
+                                          fadeBuffer.getReadPointer (channel), numToRender,
+                                          chunkStartGain, chunkEndGain);
+
+        numDone += numToRender;
+    }
+}
+
+//==============================================================================
+void PlaylistAudioSource::timerCallback()
+{
+    deleteRetiredTracks();
+
+    const auto numChanges = numTrackChanges.load();
+
+    if (numChanges != numTrackChangesNotified)
+    {
+        numTrackChangesNotified = numChanges;
+
+        if (onTrackChanged != nullptr)
+            onTrackChanged();
+    }
+}
+
+void PlaylistAudioSource::deleteRetiredTracks()
+{
+    int start1, size1, start2, size2;
+    retiredFifo.prepareToRead (retiredFifo.getNumReady(), start1, size1, start2, size2);
+
+    for (int i = 0; i < size1; ++i)
+        delete std::exchange (retiredTracks[static_cast<size_t> (start1 + i)], nullptr);
+
+    for (int i = 0; i < size2; ++i)
+        delete std::exchange (retiredTracks[static_cast<size_t> (start2 + i)], nullptr);
+
+    retiredFifo.finishedRead (size1 + size2);
+}
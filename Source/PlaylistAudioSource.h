@@ -0,0 +1,215 @@
+/*
+  ==============================================================================
+
+    PlaylistAudioSource.h
+    Created: 17 Oct 2026 10:47:31pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ReadAheadAudioSource.h"
+#include "MappedReaderPrefetcher.h"
+#include "PolyphaseResamplingAudioSource.h"
+#include "ChannelRouting.h"
+
+/**
+    Positionable source that plays a track and splices the next queued track
+    in at the exact sample where the current one ends, optionally with a
+    crossfade.
+
+    The next track is prepared on the thread that queues it, so its read-ahead
+    buffer is already filled when it starts. At the boundary the audio thread
+    only swaps pointers and mixes from a buffer allocated in prepareToPlay():
+    it never allocates, locks or touches a file. Finished tracks are handed
+    back through a lock-free FIFO and deleted on the message thread.
+
+    Every track is resampled to the output sample rate if its own rate differs,
+    so the source always plays at the output rate, and positions and lengths
+    are in output samples of the current track.
+*/
+class PlaylistAudioSource  : public PositionableAudioSource,
+                             private Timer
+{
+public:
+    /** A source to play, with the objects that feed it. */
+    struct Track
+    {
+        Track (std::unique_ptr<PositionableAudioSource> sourceToPlay, double sourceSampleRate,
+               int sourceNumChannels, ReadAheadAudioSource* readAheadSourceOfSource = nullptr)
+            : source (std::move (sourceToPlay)),
+              readAheadSource (readAheadSourceOfSource),
+              sampleRate (sourceSampleRate),
+              numChannels (jlimit (1, ChannelRouting::maxNumChannels, sourceNumChannels))
+        {
+        }
+
+        std::unique_ptr<PositionableAudioSource> source;
+        ReadAheadAudioSource* const readAheadSource;    // null for cached files
+        const double sampleRate;
+        const int numChannels;  // channels rendered by the source
+
+        // Follows the source, so it's deleted first
+        std::unique_ptr<MappedReaderPrefetcher> prefetcher;
+
+    private:
+        friend class PlaylistAudioSource;
+
+        // Set up when the track is prepared
+        std::unique_ptr<PolyphaseResamplingAudioSource> resampler;  // null if the rates match
+        double ratio = 1.0;     // source samples per output sample
+
+        // Set when the source is moved, the resampler is reset on the audio thread
+        std::atomic<bool> shouldResetResampler { false };
+
+        // Input the resampler has pulled but not played yet, published after
+        //  every block so the position can be read on any thread
+        std::atomic<double> numBufferedInputSamples { 0.0 };
+
+        void prepare (int blockSize, double outputSampleRate);
+        void release();
+        void render (const AudioSourceChannelInfo& info);
+
+        int64 getOutputPosition() const;
+        int64 getOutputLength() const;
+        void setOutputPosition (int64 position);
+
+        JUCE_DECLARE_NON_COPYABLE (Track)
+    };
+
+    //==========================================================================
+    explicit PlaylistAudioSource (std::unique_ptr<Track> firstTrack);
+    ~PlaylistAudioSource() override;
+
+    //==========================================================================
+    /** [Non-realtime] [Thread-safe]
+        Prepares a track and queues it to play after the current one. A track
+        queued earlier is replaced if it hasn't started yet, otherwise the new
+        track plays after it.
+    */
+    void queueTrack (std::unique_ptr<Track> track);
+
+    /** [Realtime] [Thread-safe]
+        Returns true if a queued track is waiting to start.
+    */
+    bool hasQueuedTrack() const { return nextTrack.load() != nullptr; }
+
+    /** [Realtime] [Thread-safe]
+        Sets the time over which the current track fades out while the next
+        one fades in. Zero splices the tracks without overlap. Applies from
+        the next boundary.
+    */
+    void setCrossfadeTime (double crossfadeInSeconds) { crossfadeTime.store (jmax (0.0, crossfadeInSeconds)); }
+    double getCrossfadeTime() const { return crossfadeTime.load(); }
+
+    /** [Realtime] [Thread-safe]
+        Returns the number of tracks that have started after the first one.
+    */
+    int getNumTrackChanges() const { return numTrackChanges.load(); }
+
+    /** Called on the message thread after a queued track has started. */
+    std::function<void()> onTrackChanged;
+
+    //==========================================================================
+    /** [Message thread]
+        Blocks until the next block of the current track is buffered or
+        the timeout expires.
+    */
+    bool waitForNextAudioBlockReady (int timeoutInMs) const;
+
+    /** [Message thread]
+        Returns the number of audio blocks that were played before they had
+        been read from disk, in all the tracks played so far.
+    */
+    int getNumReadAheadUnderruns() const;
+
+    //==========================================================================
+    /** [Non-realtime] Prepares the current and the queued track. */
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    void getNextAudioBlock (const AudioSourceChannelInfo& info) override;
+    void releaseResources() override;
+
+    //==========================================================================
+    /** [Message thread]
+        Moves the position in the current track. A crossfade in progress is
+        cut short, and the next track carries on at full gain.
+    */
+    void setNextReadPosition (int64 newPosition) override;
+
+    /** [Message thread] */
+    int64 getNextReadPosition() const override;
+
+    /** [Message thread] */
+    int64 getTotalLength() const override;
+
+    /** [Realtime] [Thread-safe] */
+    bool isLooping() const override { return looping.load(); }
+
+    /** [Realtime] [Thread-safe]
+        Loops the current track while no track is queued after it.
+    */
+    void setLooping (bool shouldLoop) override { looping.store (shouldLoop); }
+
+private:
+    //==========================================================================
+    inline static constexpr int maxNumRetiredTracks = 16;
+
+    // Channels of the fade buffer, enough for any track
+    inline static constexpr int maxNumChannels = ChannelRouting::maxNumChannels;
+
+    //==========================================================================
+    // The current track is swapped by the audio thread, and is deleted on
+    //  the message thread after it has been retired
+    std::atomic<Track*> currentTrack { nullptr };
+    std::atomic<Track*> nextTrack { nullptr };
+
+    // [Audio thread] The next track while it fades in
+    Track* incomingTrack = nullptr;
+    int64 fadeLength = 0;       // [samples]
+    int64 fadePosition = 0;     // [samples]
+
+    std::atomic<double> crossfadeTime { 0.0 };     // [s]
+    std::atomic<bool> looping { false };
+
+    //==========================================================================
+    // Preparation, never done on the audio thread
+    CriticalSection prepareLock;
+    bool isPrepared = false;
+    int blockSize = 0;
+    double outputSampleRate = 0.0;
+
+    // The incoming track is rendered here before it's mixed in
+    AudioBuffer<float> fadeBuffer;
+
+    //==========================================================================
+    // Tracks that have finished, for deletion on the message thread
+    AbstractFifo retiredFifo { maxNumRetiredTracks };
+    std::array<Track*, maxNumRetiredTracks> retiredTracks {};
+
+    std::atomic<int> numTrackChanges { 0 };
+    std::atomic<int> numRetiredUnderruns { 0 };
+    std::atomic<bool> isSeekPending { false };
+    int numTrackChangesNotified = 0;
+
+    /** [Audio thread] Makes the incoming track current. */
+    void startIncomingTrack();
+
+    /** [Audio thread] */
+    void retireTrack (Track* track);
+
+    /** [Audio thread] Renders the incoming track and adds it to the output
+        with a gain ramp.
+    */
+    void addIncomingTrack (const AudioSourceChannelInfo& info, int startInBlock,
+                           int numSamples, float startGain, float endGain);
+
+    /** Deletes the retired tracks and calls onTrackChanged */
+    void timerCallback() override;
+    void deleteRetiredTracks();
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PlaylistAudioSource)
+};
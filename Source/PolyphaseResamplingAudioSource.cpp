@@ -0,0 +1,298 @@
+/*
+  ==============================================================================
+
+    PolyphaseResamplingAudioSource.cpp
+    Created: 17 Oct 2026 5:48:26pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "PolyphaseResamplingAudioSource.h"
+
+namespace
+{
+    struct KernelSettings
+    {
+        int numTaps;            // at unity ratio
+        int phaseBits;          // log2 of the number of tabulated phases
+        double kaiserBeta;
+        double rolloff;         // cut-off relative to the Nyquist frequency
+    };
+
+    KernelSettings getKernelSettings (PolyphaseResamplingAudioSource::Quality quality)
+    {
+        using Quality = PolyphaseResamplingAudioSource::Quality;
+
+        switch (quality)
+        {
+            case Quality::fast:         return { 8, 6, 5.0, 0.80 };
+            case Quality::mastering:    return { 64, 10, 9.5, 0.95 };
+            case Quality::balanced:
+            default:                    return { 24, 8, 7.0, 0.90 };
+        }
+    }
+
+    /** Zeroth order modified Bessel function of the first kind */
+    double besselI0 (double x)
+    {
+        double sum = 1.0;
+        double term = 1.0;
+
+        for (int k = 1; k < 50 && term > sum * 1.0e-12; ++k)
+        {
+            const double t = x / (2.0 * k);
+            term *= t * t;
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    /** Dot product with independent accumulators, which compilers can map
+        onto vector registers
+    */
+    float dotProduct (const float* a, const float* b, int num) noexcept
+    {
+        float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+        int i = 0;
+
+        for (; i + 4 <= num; i += 4)
+        {
+            sum0 += a[i]     * b[i];
+            sum1 += a[i + 1] * b[i + 1];
+            sum2 += a[i + 2] * b[i + 2];
+            sum3 += a[i + 3] * b[i + 3];
+        }
+
+        for (; i < num; ++i)
+            sum0 += a[i] * b[i];
+
+        return (sum0 + sum1) + (sum2 + sum3);
+    }
+}
+
+//==============================================================================
+PolyphaseResamplingAudioSource::PolyphaseResamplingAudioSource (AudioSource* inputSource,
+                                                                int numChannels)
+    : input (inputSource), channels (jmax (1, numChannels))
+{
+    jassert (input != nullptr);
+}
+
+//==============================================================================
+void PolyphaseResamplingAudioSource::setResamplingRatio (double newRatio)
+{
+    // The input history is only large enough for the prepared max ratio
+    jassert (newRatio > 0.0 && newRatio <= maxRatio * 1.000001);
+
+    ratio = jlimit (0.01, maxRatio, newRatio);
+    step = static_cast<int64> (std::llround (ratio * static_cast<double> (one)));
+}
+
+void PolyphaseResamplingAudioSource::reset()
+{
+    history.clear();
+
+    // Start with a half kernel of silence, so the first output sample is
+    //  centred on the first input sample
+    const int halfTaps = numTaps / 2;
+    numInHistory = halfTaps - 1;
+    position = static_cast<int64> (halfTaps - 1) << fractionBits;
+}
+
+double PolyphaseResamplingAudioSource::getNumBufferedInputSamples() const
+{
+    return numInHistory - static_cast<double> (position) / static_cast<double> (one);
+}
+
+void PolyphaseResamplingAudioSource::skipInput (double numInputSamples)
+{
+    const auto numSkipped = jlimit (0.0, static_cast<double> (maxNumSkipped), numInputSamples);
+
+    // The next block pulls the input up to the new position
+    position += static_cast<int64> (std::llround (numSkipped * static_cast<double> (one)));
+}
+
+//==============================================================================
+void PolyphaseResamplingAudioSource::prepareToPlay (int samplesPerBlockExpected,
+                                                    double sampleRate)
+{
+    designKernel();
+
+    maxBlockSize = jmax (1, samplesPerBlockExpected);
+
+    // Largest input a block can require, plus the kernel length and room
+    //  for a block of skipped input
+    maxNumSkipped = static_cast<int> (std::ceil (maxBlockSize * maxRatio));
+    const int historySize = numTaps + 2 * maxNumSkipped + 4;
+    history.setSize (channels, historySize);
+
+    interpolatedKernel.calloc (static_cast<size_t> (kernelStride));
+
+    reset();
+    setResamplingRatio (jmin (ratio, maxRatio));
+
+    // The input is pulled in blocks that depend on the ratio
+    input->prepareToPlay (static_cast<int> (std::ceil (maxBlockSize * maxRatio)) + 2,
+                          sampleRate * maxRatio);
+}
+
+void PolyphaseResamplingAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    // Split blocks larger than the prepared size, so the history never overflows
+    for (int done = 0; done < bufferToFill.numSamples; done += maxBlockSize)
+    {
+        const int numSamples = jmin (maxBlockSize, bufferToFill.numSamples - done);
+        processBlock (AudioSourceChannelInfo (bufferToFill.buffer,
+                                              bufferToFill.startSample + done,
+                                              numSamples));
+    }
+}
+
+void PolyphaseResamplingAudioSource::releaseResources()
+{
+    input->releaseResources();
+
+    history.setSize (channels, 0);
+    kernel.free();
+    interpolatedKernel.free();
+}
+
+//==============================================================================
+void PolyphaseResamplingAudioSource::designKernel()
+{
+    const auto settings = getKernelSettings (quality);
+
+    // Drift correction alone doesn't call for a longer kernel
+    const double downsamplingRatio = maxRatio > 1.01 ? maxRatio : 1.0;
+
+    // When downsampling, the cut-off follows the output Nyquist frequency,
+    //  and the kernel gets longer to keep the same transition steepness
+    const double cutoff = settings.rolloff / downsamplingRatio;
+    numTaps = 2 * static_cast<int> (std::ceil (0.5 * settings.numTaps * downsamplingRatio));
+    phaseBits = settings.phaseBits;
+    numPhases = 1 << phaseBits;
+    kernelStride = (numTaps + 7) & ~7;
+
+    kernel.calloc (static_cast<size_t> ((numPhases + 1) * kernelStride));
+
+    const int halfTaps = numTaps / 2;
+    const double windowNorm = 1.0 / besselI0 (settings.kaiserBeta);
+
+    for (int phase = 0; phase <= numPhases; ++phase)
+    {
+        float* row = kernel + phase * kernelStride;
+        const double fraction = static_cast<double> (phase) / numPhases;
+        double sum = 0.0;
+
+        for (int tap = 0; tap < numTaps; ++tap)
+        {
+            // Distance from the output position to the input sample of this tap
+            const double t = tap - halfTaps + 1 - fraction;
+            const double x = MathConstants<double>::pi * cutoff * t;
+            const double sinc = std::abs (x) < 1.0e-9 ? 1.0 : std::sin (x) / x;
+
+            const double w = t / halfTaps;
+            const double window = std::abs (w) < 1.0
+                                ? besselI0 (settings.kaiserBeta * std::sqrt (1.0 - w * w)) * windowNorm
+                                : 0.0;
+
+            const double value = cutoff * sinc * window;
+            row[tap] = static_cast<float> (value);
+            sum += value;
+        }
+
+        // Unity gain at DC for every phase
+        if (sum != 0.0)
+            FloatVectorOperations::multiply (row, static_cast<float> (1.0 / sum), numTaps);
+    }
+}
+
+//==============================================================================
+void PolyphaseResamplingAudioSource::processBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    const int numSamples = bufferToFill.numSamples;
+    const int halfTaps = numTaps / 2;
+
+    if (numSamples <= 0 || numTaps == 0)
+        return;
+
+    //==========================================================================
+    // Pull the input that the last output sample of the block needs
+    const int64 lastPosition = position + (numSamples - 1) * step;
+    const int numRequired = static_cast<int> (lastPosition >> fractionBits) + halfTaps + 1;
+    const int numNew = jlimit (0, history.getNumSamples() - numInHistory,
+                               numRequired - numInHistory);
+
+    jassert (numRequired <= history.getNumSamples());
+
+    if (numNew > 0)
+    {
+        input->getNextAudioBlock (AudioSourceChannelInfo (&history, numInHistory, numNew));
+        numInHistory += numNew;
+    }
+
+    //==========================================================================
+    // Compute the output
+    const int interpolationBits = fractionBits - phaseBits;
+    const int64 interpolationMask = (int64 { 1 } << interpolationBits) - 1;
+    const float interpolationScale = 1.0f / static_cast<float> (int64 { 1 } << interpolationBits);
+
+    // Integer ratios keep the position on the phase grid, so the tabulated
+    //  kernels can be used without interpolation
+    const bool isOnPhaseGrid = ((position | step) & interpolationMask) == 0;
+
+    const int numOutputChannels = bufferToFill.buffer->getNumChannels();
+    const int numChannelsToProcess = jmin (channels, numOutputChannels);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const int firstInput = static_cast<int> (position >> fractionBits) - halfTaps + 1;
+        const int64 fraction = position & (one - 1);
+        const int phase = static_cast<int> (fraction >> interpolationBits);
+
+        const float* coefficients = kernel + phase * kernelStride;
+
+        if (! isOnPhaseGrid)
+        {
+            // Interpolate between the neighbouring phases once for all channels
+            const float a = static_cast<float> (fraction & interpolationMask) * interpolationScale;
+
+            FloatVectorOperations::multiply (interpolatedKernel, coefficients, 1.0f - a, numTaps);
+            FloatVectorOperations::addWithMultiply (interpolatedKernel, coefficients + kernelStride,
+                                                    a, numTaps);
+            coefficients = interpolatedKernel;
+        }
+
+        for (int ch = 0; ch < numChannelsToProcess; ++ch)
+        {
+            bufferToFill.buffer->setSample (ch, bufferToFill.startSample + i,
+                                            dotProduct (history.getReadPointer (ch, firstInput),
+                                                        coefficients, numTaps));
+        }
+
+        position += step;
+    }
+
+    for (int ch = numChannelsToProcess; ch < numOutputChannels; ++ch)
+        bufferToFill.buffer->clear (ch, bufferToFill.startSample, numSamples);
+
+    //==========================================================================
+    // Drop the input that the next block won't need
+    const int numConsumed = jlimit (0, numInHistory,
+                                    static_cast<int> (position >> fractionBits) - halfTaps + 1);
+
+    if (numConsumed > 0)
+    {
+        for (int ch = 0; ch < channels; ++ch)
+        {
+            auto* data = history.getWritePointer (ch);
+            std::memmove (data, data + numConsumed,
+                          static_cast<size_t> (numInHistory - numConsumed) * sizeof (float));
+        }
+
+        numInHistory -= numConsumed;
+        position -= static_cast<int64> (numConsumed) << fractionBits;
+    }
+}
@@ -0,0 +1,133 @@
+/*
+  ==============================================================================
+
+    PolyphaseResamplingAudioSource.h
+    Created: 17 Oct 2026 5:48:26pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Windowed-sinc polyphase resampler with a continuously variable ratio.
+
+    The kernel is tabulated for a number of phases and linearly interpolated
+    between them, so the ratio can follow drift correction without glitches.
+    The interpolated kernel of every output sample is computed once and shared
+    by all channels. When the ratio and the read position fall on the phase
+    grid, as with integer ratios like 44.1 kHz to 88.2 kHz, the tabulated
+    kernels are used directly.
+
+    All buffers are allocated in prepareToPlay(), so processing never touches
+    the allocator, whatever the ratio.
+*/
+class PolyphaseResamplingAudioSource  : public AudioSource
+{
+public:
+    enum class Quality
+    {
+        fast,           // short kernel, for many devices or slow machines
+        balanced,
+        mastering       // long kernel with a steep cut-off
+    };
+
+    //==========================================================================
+    /** Creates a resampler.
+
+        @param inputSource      source to resample. It's not owned
+        @param numChannels      number of channels to process
+    */
+    PolyphaseResamplingAudioSource (AudioSource* inputSource, int numChannels);
+
+    //==========================================================================
+    /** [Non-realtime] [Non-thread-safe]
+        Sets the kernel quality. Applies from the next prepareToPlay() call.
+    */
+    void setQuality (Quality newQuality) { quality = newQuality; }
+    Quality getQuality() const { return quality; }
+
+    /** [Non-realtime] [Non-thread-safe]
+        Sets the largest ratio that will be requested. The kernel cut-off is
+        lowered for it to avoid aliasing, and the input buffer is sized for it.
+        Applies from the next prepareToPlay() call.
+    */
+    void setMaxResamplingRatio (double newMaxRatio) { maxRatio = jmax (0.01, newMaxRatio); }
+
+    /** [Realtime] [Non-thread-safe]
+        Sets the number of input samples per output sample. Must not exceed
+        the max ratio the resampler has been prepared with.
+    */
+    void setResamplingRatio (double newRatio);
+    double getResamplingRatio() const { return ratio; }
+
+    /** [Realtime] [Non-thread-safe]
+        Clears the resampler history.
+    */
+    void reset();
+
+    /** [Realtime] [Non-thread-safe]
+        Returns the number of input samples that have been pulled but not yet
+        played, counted from the position of the next output sample. The
+        kernel is centred on that position, so this is the delay the resampler
+        adds, in input samples.
+    */
+    double getNumBufferedInputSamples() const;
+
+    /** [Realtime] [Non-thread-safe]
+        Moves the position of the next output sample forward, skipping up to
+        one block of input. The skip can be fractional.
+    */
+    void skipInput (double numInputSamples);
+
+    //==========================================================================
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
+    void releaseResources() override;
+
+private:
+    AudioSource* const input;
+    const int channels;
+
+    Quality quality = Quality::balanced;
+    double maxRatio = 1.0;
+    double ratio = 1.0;
+
+    //==========================================================================
+    // Kernel table: numPhases + 1 rows of numTaps coefficients, each row
+    //  padded to kernelStride
+    HeapBlock<float> kernel;
+    int numTaps = 0;
+    int numPhases = 0;
+    int kernelStride = 0;
+    int phaseBits = 0;
+
+    // Kernel interpolated for the current output sample
+    HeapBlock<float> interpolatedKernel;
+
+    void designKernel();
+
+    //==========================================================================
+    // Input history. The read position is a fixed point number of input
+    //  samples relative to the start of the history.
+    AudioBuffer<float> history;
+    int numInHistory = 0;
+    int maxBlockSize = 0;
+    int maxNumSkipped = 0;      // input samples the history has room to skip
+
+    int64 position = 0;
+    int64 step = 0;
+
+    /** Processes a block that is not larger than maxBlockSize. */
+    void processBlock (const AudioSourceChannelInfo& bufferToFill);
+
+    //==========================================================================
+    inline static constexpr int fractionBits = 32;
+    inline static constexpr int64 one = int64 { 1 } << fractionBits;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PolyphaseResamplingAudioSource)
+};
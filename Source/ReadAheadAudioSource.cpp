@@ -0,0 +1,289 @@
+/*
+  ==============================================================================
+
+    ReadAheadAudioSource.cpp
+    Created: 17 Oct 2026 2:41:18pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "ReadAheadAudioSource.h"
+
+ReadAheadAudioSource::ReadAheadAudioSource (PositionableAudioSource* sourceToRead,
+                                            bool deleteSourceWhenDeleted,
+                                            TimeSliceThread& readAheadThread,
+                                            double readAheadInSeconds,
+                                            int numChannels)
+    : source (sourceToRead, deleteSourceWhenDeleted),
+      backgroundThread (readAheadThread),
+      readAheadTime (jmax (0.0, readAheadInSeconds)),
+      numBufferedChannels (jmax (1, numChannels))
+{
+    jassert (source != nullptr);
+
+    looping.store (source->isLooping());
+
+    //==========================================================================
+    // Check that atomic position and counters are lock-free
+    static_assert (std::atomic<int64>::is_always_lock_free,
+                   "std::atomic for type int64 must be always lock free");
+    static_assert (std::atomic<int>::is_always_lock_free,
+                   "std::atomic for type int must be always lock free");
+}
+
+ReadAheadAudioSource::~ReadAheadAudioSource()
+{
+    releaseResources();
+}
+
+//==============================================================================
+void ReadAheadAudioSource::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    // Stop background reading while the buffer is reallocated
+    backgroundThread.removeTimeSliceClient (this);
+
+    blockSize = jmax (1, samplesPerBlockExpected);
+
+    // Keep at least a few blocks, so that a short window still works
+    const int newBufferSize = jmax (4 * blockSize,
+                                    roundToInt (readAheadTime * sampleRate));
+
+    if (newBufferSize != bufferSize || buffer.getNumChannels() != numBufferedChannels)
+    {
+        bufferSize = newBufferSize;
+        buffer.setSize (numBufferedChannels, bufferSize);
+    }
+
+    source->prepareToPlay (jmin (maxChunkSize, bufferSize), sampleRate);
+
+    {
+        SpinLock::ScopedLockType rangeLock (bufferRangeLock);
+        discardBufferFrom (nextPlayPosition.load());
+    }
+
+    numUnderruns.store (0);
+    isPrepared = true;
+
+    backgroundThread.addTimeSliceClient (this);
+}
+
+void ReadAheadAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    SpinLock::ScopedLockType rangeLock (bufferRangeLock);
+
+    const auto position = nextPlayPosition.load();
+    const auto numSamples = bufferToFill.numSamples;
+
+    // Part of the block that is buffered
+    const auto bufferedStart = jlimit (validStart, validEnd, position);
+    const auto bufferedEnd = jlimit (validStart, validEnd, position + numSamples);
+    const auto numBuffered = static_cast<int> (bufferedEnd - bufferedStart);
+
+    if (numBuffered < numSamples)
+    {
+        bufferToFill.clearActiveBufferRegion();
+
+        if (isPrepared)
+            numUnderruns.store (numUnderruns.load() + 1);
+    }
+
+    if (numBuffered > 0)
+    {
+        copyFromRing (*bufferToFill.buffer,
+                      bufferToFill.startSample + static_cast<int> (bufferedStart - position),
+                      bufferedStart,
+                      numBuffered);
+    }
+
+    nextPlayPosition.store (position + numSamples);
+}
+
+void ReadAheadAudioSource::releaseResources()
+{
+    backgroundThread.removeTimeSliceClient (this);
+
+    isPrepared = false;
+    source->releaseResources();
+
+    {
+        SpinLock::ScopedLockType rangeLock (bufferRangeLock);
+        discardBufferFrom (nextPlayPosition.load());
+    }
+
+    buffer.setSize (numBufferedChannels, 0);
+    bufferSize = 0;
+}
+
+//==============================================================================
+void ReadAheadAudioSource::setNextReadPosition (int64 newPosition)
+{
+    {
+        SpinLock::ScopedLockType rangeLock (bufferRangeLock);
+
+        nextPlayPosition.store (newPosition);
+        loopEnd.store (0);
+
+        if (newPosition < validStart || newPosition >= validEnd)
+            discardBufferFrom (newPosition);
+    }
+
+    // Refill from the new position straight away
+    if (isPrepared)
+        backgroundThread.moveToFrontOfQueue (this);
+}
+
+int64 ReadAheadAudioSource::getNextReadPosition() const
+{
+    const auto position = nextPlayPosition.load();
+    const auto length = getTotalLength();
+
+    return looping.load() && length > 0 ? position % length : position;
+}
+
+void ReadAheadAudioSource::setLooping (bool shouldLoop)
+{
+    if (looping.exchange (shouldLoop) == shouldLoop)
+        return;
+
+    const auto length = source->getTotalLength();
+
+    if (length <= 0)
+        return;
+
+    SpinLock::ScopedLockType rangeLock (bufferRangeLock);
+
+    const auto position = nextPlayPosition.load();
+
+    // Samples before the next loop point don't depend on the looping mode,
+    //  so the buffer keeps them. Without looping, the source ends there
+    const auto nextLoopPoint = (position / length + 1) * length;
+
+    loopEnd.store (shouldLoop ? 0 : nextLoopPoint);
+
+    if (validEnd > nextLoopPoint)
+    {
+        validEnd = jmax (validStart, nextLoopPoint);
+        ++generation;
+    }
+}
+
+//==============================================================================
+bool ReadAheadAudioSource::waitForNextAudioBlockReady (int timeoutInMs) const
+{
+    const auto startTime = Time::getMillisecondCounter();
+
+    for (;;)
+    {
+        {
+            SpinLock::ScopedLockType rangeLock (bufferRangeLock);
+            const auto position = nextPlayPosition.load();
+
+            if (! isPrepared
+                || (position >= validStart && position + blockSize <= validEnd))
+                return true;
+        }
+
+        if (Time::getMillisecondCounter() - startTime >= static_cast<uint32> (timeoutInMs))
+            return false;
+
+        Thread::sleep (1);
+    }
+}
+
+//==============================================================================
+void ReadAheadAudioSource::discardBufferFrom (int64 position)
+{
+    validStart = position;
+    validEnd = position;
+    ++generation;
+}
+
+int ReadAheadAudioSource::useTimeSlice()
+{
+    return readNextChunk() ? 1 : idleWaitTime;
+}
+
+bool ReadAheadAudioSource::readNextChunk()
+{
+    int64 chunkStart = 0;
+    int64 chunkEnd = 0;
+    uint32 chunkGeneration = 0;
+    bool shouldReadLooped = false;
+
+    {
+        SpinLock::ScopedLockType rangeLock (bufferRangeLock);
+
+        const auto position = nextPlayPosition.load();
+
+        // Samples before the playback position have been played and can be
+        //  overwritten. If playback has overtaken the buffer, start over.
+        if (position >= validStart && position <= validEnd)
+            validStart = position;
+        else
+            discardBufferFrom (position);
+
+        chunkStart = validEnd;
+        chunkEnd = jmin (validStart + bufferSize, chunkStart + maxChunkSize);
+        chunkGeneration = generation;
+
+        // Up to the end of the last pass, the position is still beyond the
+        //  length of the source, so it's read looped
+        const auto end = loopEnd.load();
+        shouldReadLooped = looping.load() || chunkStart < end;
+
+        if (! looping.load() && chunkStart < end)
+            chunkEnd = jmin (chunkEnd, end);
+    }
+
+    if (chunkEnd <= chunkStart)
+        return false;
+
+    // The source is only touched on this thread, so its looping mode is
+    //  applied here
+    if (source->isLooping() != shouldReadLooped)
+        source->setLooping (shouldReadLooped);
+
+    source->setNextReadPosition (chunkStart);
+
+    // Read into the ring buffer, in two parts if the chunk wraps around
+    const auto ringStart = static_cast<int> (chunkStart % bufferSize);
+    const auto numSamples = static_cast<int> (chunkEnd - chunkStart);
+    const auto numBeforeWrap = jmin (numSamples, bufferSize - ringStart);
+
+    source->getNextAudioBlock (AudioSourceChannelInfo (&buffer, ringStart, numBeforeWrap));
+
+    if (numSamples > numBeforeWrap)
+        source->getNextAudioBlock (AudioSourceChannelInfo (&buffer, 0, numSamples - numBeforeWrap));
+
+    {
+        SpinLock::ScopedLockType rangeLock (bufferRangeLock);
+
+        // Publish the chunk only if nothing was discarded while reading it
+        if (generation == chunkGeneration && validEnd == chunkStart)
+            validEnd = chunkEnd;
+    }
+
+    return true;
+}
+
+void ReadAheadAudioSource::copyFromRing (AudioBuffer<float>& dest, int destStart,
+                                         int64 position, int numSamples) const
+{
+    const auto ringStart = static_cast<int> (position % bufferSize);
+    const auto numBeforeWrap = jmin (numSamples, bufferSize - ringStart);
+    const auto numChannels = jmin (dest.getNumChannels(), numBufferedChannels);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        dest.copyFrom (ch, destStart, buffer, ch, ringStart, numBeforeWrap);
+
+        if (numSamples > numBeforeWrap)
+            dest.copyFrom (ch, destStart + numBeforeWrap,
+                           buffer, ch, 0, numSamples - numBeforeWrap);
+    }
+
+    // Channels that the source doesn't have are silent
+    for (int ch = numChannels; ch < dest.getNumChannels(); ++ch)
+        dest.clear (ch, destStart, numSamples);
+}
@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    ReadAheadAudioSource.h
+    Created: 17 Oct 2026 2:41:18pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Positionable source that reads another positionable source ahead of
+    the playback position on a background thread.
+
+    The audio callback only copies samples from a ring buffer, so slow disks
+    never block it. When the requested samples are not buffered yet, the missing
+    part of the block is filled with silence and an underrun is counted.
+
+    Positions are counted on a continuous timeline, so when the source is
+    looping, the start of the file is read ahead before the loop point is
+    reached. A seek or a change of the looping mode discards the buffered
+    samples that are no longer valid and moves the source to the front of
+    the background thread queue, so the buffer is refilled immediately.
+*/
+class ReadAheadAudioSource  : public PositionableAudioSource,
+                              private TimeSliceClient
+{
+public:
+    /** Creates a ReadAheadAudioSource.
+
+        @param sourceToRead         source to read ahead
+        @param deleteSourceWhenDeleted  if true, the source is deleted with
+                                    this object
+        @param readAheadThread      thread that fills the buffer. It must be
+                                    started by the caller
+        @param readAheadInSeconds   size of the look-ahead window
+        @param numChannels          number of channels to buffer
+    */
+    ReadAheadAudioSource (PositionableAudioSource* sourceToRead,
+                          bool deleteSourceWhenDeleted,
+                          TimeSliceThread& readAheadThread,
+                          double readAheadInSeconds,
+                          int numChannels = 2);
+
+    ~ReadAheadAudioSource() override;
+
+    //==========================================================================
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
+    void releaseResources() override;
+
+    //==========================================================================
+    /** [Non-realtime] [Thread-safe]
+        Moves the playback position. If the new position is not buffered,
+        the buffer is refilled from it straight away.
+    */
+    void setNextReadPosition (int64 newPosition) override;
+
+    int64 getNextReadPosition() const override;
+    /** [Realtime] [Thread-safe]
+        Returns the length of the source, or the end of the current pass
+        through it if looping was turned off during a later pass.
+    */
+    int64 getTotalLength() const override { return jmax (source->getTotalLength(), loopEnd.load()); }
+
+    /** [Realtime] [Thread-safe] */
+    bool isLooping() const override { return looping.load(); }
+
+    /** [Realtime] [Thread-safe]
+        Buffered samples past the loop point are discarded when the looping
+        mode changes, because they depend on it. When looping is turned off,
+        the position stays on the continuous timeline, and the source plays
+        on to the next loop point and ends there.
+    */
+    void setLooping (bool shouldLoop) override;
+
+    //==========================================================================
+    /** [Non-realtime] [Thread-safe]
+        Blocks until the next audio block is buffered or the timeout expires.
+
+        @returns    true if the block is buffered.
+    */
+    bool waitForNextAudioBlockReady (int timeoutInMs) const;
+
+    /** [Realtime] [Thread-safe]
+        Returns the number of audio blocks that were not fully buffered
+        since the source was prepared.
+    */
+    int getNumUnderruns() const { return numUnderruns.load(); }
+
+private:
+    OptionalScopedPointer<PositionableAudioSource> source;
+    TimeSliceThread& backgroundThread;
+
+    const double readAheadTime;
+    const int numBufferedChannels;
+
+    //==========================================================================
+    // Ring buffer that holds the samples of the [validStart, validEnd) range
+    //  of the source. Sample at position p is stored at p % buffer size.
+    AudioBuffer<float> buffer;
+    int bufferSize = 0;
+    int blockSize = 0;
+    bool isPrepared = false;
+
+    // The range, the playback position and the generation are only changed
+    //  while the lock is held. The lock is never held during disk reads.
+    SpinLock bufferRangeLock;
+    int64 validStart = 0;
+    int64 validEnd = 0;
+    std::atomic<int64> nextPlayPosition { 0 };
+
+    // End of the pass through the source that was playing when looping was
+    //  turned off. Samples before it are still read looped
+    std::atomic<int64> loopEnd { 0 };
+
+    // Incremented whenever buffered samples are discarded, so that a chunk
+    //  that was being read at the time is not published
+    uint32 generation = 0;
+
+    std::atomic<bool> looping { false };
+    std::atomic<int> numUnderruns { 0 };
+
+    /** Must be called with bufferRangeLock held. */
+    void discardBufferFrom (int64 position);
+
+    //==========================================================================
+    // Background reading
+    int useTimeSlice() override;
+
+    /** [Background thread only]
+        Reads the next chunk of the source into the buffer.
+
+        @returns    false if the buffer is already full.
+    */
+    bool readNextChunk();
+
+    /** Copies samples between the ring buffer and a linear buffer. */
+    void copyFromRing (AudioBuffer<float>& dest, int destStart,
+                       int64 position, int numSamples) const;
+
+    //==========================================================================
+    // Largest number of samples read from the source at a time
+    inline static constexpr int maxChunkSize = 8192;
+
+    // Time waited by the background thread when the buffer is full [ms]
+    inline static constexpr int idleWaitTime = 20;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReadAheadAudioSource)
+};
@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    RenderAheadAudioSource.cpp
+    Created: 17 Oct 2026 11:58:40pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "RenderAheadAudioSource.h"
+
+RenderAheadAudioSource::RenderAheadAudioSource (AudioSource* sourceToRender)
+    : Thread ("Render-ahead"),
+      source (sourceToRender)
+{
+    //==========================================================================
+    // Check that atomic int64 is lock-free
+    static_assert (std::atomic<int64>::is_always_lock_free,
+                   "std::atomic for type int64 must be always lock free");
+}
+
+RenderAheadAudioSource::~RenderAheadAudioSource()
+{
+    stopThread (prefillTimeout);
+}
+
+//==============================================================================
+void RenderAheadAudioSource::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    stopThread (prefillTimeout);
+    ring.detachReader (0);
+
+    if (source != nullptr)
+        source->prepareToPlay (samplesPerBlockExpected, sampleRate);
+
+    renderBlockSize = jmax (1, samplesPerBlockExpected);
+    renderBuffer.setSize (numChannels, renderBlockSize);
+
+    // The ring holds the render-ahead time plus the block being rendered
+    const auto numSamplesAhead = jmax (renderBlockSize,
+                                       roundToInt (sampleRate * 0.001 * renderAheadTime));
+    ring.setSize (numChannels, numSamplesAhead + renderBlockSize);
+
+    // Poll a few times within the render-ahead time, so that the ring is
+    //  topped up long before it runs out
+    pollInterval = jlimit (1, 5, roundToInt (renderAheadTime / 4.0));
+
+    numSamplesRendered = 0;
+    numSamplesPlayed = 0;
+    streamStartTime.store (0);
+    ticksPerSample = static_cast<double> (Time::getHighResolutionTicksPerSecond()) / sampleRate;
+    numUnderruns.store (0);
+
+    // The consumer isn't running yet, so its read cursor is activated here
+    //  to keep the producer from overwriting the prefill
+    ring.attachReader (0);
+    ring.getNumReady (0);
+
+    startThread (Thread::Priority::highest);
+
+    // Start playback with a full ring
+    for (int waited = 0; waited < prefillTimeout; ++waited)
+    {
+        if (ring.getNumReady (0) >= numSamplesAhead)
+            break;
+
+        Thread::sleep (1);
+    }
+}
+
+void RenderAheadAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    const auto numPopped = ring.pop (0, bufferToFill);
+
+    if (numPopped < bufferToFill.numSamples)
+    {
+        // The missing samples are played later, after the silence
+        bufferToFill.buffer->clear (bufferToFill.startSample + numPopped,
+                                    bufferToFill.numSamples - numPopped);
+
+        // There is only one writer, so read-modify-write is not needed
+        numUnderruns.store (numUnderruns.load (std::memory_order_relaxed) + 1);
+    }
+
+    numSamplesPlayed += numPopped;
+}
+
+void RenderAheadAudioSource::releaseResources()
+{
+    stopThread (prefillTimeout);
+    ring.detachReader (0);
+
+    if (source != nullptr)
+        source->releaseResources();
+}
+
+//==============================================================================
+void RenderAheadAudioSource::setNextBlockOutputTime (int64 hostTimeInTicks)
+{
+    // Sample n of the stream leaves the output at streamStartTime + n samples
+    streamStartTime.store (hostTimeInTicks
+                               - static_cast<int64> (static_cast<double> (numSamplesPlayed) * ticksPerSample),
+                           std::memory_order_relaxed);
+}
+
+int64 RenderAheadAudioSource::getRenderBlockOutputTime() const
+{
+    return streamStartTime.load (std::memory_order_relaxed)
+         + static_cast<int64> (static_cast<double> (numSamplesRendered) * ticksPerSample);
+}
+
+//==============================================================================
+void RenderAheadAudioSource::run()
+{
+    while (! threadShouldExit())
+    {
+        if (ring.getFreeSpace() >= renderBlockSize)
+            renderNextBlock();
+        else
+            wait (pollInterval);
+    }
+}
+
+void RenderAheadAudioSource::renderNextBlock()
+{
+    const AudioSourceChannelInfo info (&renderBuffer, 0, renderBlockSize);
+
+    if (source == nullptr)
+    {
+        info.clearActiveBufferRegion();
+    }
+    else if (profiler != nullptr)
+    {
+        const StageProfiler::ScopedTimer renderTimer (*profiler, profiledStage);
+        source->getNextAudioBlock (info);
+    }
+    else
+    {
+        source->getNextAudioBlock (info);
+    }
+
+    ring.push (info);
+    numSamplesRendered += renderBlockSize;
+}
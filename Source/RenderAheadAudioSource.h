@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    RenderAheadAudioSource.h
+    Created: 17 Oct 2026 11:58:40pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AudioFifo.h"
+#include "StageProfiler.h"
+
+/**
+    Renders another source on a high priority producer thread, a set time
+    ahead of playback, into a ring buffer.
+
+    The audio callback that plays this source only copies from the ring, so
+    the cost of a heavy source is taken off the device deadline, and a render
+    time spike is absorbed as long as it's shorter than the render-ahead time.
+    The render-ahead time adds to the output latency.
+
+    The rendered source is called from the producer thread only. The producer
+    polls the ring rather than being woken by the audio callback, so the
+    callback never touches a lock or a system call.
+*/
+class RenderAheadAudioSource  : public AudioSource,
+                                private Thread
+{
+public:
+    /** Creates a source that renders another one ahead.
+
+        @param sourceToRender   source to render. It's not owned
+    */
+    explicit RenderAheadAudioSource (AudioSource* sourceToRender);
+    ~RenderAheadAudioSource() override;
+
+    //==========================================================================
+    /** [Non-realtime] [Non-thread-safe]
+        Changes the rendered source. Must not be called while the source is
+        prepared.
+    */
+    void setSource (AudioSource* newSource) { source = newSource; }
+
+    /** [Non-realtime] [Non-thread-safe]
+        Sets how far ahead of playback the source is rendered. Applies from
+        the next prepareToPlay() call.
+    */
+    void setRenderAheadTime (double renderAheadInMs) { renderAheadTime = jmax (0.0, renderAheadInMs); }
+    double getRenderAheadTime() const { return renderAheadTime; }
+
+    /** [Non-realtime] [Non-thread-safe]
+        Sets the number of channels rendered into the ring. Applies from
+        the next prepareToPlay() call.
+    */
+    void setNumChannels (int newNumChannels) { numChannels = jmax (1, newNumChannels); }
+
+    /** [Non-realtime] [Non-thread-safe]
+        Times the rendering of the source into a stage of a profiler, from
+        the producer thread. Pass nullptr to stop timing.
+    */
+    void setProfiler (StageProfiler* profilerToUse, int stageToTime)
+    {
+        profiler = profilerToUse;
+        profiledStage = stageToTime;
+    }
+
+    //==========================================================================
+    /** [Non-realtime] Prepares the source and starts the producer thread,
+        which fills the ring before this returns.
+    */
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+
+    /** [Realtime] Copies the next block from the ring. */
+    void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
+
+    /** [Non-realtime] Stops the producer thread and releases the source. */
+    void releaseResources() override;
+
+    //==========================================================================
+    /** [Realtime] [Thread-safe]
+        Returns the number of blocks that found the ring short of samples,
+        since the source was prepared.
+    */
+    int getNumUnderruns() const { return numUnderruns.load(); }
+
+    /** [Non-realtime] [Non-thread-safe]
+        Returns the largest number of samples that are rendered ahead of
+        playback, which is the latency the source adds. Valid after
+        prepareToPlay().
+    */
+    int getLatencyInSamples() const { return ring.getTotalSize(); }
+
+    //==========================================================================
+    /** [Realtime] [Consumer thread only]
+        Sets the host time at which the first sample of the next block played
+        from the ring leaves the output, in Time::getHighResolutionTicks()
+        units.
+    */
+    void setNextBlockOutputTime (int64 hostTimeInTicks);
+
+    /** [Realtime] [Producer thread only]
+        Returns the host time at which the first sample of the block that the
+        source is rendering leaves the output.
+    */
+    int64 getRenderBlockOutputTime() const;
+
+private:
+    AudioSource* source = nullptr;
+    double renderAheadTime = 0.0;   // [ms]
+
+    int numChannels = 2;
+
+    StageProfiler* profiler = nullptr;
+    int profiledStage = 0;
+
+    //==========================================================================
+    // Ring of rendered samples, read by a single consumer
+    AudioFifo ring;
+    AudioBuffer<float> renderBuffer;
+
+    int renderBlockSize = 0;
+    int pollInterval = 1;       // [ms]
+
+    //==========================================================================
+    // Sample counts of both ends of the ring, and the host time at which
+    //  sample 0 of the stream leaves the output, derived from the consumer
+    int64 numSamplesRendered = 0;       // [Producer thread]
+    int64 numSamplesPlayed = 0;         // [Consumer thread]
+    std::atomic<int64> streamStartTime { 0 };
+    double ticksPerSample = 0.0;
+
+    std::atomic<int> numUnderruns { 0 };
+
+    //==========================================================================
+    /** [Producer thread] Keeps the ring filled. */
+    void run() override;
+
+    /** [Producer thread] Renders one block into the ring. */
+    void renderNextBlock();
+
+    //==========================================================================
+    // Longest time to wait for the ring to fill in prepareToPlay() [ms]
+    inline static constexpr int prefillTimeout = 500;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderAheadAudioSource)
+};
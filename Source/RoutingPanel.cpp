@@ -0,0 +1,202 @@
+/*
+  ==============================================================================
+
+    RoutingPanel.cpp
+    Created: 18 Oct 2026 1:52:10am
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "RoutingPanel.h"
+
+//==============================================================================
+RoutingPanel::RoutingPanel (MultiDevicePlayer& multiDevice)
+    : mdp (multiDevice),
+      routing (multiDevice.getChannelRouting())
+{
+    // Routing panel label:
+    addAndMakeVisible (routingPanelLabel);
+    routingPanelLabel.setFont (headingFont);
+    const auto headingColour
+    = getLookAndFeel().findColour (AppLookAndFeel::headingColourId);
+    routingPanelLabel.setColour (Label::textColourId, headingColour);
+    routingPanelLabel.setText ("Channel Routing", dontSendNotification);
+
+    // Number of source channels:
+    addAndMakeVisible (sourceChannelsBox);
+    addAndMakeVisible (sourceChannelsLabel);
+    sourceChannelsLabel.setText ("Source Channels", dontSendNotification);
+
+    for (int numChannels = 1; numChannels <= ChannelRouting::maxNumChannels; ++numChannels)
+        sourceChannelsBox.addItem (String (numChannels), numChannels);
+
+    sourceChannelsBox.setSelectedId (routing.getNumSourceChannels(), dontSendNotification);
+    sourceChannelsBox.onChange = [this]
+    {
+        routing.setNumSourceChannels (sourceChannelsBox.getSelectedId());
+        mdp.setChannelRouting (routing);
+
+        rebuildRows();
+    };
+
+    // Output rows:
+    for (int device = 0; device <= mdp.getNumLinkedDevices(); ++device)
+        getDeviceManager (device).addChangeListener (this);
+
+    rebuildRows();
+}
+
+RoutingPanel::~RoutingPanel()
+{
+    for (int device = 0; device <= mdp.getNumLinkedDevices(); ++device)
+        getDeviceManager (device).removeChangeListener (this);
+}
+
+//==============================================================================
+AudioDeviceManager& RoutingPanel::getDeviceManager (int device)
+{
+    return device == 0 ? mdp.mainDeviceManager
+                       : mdp.getLinkedDeviceManager (device - 1);
+}
+
+Array<int> RoutingPanel::getNumDeviceOutputs()
+{
+    Array<int> numOutputs;
+
+    for (int device = 0; device <= mdp.getNumLinkedDevices(); ++device)
+    {
+        auto* audioDevice = getDeviceManager (device).getCurrentAudioDevice();
+
+        numOutputs.add (audioDevice != nullptr
+                            ? jmin (audioDevice->getActiveOutputChannels().countNumberOfSetBits(),
+                                    ChannelRouting::maxNumChannels)
+                            : 0);
+    }
+
+    return numOutputs;
+}
+
+void RoutingPanel::updateRows()
+{
+    if (getNumDeviceOutputs() != numDeviceOutputs)
+        rebuildRows();
+    else
+        refreshButtons();
+}
+
+void RoutingPanel::rebuildRows()
+{
+    rows.clear();
+    numDeviceOutputs = getNumDeviceOutputs();
+
+    const int numLinkedDevices = mdp.getNumLinkedDevices();
+
+    for (int device = 0; device < numDeviceOutputs.size(); ++device)
+    {
+        auto* audioDevice = getDeviceManager (device).getCurrentAudioDevice();
+
+        if (audioDevice == nullptr)
+            continue;
+
+        // Rows are named after the physical channels, the buffer passed to
+        //  the callback only holds the active ones
+        const auto activeOutputs = audioDevice->getActiveOutputChannels();
+        int physicalChannel = activeOutputs.findNextSetBit (0);
+
+        for (int outputChannel = 0; outputChannel < numDeviceOutputs[device]; ++outputChannel)
+        {
+            auto* row = rows.add (std::make_unique<OutputRow>());
+            row->device = device;
+            row->outputChannel = outputChannel;
+
+            String rowName = device == 0 ? "Primary " : "Secondary ";
+
+            if (device > 0 && numLinkedDevices > 1)
+                rowName << device << ".";
+
+            rowName << (physicalChannel + 1);
+            physicalChannel = activeOutputs.findNextSetBit (physicalChannel + 1);
+
+            addAndMakeVisible (row->label);
+            row->label.setText (rowName, dontSendNotification);
+
+            for (int sourceChannel = 0; sourceChannel < routing.getNumSourceChannels(); ++sourceChannel)
+            {
+                auto* button = row->sourceButtons.add (std::make_unique<ToggleButton> (String (sourceChannel + 1)));
+                addAndMakeVisible (button);
+
+                button->onClick = [this, row, button, sourceChannel]
+                {
+                    routing.setSourceChannel (row->device, row->outputChannel,
+                                              button->getToggleState() ? sourceChannel
+                                                                       : ChannelRouting::none);
+                    mdp.setChannelRouting (routing);
+
+                    refreshButtons();
+                };
+            }
+        }
+    }
+
+    refreshButtons();
+
+    // The height depends on the number of rows
+    resized();
+
+    if (auto* parent = getParentComponent())
+        parent->resized();
+}
+
+void RoutingPanel::refreshButtons()
+{
+    for (auto* row : rows)
+    {
+        const auto sourceChannel = routing.getSourceChannel (row->device, row->outputChannel);
+
+        for (int i = 0; i < row->sourceButtons.size(); ++i)
+            row->sourceButtons[i]->setToggleState (i == sourceChannel, dontSendNotification);
+    }
+}
+
+void RoutingPanel::changeListenerCallback (ChangeBroadcaster*)
+{
+    updateRows();
+}
+
+//==============================================================================
+void RoutingPanel::resized()
+{
+    // Manage panel hight
+    const int requiredHeight = (2 + rows.size()) * buttonHeight
+                             + (3 + rows.size()) * padding;
+    setSize (getWidth(), requiredHeight);
+
+    auto bounds = getLocalBounds().reduced (padding);   // get usable bounds
+
+    // Section label:
+    routingPanelLabel.setBounds (bounds.removeFromTop (buttonHeight));
+
+    // Number of source channels:
+    bounds.removeFromTop (padding);     // add spacing
+    {
+        auto rowBounds = bounds.removeFromTop (buttonHeight);
+        sourceChannelsLabel.setBounds (rowBounds.removeFromLeft (buttonWidth));
+        rowBounds.removeFromLeft (padding);
+        sourceChannelsBox.setBounds (rowBounds.removeFromLeft (buttonWidth));
+    }
+
+    // Output rows:
+    for (auto* row : rows)
+    {
+        bounds.removeFromTop (padding);     // add spacing
+        auto rowBounds = bounds.removeFromTop (buttonHeight);
+
+        row->label.setBounds (rowBounds.removeFromLeft (buttonWidth));
+        rowBounds.removeFromLeft (padding);
+
+        for (auto* button : row->sourceButtons)
+            button->setBounds (rowBounds.removeFromLeft (sourceButtonWidth));
+    }
+}
@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    RoutingPanel.h
+    Created: 18 Oct 2026 1:52:10am
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "InterfacePanel.h"
+#include "MultiDevicePlayer.h"
+
+//==============================================================================
+/*
+    Grid of the active output channels of every device against the source
+    channels. Each output plays the source channel that is ticked in its row,
+    or nothing.
+*/
+class RoutingPanel  : public InterfacePanel,
+                      private ChangeListener
+{
+public:
+    explicit RoutingPanel (MultiDevicePlayer& multiDevice);
+    ~RoutingPanel() override;
+
+    //==========================================================================
+    void resized() override;
+
+private:
+    MultiDevicePlayer& mdp;
+    ChannelRouting routing;
+
+    //==========================================================================
+    // UI Components
+    Label routingPanelLabel;
+    ComboBox sourceChannelsBox;
+    Label sourceChannelsLabel;
+
+    struct OutputRow
+    {
+        int device = 0;
+        int outputChannel = 0;
+
+        Label label;
+        OwnedArray<ToggleButton> sourceButtons;
+    };
+
+    OwnedArray<OutputRow> rows;
+
+    // Number of active outputs of each device that the rows were made for
+    Array<int> numDeviceOutputs;
+
+    //==========================================================================
+    AudioDeviceManager& getDeviceManager (int device);
+    Array<int> getNumDeviceOutputs();
+
+    /** Makes the rows again if the active outputs have changed, otherwise
+        only updates the buttons.
+    */
+    void updateRows();
+    void rebuildRows();
+    void refreshButtons();
+
+    void changeListenerCallback (ChangeBroadcaster* source) override;
+
+    //==========================================================================
+    // Width of a source channel button
+    inline static constexpr int sourceButtonWidth = 40;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RoutingPanel)
+};
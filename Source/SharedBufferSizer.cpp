@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    SharedBufferSizer.cpp
+    Created: 18 Oct 2026 2:37:48am
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "SharedBufferSizer.h"
+
+void SharedBufferSizer::reset()
+{
+    hasStarted = false;
+    isMeasuring = true;
+    quietTime = minQuietTime;
+    numUnderrunsInWindow = 0;
+    margin = 0;
+    targetDepth = 0;
+    lastChangeWasShrink = false;
+}
+
+//==============================================================================
+int SharedBufferSizer::getRequiredDepth (int maxPopBlockSize, double jitterInSamples)
+{
+    // A pop needs 1.2 blocks to be ready, and the rest of the block covers
+    //  the samples held by the resampler
+    return 2 * maxPopBlockSize + static_cast<int> (std::ceil (jitterInSamples));
+}
+
+void SharedBufferSizer::hold (double timeInSeconds, int64 numUnderruns)
+{
+    if (! hasStarted)
+        return;
+
+    lastNumUnderruns = numUnderruns;
+    lastChangeTime = timeInSeconds;
+}
+
+int SharedBufferSizer::update (double timeInSeconds, int64 numUnderruns,
+                               int requiredDepth, int defaultDepth, int blockSize)
+{
+    if (! hasStarted)
+    {
+        hasStarted = true;
+        startTime = windowStartTime = lastChangeTime = lastUnderrunTime = timeInSeconds;
+        lastNumUnderruns = numUnderruns;
+    }
+
+    // The counters restart when a device is prepared again
+    const auto numNewUnderruns = jmax (int64 { 0 }, numUnderruns - lastNumUnderruns);
+    lastNumUnderruns = numUnderruns;
+    numUnderrunsInWindow += numNewUnderruns;
+
+    if (numNewUnderruns > 0)
+        lastUnderrunTime = timeInSeconds;
+
+    // Keep the default depth until the jitter has been measured
+    if (isMeasuring)
+    {
+        if (timeInSeconds - startTime < measurementTime)
+        {
+            targetDepth = defaultDepth;
+            return targetDepth;
+        }
+
+        isMeasuring = false;
+        lastChangeTime = timeInSeconds;
+        targetDepth = requiredDepth;
+        return targetDepth;
+    }
+
+    const double windowDuration = jmax (minRateWindow, timeInSeconds - windowStartTime);
+    const double underrunRate = static_cast<double> (numUnderrunsInWindow) * 60.0 / windowDuration;
+
+    if (numNewUnderruns > 0 && underrunRate > maxUnderrunRate)
+    {
+        // Grow the margin, and back off if a recent shrink caused the underruns
+        if (lastChangeWasShrink && timeInSeconds - lastChangeTime < quietTime)
+            quietTime = jmin (maxQuietTime, 2.0 * quietTime);
+
+        margin += blockSize;
+        lastChangeWasShrink = false;
+        lastChangeTime = windowStartTime = timeInSeconds;
+        numUnderrunsInWindow = 0;
+    }
+
+    // Grow as soon as the jitter or the margin needs it, with some headroom
+    //  so that the next small rise of the jitter doesn't change it again
+    if (requiredDepth + margin > targetDepth)
+    {
+        targetDepth = requiredDepth + margin + blockSize / 4;
+        lastChangeTime = timeInSeconds;
+        return targetDepth;
+    }
+
+    // Shrink after a quiet period, and only by a noticeable amount, since
+    //  every change of the depth takes a while to apply
+    if (timeInSeconds - jmax (lastChangeTime, lastUnderrunTime) >= quietTime)
+    {
+        const int newMargin = jmax (0, margin - blockSize / 2);
+
+        if (requiredDepth + newMargin < targetDepth - blockSize / 4)
+        {
+            margin = newMargin;
+            targetDepth = requiredDepth + margin;
+            lastChangeWasShrink = true;
+            lastChangeTime = timeInSeconds;
+        }
+    }
+
+    return targetDepth;
+}
@@ -0,0 +1,120 @@
+/*
+  ==============================================================================
+
+    SharedBufferSizer.h
+    Created: 18 Oct 2026 2:37:48am
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Adaptive policy for the depth the Linked devices keep the shared buffer at.
+
+    The depth is the delay of the Main device, so it should be as small as the
+    devices allow. It must cover one pop block, the group delay of the
+    resampler and the wake-up jitter of both devices. The jitter is measured
+    by the devices, and the depth is only derived from it after an initial
+    measurement period. Until then, the default depth is kept.
+
+    A safety margin on top of that is adjusted from the underruns of the
+    Linked devices. It grows by one block whenever underruns exceed the
+    allowed rate, and shrinks by half a block after a quiet period. Every
+    shrink that leads to underruns doubles the quiet period, so the policy
+    settles instead of oscillating.
+*/
+class SharedBufferSizer
+{
+public:
+    SharedBufferSizer() = default;
+
+    //==========================================================================
+    /** [Non-realtime] [Non-thread-safe]
+        Forgets the margin and starts a new measurement period. Call it when
+        the devices are prepared again.
+    */
+    void reset();
+
+    /** [Non-realtime] [Non-thread-safe]
+        Sets the number of underruns per minute the policy tolerates.
+    */
+    void setMaxUnderrunRate (double underrunsPerMinute) { maxUnderrunRate = jmax (0.0, underrunsPerMinute); }
+    double getMaxUnderrunRate() const { return maxUnderrunRate; }
+
+    //==========================================================================
+    /** [Non-realtime] [Non-thread-safe]
+        Returns the smallest depth that covers the blocks and the jitter of
+        the devices, in samples of the Main device.
+
+        @param maxPopBlockSize      largest pop block of the Linked devices
+        @param jitterInSamples      sum of the peak jitter of the Main device
+                                    and of the worst Linked device
+    */
+    static int getRequiredDepth (int maxPopBlockSize, double jitterInSamples);
+
+    /** [Non-realtime] [Non-thread-safe]
+        Updates the policy and returns the target depth of the shared buffer.
+        Call it periodically.
+
+        @param timeInSeconds        monotonic time of the call
+        @param numUnderruns         total underruns of the Linked devices
+        @param requiredDepth        see getRequiredDepth()
+        @param defaultDepth         depth used during the measurement period
+        @param blockSize            step by which the margin is adjusted
+    */
+    int update (double timeInSeconds, int64 numUnderruns,
+                int requiredDepth, int defaultDepth, int blockSize);
+
+    /** [Non-realtime] [Non-thread-safe]
+        Skips the underruns up to now, and restarts the quiet period. Call it
+        instead of update() while the last target depth is still being
+        applied, since its underruns don't show whether the depth suffices.
+
+        @param timeInSeconds        monotonic time of the call
+        @param numUnderruns         total underruns of the Linked devices
+    */
+    void hold (double timeInSeconds, int64 numUnderruns);
+
+    /** [Non-realtime] [Non-thread-safe]
+        Returns the last target depth, or 0 before the first update().
+    */
+    int getTargetDepth() const { return targetDepth; }
+
+private:
+    double maxUnderrunRate = 1.0;   // [1/min]
+
+    //==========================================================================
+    // Policy state
+    bool hasStarted = false;
+    bool isMeasuring = true;
+    double startTime = 0.0;         // [s]
+    double windowStartTime = 0.0;   // [s]
+    double lastChangeTime = 0.0;    // [s]
+    double lastUnderrunTime = 0.0;  // [s]
+    double quietTime = minQuietTime;
+
+    int64 lastNumUnderruns = 0;
+    int64 numUnderrunsInWindow = 0;
+
+    int margin = 0;
+    int targetDepth = 0;
+    bool lastChangeWasShrink = false;
+
+    //==========================================================================
+    // Time the jitter is measured before the depth follows it [s]
+    inline static constexpr double measurementTime = 5.0;
+
+    // Underrun rates are measured over at least this time [s]
+    inline static constexpr double minRateWindow = 60.0;
+
+    // Time without underruns before the margin shrinks, and its upper bound [s]
+    inline static constexpr double minQuietTime = 30.0;
+    inline static constexpr double maxQuietTime = 600.0;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SharedBufferSizer)
+};
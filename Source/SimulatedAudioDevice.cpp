@@ -0,0 +1,407 @@
+/*
+  ==============================================================================
+
+    SimulatedAudioDevice.cpp
+    Created: 17 Oct 2026 11:02:47am
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "SimulatedAudioDevice.h"
+
+SimulatedLoopback::SimulatedLoopback (double sampleRateToUse, double lengthInSeconds)
+    : sampleRate (sampleRateToUse),
+      startTime (Time::getMillisecondCounterHiRes()),
+      timeline (static_cast<size_t> (std::ceil (sampleRateToUse * lengthInSeconds)), 0.0f)
+{
+    jassert (sampleRate > 0.0 && ! timeline.empty());
+}
+
+//==============================================================================
+void SimulatedLoopback::addOutput (const AudioBuffer<float>& buffer, int numSamples,
+                                   double startTimeInSeconds, double deviceSampleRate)
+{
+    const int numChannels = buffer.getNumChannels();
+
+    if (numSamples <= 0 || numChannels == 0)
+        return;
+
+    const auto first = static_cast<int64> (std::ceil (startTimeInSeconds * sampleRate));
+    const auto end = static_cast<int64> (std::ceil ((startTimeInSeconds
+                                                     + numSamples / deviceSampleRate)
+                                                    * sampleRate));
+    const float channelGain = 1.0f / static_cast<float> (numChannels);
+
+    const ScopedLock sl (lock);
+    clearUntil (end);
+
+    // Linear interpolation from the device clock to the loopback clock
+    for (int64 i = first; i < end; ++i)
+    {
+        const double position = (i / sampleRate - startTimeInSeconds) * deviceSampleRate;
+        const int index = jlimit (0, numSamples - 1, static_cast<int> (position));
+        const int next = jmin (index + 1, numSamples - 1);
+        const float fraction = static_cast<float> (position - index);
+
+        float value = 0.0f;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* data = buffer.getReadPointer (ch);
+            value += data[index] + fraction * (data[next] - data[index]);
+        }
+
+        at (i) += value * channelGain;
+    }
+}
+
+void SimulatedLoopback::read (AudioBuffer<float>& buffer, int numSamples,
+                              double startTimeInSeconds, double deviceSampleRate)
+{
+    if (numSamples <= 0 || buffer.getNumChannels() == 0)
+        return;
+
+    auto* data = buffer.getWritePointer (0);
+
+    {
+        const ScopedLock sl (lock);
+        clearUntil (static_cast<int64> (std::ceil ((startTimeInSeconds
+                                                    + numSamples / deviceSampleRate)
+                                                   * sampleRate)) + 1);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double position = (startTimeInSeconds + i / deviceSampleRate) * sampleRate;
+            const auto index = static_cast<int64> (std::floor (position));
+            const float fraction = static_cast<float> (position - index);
+
+            data[i] = at (index) + fraction * (at (index + 1) - at (index));
+        }
+    }
+
+    for (int ch = 1; ch < buffer.getNumChannels(); ++ch)
+        buffer.copyFrom (ch, 0, buffer, 0, 0, numSamples);
+}
+
+void SimulatedLoopback::clearUntil (int64 end)
+{
+    if (end <= clearedUntil)
+        return;
+
+    const auto size = static_cast<int64> (timeline.size());
+
+    for (int64 i = jmax (clearedUntil, end - size); i < end; ++i)
+        at (i) = 0.0f;
+
+    clearedUntil = end;
+}
+
+float& SimulatedLoopback::at (int64 index)
+{
+    const auto size = static_cast<int64> (timeline.size());
+    return timeline[static_cast<size_t> (((index % size) + size) % size)];
+}
+
+//==============================================================================
+SimulatedAudioIODevice::SimulatedAudioIODevice (const Settings& deviceSettings)
+    : AudioIODevice (deviceSettings.name, SimulatedAudioIODeviceType::typeName),
+      Thread ("Simulated audio device"),
+      settings (deviceSettings)
+{
+    jassert (settings.sampleRate > 0.0);
+    jassert (settings.bufferSize > 0);
+    jassert (settings.speed > 0.0);
+
+    // The shared host clock starts before any device does
+    getHostClockStartTime();
+}
+
+SimulatedAudioIODevice::~SimulatedAudioIODevice()
+{
+    close();
+}
+
+//==============================================================================
+StringArray SimulatedAudioIODevice::getOutputChannelNames()
+{
+    StringArray names;
+
+    for (int ch = 0; ch < settings.numOutputChannels; ++ch)
+        names.add ("Output " + String (ch + 1));
+
+    return names;
+}
+
+StringArray SimulatedAudioIODevice::getInputChannelNames()
+{
+    StringArray names;
+
+    for (int ch = 0; ch < settings.numInputChannels; ++ch)
+        names.add ("Input " + String (ch + 1));
+
+    return names;
+}
+
+int SimulatedAudioIODevice::getOutputLatencyInSamples()
+{
+    return currentBufferSize + roundToInt (settings.outputLatencyInMs * 0.001 * currentSampleRate);
+}
+
+String SimulatedAudioIODevice::open (const BigInteger& inputChannels,
+                                     const BigInteger& outputChannels,
+                                     double sampleRate,
+                                     int bufferSizeSamples)
+{
+    close();
+
+    currentSampleRate = sampleRate > 0.0 ? sampleRate : settings.sampleRate;
+    currentBufferSize = bufferSizeSamples > 0 ? bufferSizeSamples : settings.bufferSize;
+
+    activeOutputChannels = outputChannels;
+    activeOutputChannels.setRange (settings.numOutputChannels,
+                                   jmax (0, activeOutputChannels.getHighestBit()
+                                            + 1 - settings.numOutputChannels),
+                                   false);
+    numActiveOutputChannels = activeOutputChannels.countNumberOfSetBits();
+
+    // Allocate the output buffer for the largest block the device can request
+    outputBuffer.setSize (numActiveOutputChannels, currentBufferSize);
+    outputChannelPointers.calloc (static_cast<size_t> (numActiveOutputChannels) + 1);
+
+    for (int ch = 0; ch < numActiveOutputChannels; ++ch)
+        outputChannelPointers[ch] = outputBuffer.getWritePointer (ch);
+
+    activeInputChannels = inputChannels;
+    activeInputChannels.setRange (settings.numInputChannels,
+                                  jmax (0, activeInputChannels.getHighestBit()
+                                           + 1 - settings.numInputChannels),
+                                  false);
+    numActiveInputChannels = activeInputChannels.countNumberOfSetBits();
+
+    inputBuffer.setSize (numActiveInputChannels, currentBufferSize);
+    inputChannelPointers.calloc (static_cast<size_t> (numActiveInputChannels) + 1);
+
+    for (int ch = 0; ch < numActiveInputChannels; ++ch)
+        inputChannelPointers[ch] = inputBuffer.getReadPointer (ch);
+
+    numLateCallbacks.store (0);
+    deviceIsOpen = true;
+
+    return {};
+}
+
+void SimulatedAudioIODevice::close()
+{
+    stop();
+    deviceIsOpen = false;
+}
+
+//==============================================================================
+void SimulatedAudioIODevice::start (AudioIODeviceCallback* newCallback)
+{
+    if (! deviceIsOpen || newCallback == callback)
+        return;
+
+    stop();
+
+    if (newCallback == nullptr)
+        return;
+
+    newCallback->audioDeviceAboutToStart (this);
+
+    {
+        const ScopedLock sl (callbackLock);
+        callback = newCallback;
+    }
+
+    if (settings.runOnDeviceThread)
+        startThread();
+}
+
+void SimulatedAudioIODevice::stop()
+{
+    stopThread (1000);
+
+    AudioIODeviceCallback* oldCallback = nullptr;
+
+    {
+        const ScopedLock sl (callbackLock);
+        std::swap (oldCallback, callback);
+    }
+
+    if (oldCallback != nullptr)
+        oldCallback->audioDeviceStopped();
+}
+
+//==============================================================================
+void SimulatedAudioIODevice::run()
+{
+    // The device consumes samples at its own clock rate, which differs from
+    //  the nominal sample rate by the drift
+    const double actualSampleRate = currentSampleRate * (1.0 + settings.driftInPpm * 1.0e-6);
+    const double wallClockMsPerSecond = 1000.0 / settings.speed;
+
+    Random random (settings.randomSeed);
+
+    const double startTime = Time::getMillisecondCounterHiRes();
+    int64 samplePosition = 0;
+
+    // Devices start at different times, so the loopback has its own time origin
+    if (settings.loopback != nullptr)
+        loopbackTimeOffset = (startTime - settings.loopback->getStartTime()) * 0.001 * settings.speed;
+
+    hostTimeOffset = (startTime - getHostClockStartTime()) * 0.001 * settings.speed;
+    int patternIndex = 0;
+
+    while (! threadShouldExit())
+    {
+        const int numSamples = getNextBlockSize (patternIndex);
+
+        // A block is due once the previous blocks have been played out
+        const double jitter = (2.0 * random.nextDouble() - 1.0) * settings.jitterInMs * 0.001;
+        const double dueTime = jmax (0.0, static_cast<double> (samplePosition) / actualSampleRate
+                                          + jitter);
+        const double dueWallClockTime = startTime + dueTime * wallClockMsPerSecond;
+
+        if (! waitUntil (dueWallClockTime))
+            break;
+
+        const double blockDuration = numSamples / actualSampleRate * wallClockMsPerSecond;
+
+        if (Time::getMillisecondCounterHiRes() - dueWallClockTime > blockDuration)
+            numLateCallbacks.store (numLateCallbacks.load() + 1);
+
+        renderNextBlock (numSamples, dueTime);
+        samplePosition += numSamples;
+    }
+}
+
+void SimulatedAudioIODevice::renderNextBlock (int numSamples, double timeInSeconds)
+{
+    numSamples = jlimit (0, currentBufferSize, numSamples);
+
+    // Report the simulated time of the callback as the host time, on a clock
+    //  that all simulated devices share
+    const uint64 hostTimeNs = static_cast<uint64> (jmax (0.0, timeInSeconds + hostTimeOffset) * 1.0e9);
+    AudioIODeviceCallbackContext context;
+    context.hostTimeNs = &hostTimeNs;
+
+    outputBuffer.clear();
+    inputBuffer.clear();
+
+    // The device clock runs at the drifted rate
+    const double actualSampleRate = currentSampleRate * (1.0 + settings.driftInPpm * 1.0e-6);
+    const double loopbackTime = timeInSeconds + loopbackTimeOffset;
+
+    // An input block has been captured during the block before the callback,
+    //  one buffer of input latency ago
+    if (settings.loopback != nullptr && numActiveInputChannels > 0)
+        settings.loopback->read (inputBuffer, numSamples,
+                                 loopbackTime - (numSamples + currentBufferSize) / actualSampleRate,
+                                 actualSampleRate);
+
+    {
+        const ScopedLock sl (callbackLock);
+
+        if (callback != nullptr)
+            callback->audioDeviceIOCallbackWithContext (inputChannelPointers.get(),
+                                                        numActiveInputChannels,
+                                                        outputChannelPointers.get(),
+                                                        numActiveOutputChannels,
+                                                        numSamples,
+                                                        context);
+    }
+
+    // The output is heard after the buffer and the output latency
+    if (settings.loopback != nullptr && numActiveOutputChannels > 0)
+        settings.loopback->addOutput (outputBuffer, numSamples,
+                                      loopbackTime + currentBufferSize / actualSampleRate
+                                          + settings.outputLatencyInMs * 0.001,
+                                      actualSampleRate);
+}
+
+bool SimulatedAudioIODevice::waitUntil (double wallClockTimeInMs)
+{
+    for (;;)
+    {
+        if (threadShouldExit())
+            return false;
+
+        const double timeLeft = wallClockTimeInMs - Time::getMillisecondCounterHiRes();
+
+        if (timeLeft <= 0.0)
+            return true;
+
+        // Sleeping is too coarse for the last couple of milliseconds
+        if (timeLeft > 2.0)
+            wait (static_cast<int> (timeLeft) - 1);
+        else
+            Thread::yield();
+    }
+}
+
+int SimulatedAudioIODevice::getNextBlockSize (int& patternIndex) const
+{
+    if (settings.blockPattern.isEmpty())
+        return currentBufferSize;
+
+    const int blockSize = settings.blockPattern[patternIndex];
+    patternIndex = (patternIndex + 1) % settings.blockPattern.size();
+
+    return jlimit (1, currentBufferSize, blockSize);
+}
+
+double SimulatedAudioIODevice::getHostClockStartTime()
+{
+    static const double startTime = Time::getMillisecondCounterHiRes();
+    return startTime;
+}
+
+//==============================================================================
+SimulatedAudioIODeviceType::
+    SimulatedAudioIODeviceType (const Array<SimulatedAudioIODevice::Settings>& devices)
+        : AudioIODeviceType (typeName), deviceSettings (devices)
+{
+}
+
+StringArray SimulatedAudioIODeviceType::getDeviceNames (bool wantInputNames) const
+{
+    StringArray names;
+
+    for (const auto& settings : deviceSettings)
+    {
+        if ((wantInputNames ? settings.numInputChannels : settings.numOutputChannels) > 0)
+            names.add (settings.name);
+    }
+
+    return names;
+}
+
+int SimulatedAudioIODeviceType::getDefaultDeviceIndex (bool forInput) const
+{
+    return getDeviceNames (forInput).isEmpty() ? -1 : 0;
+}
+
+int SimulatedAudioIODeviceType::getIndexOfDevice (AudioIODevice* device, bool asInput) const
+{
+    if (device == nullptr)
+        return -1;
+
+    return getDeviceNames (asInput).indexOf (device->getName());
+}
+
+AudioIODevice* SimulatedAudioIODeviceType::createDevice (const String& outputDeviceName,
+                                                         const String& inputDeviceName)
+{
+    // Every simulated device is either an output or an input device
+    const auto& name = outputDeviceName.isNotEmpty() ? outputDeviceName : inputDeviceName;
+
+    for (const auto& settings : deviceSettings)
+    {
+        if (settings.name == name)
+            return new SimulatedAudioIODevice (settings);
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,256 @@
+/*
+  ==============================================================================
+
+    SimulatedAudioDevice.h
+    Created: 17 Oct 2026 11:02:47am
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Shared acoustic space of simulated devices.
+
+    Output devices mix what they play into a common timeline, delayed by their
+    output latency, and input devices capture from it. This is a loopback
+    cable that every simulated device is connected to, so latency measurement
+    can be tested without a microphone.
+
+    Simulated devices run on their own threads, so the timeline is guarded
+    by a lock. It is only meant for the simulation.
+*/
+class SimulatedLoopback
+{
+public:
+    /** Creates a loopback that keeps a given length of audio. */
+    explicit SimulatedLoopback (double sampleRateToUse = 48000.0,
+                                double lengthInSeconds = 10.0);
+
+    //==========================================================================
+    /** [Thread-safe]
+        Returns the wall clock time [ms] that the simulated time of the
+        loopback is counted from.
+    */
+    double getStartTime() const { return startTime; }
+
+    /** [Thread-safe]
+        Mixes a block played by an output device into the timeline.
+
+        @param startTimeInSeconds   simulated time when the block is heard
+        @param deviceSampleRate     actual sample rate of the device clock
+    */
+    void addOutput (const AudioBuffer<float>& buffer, int numSamples,
+                    double startTimeInSeconds, double deviceSampleRate);
+
+    /** [Thread-safe]
+        Reads a block that an input device captures. Every channel gets
+        the same signal.
+    */
+    void read (AudioBuffer<float>& buffer, int numSamples,
+               double startTimeInSeconds, double deviceSampleRate);
+
+private:
+    const double sampleRate;
+    const double startTime;
+
+    CriticalSection lock;
+    std::vector<float> timeline;
+    int64 clearedUntil = 0;
+
+    /** Clears the timeline up to a sample index, so that audio written
+        a timeline length ago is never heard again.
+    */
+    void clearUntil (int64 end);
+
+    float& at (int64 index);
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimulatedLoopback)
+};
+
+//==============================================================================
+/**
+    Virtual audio device that runs its audio callback on its own thread.
+
+    The device clock can be made faster or slower than the nominal sample rate,
+    callbacks can be delivered with random timing jitter and with irregular
+    block sizes, and the whole device can run faster than realtime. This makes
+    it possible to reproduce drift and underrun problems without sound cards.
+*/
+class SimulatedAudioIODevice  : public AudioIODevice,
+                                private Thread
+{
+public:
+    struct Settings
+    {
+        String name = "Simulated Output";
+        int numOutputChannels = 2;
+        int numInputChannels = 0;
+
+        double sampleRate = 48000.0;    // nominal sample rate
+        int bufferSize = 512;
+
+        // Deviation of the device clock from the nominal sample rate [ppm]
+        double driftInPpm = 0.0;
+
+        // Largest deviation of a callback from the time it is due [ms]
+        double jitterInMs = 0.0;
+
+        // Block sizes that the callbacks cycle through. If empty, every
+        //  callback requests `bufferSize` samples. Sizes are limited to
+        //  `bufferSize`, like a real device would never exceed it.
+        Array<int> blockPattern;
+
+        // Simulated time passed per unit of wall clock time
+        double speed = 1.0;
+
+        // Seed for the callback jitter, so that runs can be reproduced
+        int64 randomSeed = 0;
+
+        // If false, the device doesn't run its own thread, and every block
+        //  is rendered by calling renderNextBlock()
+        bool runOnDeviceThread = true;
+
+        // Outputs are played into the loopback and inputs capture from it
+        std::shared_ptr<SimulatedLoopback> loopback;
+
+        // Delay from the device output to the loopback, on top of the buffer
+        //  latency. It stands for the converters and the acoustic path [ms]
+        double outputLatencyInMs = 0.0;
+    };
+
+    //==========================================================================
+    explicit SimulatedAudioIODevice (const Settings& deviceSettings);
+    ~SimulatedAudioIODevice() override;
+
+    //==========================================================================
+    StringArray getOutputChannelNames() override;
+    StringArray getInputChannelNames() override;
+
+    Array<double> getAvailableSampleRates() override { return { settings.sampleRate }; }
+    Array<int> getAvailableBufferSizes() override { return { settings.bufferSize }; }
+    int getDefaultBufferSize() override { return settings.bufferSize; }
+
+    String open (const BigInteger& inputChannels,
+                 const BigInteger& outputChannels,
+                 double sampleRate,
+                 int bufferSizeSamples) override;
+    void close() override;
+    bool isOpen() override { return deviceIsOpen; }
+
+    void start (AudioIODeviceCallback* newCallback) override;
+    void stop() override;
+    bool isPlaying() override { return callback != nullptr; }
+
+    String getLastError() override { return {}; }
+
+    int getCurrentBufferSizeSamples() override { return currentBufferSize; }
+    double getCurrentSampleRate() override { return currentSampleRate; }
+    int getCurrentBitDepth() override { return 32; }
+
+    BigInteger getActiveOutputChannels() const override { return activeOutputChannels; }
+    BigInteger getActiveInputChannels() const override { return activeInputChannels; }
+
+    int getOutputLatencyInSamples() override;
+    int getInputLatencyInSamples() override { return currentBufferSize; }
+
+    /** Returns the number of callbacks that were delivered more than a block
+        late, which means the simulation is running too fast for this machine.
+    */
+    int getXRunCount() const noexcept override { return numLateCallbacks.load(); }
+
+    //==========================================================================
+    /** Renders one block on the calling thread. Use it to drive a device that
+        doesn't run on its own thread, for example when replaying a trace.
+
+        @param numSamples       block size, limited to the current buffer size
+        @param timeInSeconds    simulated time of the callback
+    */
+    void renderNextBlock (int numSamples, double timeInSeconds);
+
+private:
+    const Settings settings;
+
+    bool deviceIsOpen = false;
+    double currentSampleRate = 48000.0;
+    int currentBufferSize = 512;
+    BigInteger activeOutputChannels;
+    BigInteger activeInputChannels;
+
+    //==========================================================================
+    // Callback management
+    CriticalSection callbackLock;
+    AudioIODeviceCallback* callback = nullptr;
+
+    AudioBuffer<float> outputBuffer;
+    HeapBlock<float*> outputChannelPointers;
+    int numActiveOutputChannels = 0;
+
+    AudioBuffer<float> inputBuffer;
+    HeapBlock<const float*> inputChannelPointers;
+    int numActiveInputChannels = 0;
+
+    // Simulated time of the device relative to the loopback time [s]
+    double loopbackTimeOffset = 0.0;
+
+    // Simulated time of the device relative to the simulated host clock [s]
+    double hostTimeOffset = 0.0;
+
+    std::atomic<int> numLateCallbacks { 0 };
+
+    //==========================================================================
+    // Device thread
+    void run() override;
+
+    /** Waits on the device thread until the given wall clock time [ms].
+        @returns    false if the thread should exit.
+    */
+    bool waitUntil (double wallClockTimeInMs);
+
+    /** Returns the size of the next block in the block pattern. */
+    int getNextBlockSize (int& patternIndex) const;
+
+    /** Returns the wall clock time [ms] that the simulated host time of all
+        devices is counted from, so that their host times can be compared.
+    */
+    static double getHostClockStartTime();
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimulatedAudioIODevice)
+};
+
+//==============================================================================
+/**
+    Device type that publishes a fixed list of simulated devices.
+
+    Adding it to an AudioDeviceManager before the manager is initialised makes
+    it the only device type of that manager.
+*/
+class SimulatedAudioIODeviceType  : public AudioIODeviceType
+{
+public:
+    explicit SimulatedAudioIODeviceType (const Array<SimulatedAudioIODevice::Settings>& devices);
+
+    //==========================================================================
+    void scanForDevices() override {}
+    StringArray getDeviceNames (bool wantInputNames) const override;
+    int getDefaultDeviceIndex (bool forInput) const override;
+    int getIndexOfDevice (AudioIODevice* device, bool asInput) const override;
+    bool hasSeparateInputsAndOutputs() const override { return true; }
+
+    AudioIODevice* createDevice (const String& outputDeviceName,
+                                 const String& inputDeviceName) override;
+
+    //==========================================================================
+    inline static const String typeName { "Simulated" };
+
+private:
+    Array<SimulatedAudioIODevice::Settings> deviceSettings;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimulatedAudioIODeviceType)
+};
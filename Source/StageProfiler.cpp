@@ -0,0 +1,159 @@
+/*
+  ==============================================================================
+
+    StageProfiler.cpp
+    Created: 17 Oct 2026 9:26:14pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "StageProfiler.h"
+
+StageProfiler::StageProfiler()
+    : nanosecondsPerTick (1.0e9 / static_cast<double> (Time::getHighResolutionTicksPerSecond()))
+{
+    reset (44100.0, 512);
+
+    //==========================================================================
+    // Check that atomic int64 is lock-free
+    static_assert (std::atomic<int64>::is_always_lock_free,
+                   "std::atomic for type int64 must be always lock free");
+}
+
+const char* StageProfiler::getStageName (int stage)
+{
+    switch (stage)
+    {
+        case callback:  return "callback";
+        case source:    return "source";
+        case decode:    return "decode";
+        case crossfade: return "crossfade";
+        case push:      return "push";
+        case pop:       return "pop";
+        case resample:  return "resample";
+        case delay:     return "delay";
+        case crossover: return "crossover";
+        default:        return "";
+    }
+}
+
+//==============================================================================
+void StageProfiler::reset (double sampleRate, int blockSize)
+{
+    for (auto& histogram : histograms)
+    {
+        for (auto& bucketCount : histogram.counts)
+            bucketCount.store (0);
+
+        histogram.count.store (0);
+        histogram.numOverDeadline.store (0);
+        histogram.maxNanoseconds.store (0);
+    }
+
+    deadlineInNanoseconds.store (static_cast<int64> (1.0e9 * blockSize / sampleRate));
+}
+
+void StageProfiler::addTime (int stage, int64 ticks)
+{
+    jassert (isPositiveAndBelow (stage, static_cast<int> (numStages)));
+
+    auto& histogram = histograms[stage];
+    const auto nanoseconds = static_cast<int64> (static_cast<double> (ticks) * nanosecondsPerTick);
+
+    increment (histogram.counts[getBucket (nanoseconds)]);
+    increment (histogram.count);
+
+    if (nanoseconds > deadlineInNanoseconds.load (std::memory_order_relaxed))
+        increment (histogram.numOverDeadline);
+
+    if (nanoseconds > histogram.maxNanoseconds.load (std::memory_order_relaxed))
+        histogram.maxNanoseconds.store (nanoseconds, std::memory_order_relaxed);
+}
+
+double StageProfiler::getDeadlineInMicroseconds() const
+{
+    return 0.001 * static_cast<double> (deadlineInNanoseconds.load());
+}
+
+StageProfiler::Summary StageProfiler::getSummary (int stage) const
+{
+    jassert (isPositiveAndBelow (stage, static_cast<int> (numStages)));
+
+    const auto& histogram = histograms[stage];
+
+    // The audio thread keeps adding times, so the total is taken from
+    //  the snapshot of the buckets rather than from the counter
+    int64 counts[numBuckets];
+    int64 count = 0;
+
+    for (int bucket = 0; bucket < numBuckets; ++bucket)
+    {
+        counts[bucket] = histogram.counts[bucket].load (std::memory_order_relaxed);
+        count += counts[bucket];
+    }
+
+    Summary summary;
+    summary.count = count;
+    summary.numOverDeadline = histogram.numOverDeadline.load (std::memory_order_relaxed);
+    summary.max = 0.001 * static_cast<double> (histogram.maxNanoseconds.load (std::memory_order_relaxed));
+
+    if (count == 0)
+        return summary;
+
+    auto getPercentile = [&] (double fraction)
+    {
+        const auto target = jmax (int64 { 1 },
+                                  static_cast<int64> (std::ceil (fraction * static_cast<double> (count))));
+        int64 cumulativeCount = 0;
+
+        for (int bucket = 0; bucket < numBuckets; ++bucket)
+        {
+            cumulativeCount += counts[bucket];
+
+            if (cumulativeCount >= target)
+                return jmin (getBucketUpperBoundInMicroseconds (bucket), summary.max);
+        }
+
+        return summary.max;
+    };
+
+    summary.p50 = getPercentile (0.5);
+    summary.p99 = getPercentile (0.99);
+    summary.p999 = getPercentile (0.999);
+
+    return summary;
+}
+
+//==============================================================================
+int StageProfiler::getBucket (int64 nanoseconds)
+{
+    const auto units = static_cast<uint32> (jlimit (int64 { 0 },
+                                                    int64 { std::numeric_limits<uint32>::max() },
+                                                    nanoseconds / nanosecondsPerUnit));
+
+    if (units < static_cast<uint32> (numSubBuckets))
+        return static_cast<int> (units);
+
+    // The highest bit selects the octave, the bits below it the sub-bucket
+    const int octave = findHighestSetBit (units);
+    const int subBucket = static_cast<int> (units >> (octave - subBucketBits)) & (numSubBuckets - 1);
+
+    return (octave - subBucketBits + 1) * numSubBuckets + subBucket;
+}
+
+double StageProfiler::getBucketUpperBoundInMicroseconds (int bucket)
+{
+    int64 upperBoundInUnits = bucket + 1;
+
+    if (bucket >= numSubBuckets)
+    {
+        const int octave = bucket / numSubBuckets + subBucketBits - 1;
+        const int subBucket = bucket % numSubBuckets;
+
+        upperBoundInUnits = static_cast<int64> (numSubBuckets + subBucket + 1)
+                                << (octave - subBucketBits);
+    }
+
+    return 0.001 * static_cast<double> (upperBoundInUnits * nanosecondsPerUnit);
+}
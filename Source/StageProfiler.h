@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    StageProfiler.h
+    Created: 17 Oct 2026 9:26:14pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Lock-free timing histograms of the processing stages of one audio device.
+
+    The audio thread of the device times each stage with the high resolution
+    clock and adds the time to a log-bucketed histogram: every octave of time
+    is split into `numSubBuckets` buckets, so a percentile is accurate to
+    about 1 / numSubBuckets of its value. Each histogram is only written by
+    one thread, normally the audio thread of its device, so recording is
+    wait-free, and it can be read from any thread.
+
+    Times are also compared against the buffer deadline of the device, which
+    is the duration of one block at its sample rate.
+*/
+class StageProfiler
+{
+public:
+    enum Stage
+    {
+        callback = 0,   // the whole device callback
+        source,         // rendering the audio source of the Main device
+        decode,         // reading the players, part of source
+        crossfade,      // fading between the players, part of source
+        push,           // writing the shared buffer
+        pop,            // reading the shared or the render-ahead buffer
+        resample,       // resampling, without the pop
+        delay,          // latency compensation
+        crossover,      // crossover filter
+        numStages
+    };
+
+    static const char* getStageName (int stage);
+
+    //==========================================================================
+    struct Summary
+    {
+        int64 count = 0;
+        int64 numOverDeadline = 0;
+
+        // Upper bounds of the histogram buckets that hold the percentiles [us]
+        double p50 = 0.0;
+        double p99 = 0.0;
+        double p999 = 0.0;
+
+        double max = 0.0;       // [us]
+    };
+
+    //==========================================================================
+    StageProfiler();
+
+    /** [Non-realtime] [Non-thread-safe]
+        Clears the histograms and sets the buffer deadline. Must not be called
+        while the device is running.
+    */
+    void reset (double sampleRate, int blockSize);
+
+    /** [Realtime] [Single writer]
+        Adds a stage time measured in high resolution ticks.
+    */
+    void addTime (int stage, int64 ticks);
+
+    /** [Realtime] [Thread-safe] */
+    double getDeadlineInMicroseconds() const;
+
+    /** [Non-realtime] [Thread-safe]
+        Returns the percentiles of a stage, computed from a snapshot of its
+        histogram.
+    */
+    Summary getSummary (int stage) const;
+
+    //==========================================================================
+    /** Times a stage for as long as it exists. */
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer (StageProfiler& p, int stageToTime)
+            : profiler (p), stage (stageToTime), startTicks (Time::getHighResolutionTicks())
+        {
+        }
+
+        ~ScopedTimer()
+        {
+            profiler.addTime (stage, Time::getHighResolutionTicks() - startTicks);
+        }
+
+    private:
+        StageProfiler& profiler;
+        const int stage;
+        const int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedTimer)
+    };
+
+private:
+    //==========================================================================
+    // Histogram layout. Times below `numSubBuckets` units fall into linear
+    //  buckets, every following octave has `numSubBuckets` buckets.
+    inline static constexpr int subBucketBits = 3;
+    inline static constexpr int numSubBuckets = 1 << subBucketBits;
+    inline static constexpr int64 nanosecondsPerUnit = 32;
+    inline static constexpr int numBuckets = (32 - subBucketBits + 1) * numSubBuckets;
+
+    static int getBucket (int64 nanoseconds);
+    static double getBucketUpperBoundInMicroseconds (int bucket);
+
+    struct Histogram
+    {
+        std::atomic<int64> counts[numBuckets];
+        std::atomic<int64> count { 0 };
+        std::atomic<int64> numOverDeadline { 0 };
+        std::atomic<int64> maxNanoseconds { 0 };
+    };
+
+    Histogram histograms[numStages];
+
+    std::atomic<int64> deadlineInNanoseconds { 0 };
+    const double nanosecondsPerTick;
+
+    // There is only one writer, so read-modify-write is not needed
+    static void increment (std::atomic<int64>& counter)
+    {
+        counter.store (counter.load (std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);
+    }
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StageProfiler)
+};
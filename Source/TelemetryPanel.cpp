@@ -0,0 +1,290 @@
+/*
+  ==============================================================================
+
+    TelemetryPanel.cpp
+    Created: 17 Oct 2026 8:41:05pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TelemetryPanel.h"
+
+//==============================================================================
+TelemetryPanel::TelemetryPanel (TelemetryRecorder& recorder)
+    : telemetry (recorder)
+{
+    // Telemetry panel label:
+    addAndMakeVisible (telemetryPanelLabel);
+    telemetryPanelLabel.setFont (headingFont);
+    const auto headingColour
+    = getLookAndFeel().findColour (AppLookAndFeel::headingColourId);
+    telemetryPanelLabel.setColour (Label::textColourId, headingColour);
+    telemetryPanelLabel.setText ("Telemetry", dontSendNotification);
+
+    // Log button:
+    addAndMakeVisible (logButton);
+    logButton.onClick = [this] { logButtonClicked(); };
+    updateLogButton();
+
+    // Stage timing export:
+    addAndMakeVisible (exportTimingsButton);
+    exportTimingsButton.setButtonText ("Export Timings...");
+    exportTimingsButton.onClick = [this] { exportTimingsButtonClicked(); };
+
+    // Counters, one line per device
+    for (int device = 0; device < telemetry.getNumDevices(); ++device)
+    {
+        auto* label = deviceLabels.add (std::make_unique<Label>());
+        addAndMakeVisible (label);
+        label->setColour (Label::textColourId, getDeviceColour (device));
+    }
+
+    // Stage timing table:
+    addAndMakeVisible (stageTimingView);
+    stageTimingView.setMultiLine (true, false);
+    stageTimingView.setReadOnly (true);
+    stageTimingView.setCaretVisible (false);
+    stageTimingView.setFont (Font (Font::getDefaultMonospacedFontName(), 12.0f, Font::plain));
+
+    startTimerHz (refreshRateHz);
+}
+
+//==============================================================================
+void TelemetryPanel::paint (Graphics& g)
+{
+    paintPlot (g, occupancyPlotBounds, "Shared buffer occupancy",
+               [] (const TelemetryRecorder::DeviceSample& s) { return s.occupancy; });
+
+    paintPlot (g, loadPlotBounds, "Callback load",
+               [] (const TelemetryRecorder::DeviceSample& s) { return s.load; });
+}
+
+void TelemetryPanel::resized()
+{
+    // Manage panel hight
+    const int numTimingLines = 1 + numMainStageLines
+                             + (deviceLabels.size() - 1) * numLinkedStageLines;
+    const int timingViewHeight = numTimingLines * timingLineHeight + padding;
+
+    const int requiredHeight = (2 + deviceLabels.size()) * (buttonHeight + padding)
+                             + 2 * (plotHeight + padding)
+                             + timingViewHeight + 2 * padding;
+    setSize (getWidth(), requiredHeight);
+
+    auto bounds = getLocalBounds().reduced (padding);   // get usable bounds
+
+    // Section label:
+    telemetryPanelLabel.setBounds (bounds.removeFromTop (buttonHeight));
+
+    // Log and export buttons:
+    bounds.removeFromTop (padding);     // add spacing
+    auto buttonBounds = bounds.removeFromTop (buttonHeight);
+    logButton.setBounds (buttonBounds.removeFromLeft (2 * buttonWidth + padding));
+    buttonBounds.removeFromLeft (padding);     // add spacing
+    exportTimingsButton.setBounds (buttonBounds.removeFromLeft (2 * buttonWidth + padding));
+
+    // Plots:
+    bounds.removeFromTop (padding);     // add spacing
+    occupancyPlotBounds = bounds.removeFromTop (plotHeight);
+    bounds.removeFromTop (padding);     // add spacing
+    loadPlotBounds = bounds.removeFromTop (plotHeight);
+
+    // Counters:
+    for (auto* label : deviceLabels)
+    {
+        bounds.removeFromTop (padding);     // add spacing
+        label->setBounds (bounds.removeFromTop (buttonHeight));
+    }
+
+    // Stage timings:
+    bounds.removeFromTop (padding);     // add spacing
+    stageTimingView.setBounds (bounds.removeFromTop (timingViewHeight));
+}
+
+//==============================================================================
+void TelemetryPanel::logButtonClicked()
+{
+    if (telemetry.isLogging())
+    {
+        telemetry.stopLogging();
+        updateLogButton();
+        return;
+    }
+
+    fileChooser = std::make_unique<FileChooser> ("Select a file to log the telemetry to...",
+                                                 File(),
+                                                 "*.csv");
+
+    auto fileChooserFlags = FileBrowserComponent::saveMode
+                          | FileBrowserComponent::canSelectFiles
+                          | FileBrowserComponent::warnAboutOverwriting;
+
+    fileChooser->launchAsync (fileChooserFlags, [this] (const FileChooser& fc)
+    {
+        auto file = fc.getResult();
+
+        if (file == File())         // if cancelled, abort
+            return;
+
+        telemetry.startLogging (file);
+        updateLogButton();
+    });
+}
+
+void TelemetryPanel::updateLogButton()
+{
+    logButton.setButtonText (telemetry.isLogging() ? "Stop Logging" : "Log to File...");
+}
+
+void TelemetryPanel::exportTimingsButtonClicked()
+{
+    fileChooser = std::make_unique<FileChooser> ("Select a file to export the stage timings to...",
+                                                 File(),
+                                                 "*.csv");
+
+    auto fileChooserFlags = FileBrowserComponent::saveMode
+                          | FileBrowserComponent::canSelectFiles
+                          | FileBrowserComponent::warnAboutOverwriting;
+
+    fileChooser->launchAsync (fileChooserFlags, [this] (const FileChooser& fc)
+    {
+        auto file = fc.getResult();
+
+        if (file == File())         // if cancelled, abort
+            return;
+
+        telemetry.exportStageTimings (file);
+    });
+}
+
+void TelemetryPanel::updateStageTimingView()
+{
+    auto formatColumn = [] (const String& text, int width)
+    {
+        return text.paddedLeft (' ', width);
+    };
+
+    String text;
+    text << "Device      Stage       p50 us   p99 us  p99.9 us   max us  over deadline";
+
+    for (const auto& timing : telemetry.getStageTimings())
+    {
+        const String deviceName = timing.device == 0 ? String ("Primary")
+                                                     : "Secondary " + String (timing.device);
+
+        text << "\n" << deviceName.paddedRight (' ', 12)
+             << String (StageProfiler::getStageName (timing.stage)).paddedRight (' ', 10)
+             << formatColumn (String (timing.summary.p50, 1), 9)
+             << formatColumn (String (timing.summary.p99, 1), 9)
+             << formatColumn (String (timing.summary.p999, 1), 10)
+             << formatColumn (String (timing.summary.max, 1), 9)
+             << formatColumn (String (timing.summary.numOverDeadline), 8)
+             << " of " << timing.summary.count
+             << " (" << roundToInt (timing.deadlineInMicroseconds) << " us)";
+    }
+
+    stageTimingView.setText (text, false);
+}
+
+//==============================================================================
+void TelemetryPanel::paintPlot (Graphics& g, juce::Rectangle<int> bounds, StringRef title,
+                                std::function<float (const TelemetryRecorder::DeviceSample&)> getValue)
+{
+    const auto plotBounds = bounds.toFloat();
+
+    g.setColour (getLookAndFeel().findColour (ComboBox::outlineColourId));
+    g.drawRect (plotBounds, 1.0f);
+
+    g.setColour (getLookAndFeel().findColour (Label::textColourId));
+    g.setFont (Font (12.0f));
+    g.drawText (title, bounds.reduced (4, 2), Justification::topLeft);
+
+    if (history.size() < 2)
+        return;
+
+    // The newest sample is at the right edge
+    const float xStep = plotBounds.getWidth() / static_cast<float> (history.size() - 1);
+
+    for (int device = 0; device < telemetry.getNumDevices(); ++device)
+    {
+        Path path;
+
+        for (int i = 0; i < history.size(); ++i)
+        {
+            const float value = jlimit (0.0f, 1.0f,
+                                        getValue (history.getReference (i)
+                                                      .devices[static_cast<size_t> (device)]));
+            const float x = plotBounds.getX() + static_cast<float> (i) * xStep;
+            const float y = plotBounds.getBottom() - value * plotBounds.getHeight();
+
+            if (i == 0)
+                path.startNewSubPath (x, y);
+            else
+                path.lineTo (x, y);
+        }
+
+        g.setColour (getDeviceColour (device));
+        g.strokePath (path, PathStrokeType (1.5f));
+    }
+}
+
+Colour TelemetryPanel::getDeviceColour (int device)
+{
+    // Main device in the heading colour, Linked devices spread around the hue circle
+    if (device == 0)
+        return Colour (0xFFDFDFDF);
+
+    return Colour::fromHSV (0.1f + 0.15f * static_cast<float> (device - 1),
+                            0.7f, 0.9f, 1.0f);
+}
+
+void TelemetryPanel::timerCallback()
+{
+    history = telemetry.getHistory();
+
+    if (++timerTicksSinceTimingUpdate >= timingRefreshInterval)
+    {
+        timerTicksSinceTimingUpdate = 0;
+        updateStageTimingView();
+    }
+
+    if (history.isEmpty())
+        return;
+
+    const auto& latest = history.getReference (history.size() - 1);
+
+    for (int device = 0; device < deviceLabels.size(); ++device)
+    {
+        const auto& sample = latest.devices[static_cast<size_t> (device)];
+        String text;
+
+        if (device > 0 && sample.isRejected)
+        {
+            deviceLabels[device]->setText ("Secondary " + String (device)
+                                               + ": muted, its blocks need a deeper shared buffer",
+                                           dontSendNotification);
+            continue;
+        }
+
+        if (device == 0)
+            text << "Primary: overflows " << sample.numDropouts;
+        else
+            text << "Secondary " << device << ": underruns " << sample.numDropouts;
+
+        text << ", waits " << sample.numWaits
+             << ", xruns " << sample.numXRuns
+             << ", load " << roundToInt (100.0f * sample.load) << "%";
+
+        if (device > 0)
+        {
+            text << ", drift " << String (sample.driftInPpm, 1) << " ppm"
+                 << ", alignment " << String (sample.alignmentErrorInSamples, 2) << " samples";
+        }
+
+        deviceLabels[device]->setText (text, dontSendNotification);
+    }
+
+    repaint (occupancyPlotBounds.getUnion (loadPlotBounds));
+}
@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    TelemetryPanel.h
+    Created: 17 Oct 2026 8:41:05pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "InterfacePanel.h"
+#include "TelemetryRecorder.h"
+
+//==============================================================================
+/**
+    Plots the shared buffer occupancy and the callback load of every device
+    live, shows their dropout, wait and xrun counters, and starts or stops
+    logging the telemetry to a CSV file.
+
+    Below the plots, a table lists the timing percentiles of every processing
+    stage against the buffer deadline of its device.
+*/
+class TelemetryPanel  : public InterfacePanel,
+                        private Timer
+{
+public:
+    explicit TelemetryPanel (TelemetryRecorder& recorder);
+
+    //==========================================================================
+    void paint (Graphics& g) override;
+    void resized() override;
+
+private:
+    TelemetryRecorder& telemetry;
+    Array<TelemetryRecorder::Sample> history;
+
+    //==========================================================================
+    // UI Components
+    Label telemetryPanelLabel;
+    TextButton logButton;
+    TextButton exportTimingsButton;
+    OwnedArray<Label> deviceLabels;     // one per device
+    TextEditor stageTimingView;
+
+    std::unique_ptr<FileChooser> fileChooser;
+
+    juce::Rectangle<int> occupancyPlotBounds;
+    juce::Rectangle<int> loadPlotBounds;
+
+    void logButtonClicked();
+    void updateLogButton();
+    void exportTimingsButtonClicked();
+
+    /** Lists the stage timings of every device */
+    void updateStageTimingView();
+    int timerTicksSinceTimingUpdate = 0;
+
+    //==========================================================================
+    /** Plots one value of every device, between 0 and 1, over the history */
+    void paintPlot (Graphics& g, juce::Rectangle<int> bounds, StringRef title,
+                    std::function<float (const TelemetryRecorder::DeviceSample&)> getValue);
+
+    static Colour getDeviceColour (int device);
+
+    /** Refreshes the plots and counters */
+    void timerCallback() override;
+
+    //==========================================================================
+    inline static constexpr int plotHeight = 80;
+    inline static constexpr int refreshRateHz = 10;
+
+    // The percentiles change slowly, so the table is refreshed less often
+    inline static constexpr int timingRefreshInterval = 5;     // [timer ticks]
+    inline static constexpr int timingLineHeight = 15;
+
+    // Number of stages each device times, plus the table header
+    inline static constexpr int numMainStageLines = 8;
+    inline static constexpr int numLinkedStageLines = 5;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TelemetryPanel)
+};
@@ -0,0 +1,295 @@
+/*
+  ==============================================================================
+
+    TelemetryRecorder.cpp
+    Created: 17 Oct 2026 8:12:37pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#include "TelemetryRecorder.h"
+
+TelemetryRecorder::TelemetryRecorder (MultiDevicePlayer& mdp,
+                                      int sampleIntervalInMs,
+                                      int maxNumHistorySamples)
+    : Thread ("Telemetry Recorder"),
+      player (mdp),
+      sampleInterval (jmax (1, sampleIntervalInMs)),
+      history (static_cast<size_t> (jmax (1, maxNumHistorySamples)))
+{
+}
+
+TelemetryRecorder::~TelemetryRecorder()
+{
+    stop();
+}
+
+//==============================================================================
+void TelemetryRecorder::start()
+{
+    stopThread (2 * sampleInterval + 1000);
+
+    {
+        const ScopedLock historyScopedLock (historyLock);
+        numSamplesRecorded = 0;
+    }
+
+    startThread();
+}
+
+void TelemetryRecorder::stop()
+{
+    stopThread (2 * sampleInterval + 1000);
+    stopLogging();
+}
+
+Array<TelemetryRecorder::Sample> TelemetryRecorder::getHistory() const
+{
+    const ScopedLock historyScopedLock (historyLock);
+
+    const auto capacity = static_cast<int64> (history.size());
+    const auto numSamples = jmin (numSamplesRecorded, capacity);
+
+    Array<Sample> samples;
+    samples.ensureStorageAllocated (static_cast<int> (numSamples));
+
+    for (auto i = numSamplesRecorded - numSamples; i < numSamplesRecorded; ++i)
+        samples.add (history[static_cast<size_t> (i % capacity)]);
+
+    return samples;
+}
+
+//==============================================================================
+bool TelemetryRecorder::startLogging (const File& file)
+{
+    auto stream = std::make_unique<FileOutputStream> (file);
+
+    if (! stream->openedOk())
+        return false;
+
+    stream->setPosition (0);
+    stream->truncate();
+
+    const ScopedLock logScopedLock (logLock);
+    logStream = std::move (stream);
+    writeLogHeader();
+
+    return true;
+}
+
+void TelemetryRecorder::stopLogging()
+{
+    const ScopedLock logScopedLock (logLock);
+
+    if (logStream != nullptr)
+        logStream->flush();
+
+    logStream.reset();
+}
+
+bool TelemetryRecorder::isLogging() const
+{
+    const ScopedLock logScopedLock (logLock);
+    return logStream != nullptr;
+}
+
+void TelemetryRecorder::writeLogHeader()
+{
+    // One row per sample, with the columns of every device side by side
+    StringArray columns { "time_s", "wall_clock", "shared_buffer_size",
+                          "shared_buffer_depth" };
+
+    for (int device = 0; device < getNumDevices(); ++device)
+    {
+        const String prefix = device == 0 ? String ("main_")
+                                          : "linked" + String (device) + "_";
+
+        columns.add (prefix + "occupancy");
+        columns.add (prefix + "load");
+        columns.add (prefix + "transfers");
+        columns.add (prefix + (device == 0 ? "overflows" : "underruns"));
+        columns.add (prefix + "waits");
+        columns.add (prefix + "xruns");
+
+        if (device > 0)
+        {
+            columns.add (prefix + "drift_ppm");
+            columns.add (prefix + "alignment_error_samples");
+            columns.add (prefix + "rejected");
+        }
+    }
+
+    *logStream << columns.joinIntoString (",") << "\n";
+}
+
+void TelemetryRecorder::writeLogRow (const Sample& sample)
+{
+    String row;
+
+    row << String (sample.timeInSeconds, 3) << ","
+        << Time::getCurrentTime().toISO8601 (true) << ","
+        << sample.sharedBufferSize << ","
+        << sample.sharedBufferDepth;
+
+    for (int device = 0; device < getNumDevices(); ++device)
+    {
+        const auto& deviceSample = sample.devices[static_cast<size_t> (device)];
+
+        row << "," << String (deviceSample.occupancy, 4)
+            << "," << String (deviceSample.load, 4)
+            << "," << deviceSample.numTransfers
+            << "," << deviceSample.numDropouts
+            << "," << deviceSample.numWaits
+            << "," << deviceSample.numXRuns;
+
+        if (device > 0)
+        {
+            row << "," << String (deviceSample.driftInPpm, 2)
+                << "," << String (deviceSample.alignmentErrorInSamples, 3)
+                << "," << (deviceSample.isRejected ? 1 : 0);
+        }
+    }
+
+    *logStream << row << "\n";
+}
+
+//==============================================================================
+Array<TelemetryRecorder::StageTiming> TelemetryRecorder::getStageTimings() const
+{
+    Array<StageTiming> timings;
+
+    for (int device = 0; device < getNumDevices(); ++device)
+    {
+        const auto& profiler = device == 0 ? player.getMainProfiler()
+                                           : player.getLinkedProfiler (device - 1);
+
+        for (int stage = 0; stage < StageProfiler::numStages; ++stage)
+        {
+            StageTiming timing;
+            timing.device = device;
+            timing.stage = stage;
+            timing.summary = profiler.getSummary (stage);
+            timing.deadlineInMicroseconds = profiler.getDeadlineInMicroseconds();
+
+            if (timing.summary.count > 0)
+                timings.add (timing);
+        }
+    }
+
+    return timings;
+}
+
+bool TelemetryRecorder::exportStageTimings (const File& file) const
+{
+    FileOutputStream stream (file);
+
+    if (! stream.openedOk())
+        return false;
+
+    stream.setPosition (0);
+    stream.truncate();
+
+    stream << "device,stage,count,p50_us,p99_us,p99_9_us,max_us,deadline_us,over_deadline\n";
+
+    for (const auto& timing : getStageTimings())
+    {
+        String row;
+
+        row << (timing.device == 0 ? String ("main") : "linked" + String (timing.device)) << ","
+            << StageProfiler::getStageName (timing.stage) << ","
+            << timing.summary.count << ","
+            << String (timing.summary.p50, 2) << ","
+            << String (timing.summary.p99, 2) << ","
+            << String (timing.summary.p999, 2) << ","
+            << String (timing.summary.max, 2) << ","
+            << String (timing.deadlineInMicroseconds, 2) << ","
+            << timing.summary.numOverDeadline;
+
+        stream << row << "\n";
+    }
+
+    stream.flush();
+    return stream.getStatus().wasOk();
+}
+
+//==============================================================================
+void TelemetryRecorder::run()
+{
+    const double startTime = Time::getMillisecondCounterHiRes();
+
+    {
+        const ScopedLock logScopedLock (logLock);
+        lastFlushTime = 0.0;
+    }
+
+    while (! threadShouldExit())
+    {
+        const double time = 0.001 * (Time::getMillisecondCounterHiRes() - startTime);
+        const auto sample = takeSample (time);
+
+        {
+            const ScopedLock historyScopedLock (historyLock);
+            history[static_cast<size_t> (numSamplesRecorded % static_cast<int64> (history.size()))]
+                = sample;
+            ++numSamplesRecorded;
+        }
+
+        {
+            const ScopedLock logScopedLock (logLock);
+
+            if (logStream != nullptr)
+            {
+                writeLogRow (sample);
+
+                if (time - lastFlushTime >= logFlushIntervalInSeconds)
+                {
+                    logStream->flush();
+                    lastFlushTime = time;
+                }
+            }
+        }
+
+        wait (sampleInterval);
+    }
+}
+
+TelemetryRecorder::Sample TelemetryRecorder::takeSample (double timeInSeconds) const
+{
+    Sample sample;
+    sample.timeInSeconds = timeInSeconds;
+    sample.sharedBufferSize = player.getSharedBufferSize();
+    sample.sharedBufferDepth = player.getSharedBufferDepth();
+
+    const auto bufferSize = static_cast<float> (jmax (1, sample.sharedBufferSize));
+
+    auto fillDeviceSample = [bufferSize] (DeviceSample& deviceSample,
+                                          const MultiDevicePlayer::Statistics& statistics)
+    {
+        deviceSample.occupancy = static_cast<float> (statistics.occupancy) / bufferSize;
+        deviceSample.load = static_cast<float> (statistics.load);
+        deviceSample.numTransfers = statistics.numTransfers;
+        deviceSample.numWaits = statistics.numWaits;
+        deviceSample.numXRuns = statistics.numXRuns;
+    };
+
+    // The Main device reports the occupancy as seen by the producer, which
+    //  is the distance to the slowest reader
+    const auto mainStatistics = player.getMainStatistics();
+    fillDeviceSample (sample.devices[0], mainStatistics);
+    sample.devices[0].numDropouts = mainStatistics.numOverflows;
+
+    for (int i = 0; i < player.getNumLinkedDevices(); ++i)
+    {
+        auto& deviceSample = sample.devices[static_cast<size_t> (i + 1)];
+        const auto statistics = player.getLinkedStatistics (i);
+
+        fillDeviceSample (deviceSample, statistics);
+        deviceSample.numDropouts = statistics.numUnderruns;
+        deviceSample.driftInPpm = player.getEstimatedDriftInPpm (i);
+        deviceSample.alignmentErrorInSamples = player.getAlignmentErrorInSamples (i);
+        deviceSample.isRejected = player.isLinkedDeviceRejected (i);
+    }
+
+    return sample;
+}
@@ -0,0 +1,158 @@
+/*
+  ==============================================================================
+
+    TelemetryRecorder.h
+    Created: 17 Oct 2026 8:12:37pm
+    Author:  Anthony Alfimov
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MultiDevicePlayer.h"
+
+/**
+    Samples the counters and gauges that the audio threads of a
+    MultiDevicePlayer publish, keeps a history of recent samples for plotting,
+    and can log every sample to a CSV file for long soak tests.
+
+    The audio threads only ever store to atomics, so sampling never blocks
+    them. All sampling, history bookkeeping and file writing happens on the
+    recorder thread.
+
+    The counters of a device restart from zero whenever the device is
+    prepared again, which shows up as a drop in the logged values.
+*/
+class TelemetryRecorder  : private Thread
+{
+public:
+    /** Telemetry of one device. Device 0 is the Main device. */
+    struct DeviceSample
+    {
+        // Shared buffer occupancy before the latest transfer, relative to
+        //  the shared buffer size
+        float occupancy = 0.0f;
+
+        // Audio callback time relative to the block duration
+        float load = 0.0f;
+
+        // Estimated clock drift relative to the Main device [ppm]
+        float driftInPpm = 0.0f;
+
+        // How far the device plays ahead of the Main device [Main device samples]
+        float alignmentErrorInSamples = 0.0f;
+
+        int64 numTransfers = 0;
+        int64 numDropouts = 0;      // overflows of the Main device, underruns of a Linked device
+        int64 numWaits = 0;
+        int numXRuns = 0;
+
+        // A Linked device swapped in with blocks too large for the depth
+        bool isRejected = false;
+    };
+
+    struct Sample
+    {
+        double timeInSeconds = 0.0;     // since the recorder was started
+        int sharedBufferSize = 0;
+        int sharedBufferDepth = 0;      // also the delay of the Main device
+        std::array<DeviceSample, 1 + MultiDevicePlayer::maxNumLinkedDevices> devices;
+    };
+
+    //==========================================================================
+    TelemetryRecorder (MultiDevicePlayer& mdp, int sampleIntervalInMs = 50,
+                       int maxNumHistorySamples = 600);
+    ~TelemetryRecorder() override;
+
+    //==========================================================================
+    /** [Non-realtime] [Thread-safe]
+        Starts sampling on a background thread. The history is cleared.
+    */
+    void start();
+
+    /** [Non-realtime] [Thread-safe]
+        Stops sampling and closes the log file.
+    */
+    void stop();
+
+    /** Returns the number of devices in every sample. */
+    int getNumDevices() const { return 1 + player.getNumLinkedDevices(); }
+
+    /** [Non-realtime] [Thread-safe]
+        Returns the recorded samples in time order, oldest first.
+    */
+    Array<Sample> getHistory() const;
+
+    //==========================================================================
+    /** [Non-realtime] [Thread-safe]
+        Starts writing every sample to a CSV file. An existing file is
+        replaced.
+
+        @returns    false if the file can't be opened.
+    */
+    bool startLogging (const File& file);
+
+    /** [Non-realtime] [Thread-safe]
+        Flushes and closes the log file.
+    */
+    void stopLogging();
+
+    /** [Non-realtime] [Thread-safe] */
+    bool isLogging() const;
+
+    //==========================================================================
+    /** Timing of one processing stage of one device */
+    struct StageTiming
+    {
+        int device = 0;                 // 0 for the Main device
+        int stage = 0;                  // StageProfiler::Stage
+        StageProfiler::Summary summary;
+        double deadlineInMicroseconds = 0.0;
+    };
+
+    /** [Non-realtime] [Thread-safe]
+        Returns the timing histogram summaries of the stages that have run
+        on every device since it was last prepared.
+    */
+    Array<StageTiming> getStageTimings() const;
+
+    /** [Non-realtime] [Thread-safe]
+        Saves the stage timings to a CSV file.
+    */
+    bool exportStageTimings (const File& file) const;
+
+private:
+    MultiDevicePlayer& player;
+    const int sampleInterval;       // [ms]
+
+    //==========================================================================
+    // Ring of the most recent samples
+    mutable CriticalSection historyLock;
+    std::vector<Sample> history;
+    int64 numSamplesRecorded = 0;
+
+    //==========================================================================
+    // CSV log
+    mutable CriticalSection logLock;
+    std::unique_ptr<FileOutputStream> logStream;
+    double lastFlushTime = 0.0;     // [s]
+
+    void writeLogHeader();
+    void writeLogRow (const Sample& sample);
+
+    //==========================================================================
+    /** [Recorder thread] */
+    void run() override;
+
+    /** [Recorder thread] Reads the current counters of every device. */
+    Sample takeSample (double timeInSeconds) const;
+
+    //==========================================================================
+    // The log is flushed regularly, so a crash loses little of a soak test
+    inline static constexpr double logFlushIntervalInSeconds = 1.0;
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TelemetryRecorder)
+};